@@ -0,0 +1,23 @@
+@echo off
+echo Running scaling benchmark...
+
+if not exist "bin\sta.exe" (
+    echo bin\sta.exe not found, run build.bat first
+    exit /b 1
+)
+if not exist "bench" mkdir bench
+
+rem One JSON line per run: netlist kind x gate count x thread count
+set RESULTS=reports\benchmark.jsonl
+
+for %%K in (random adder multiplier mux mesh) do (
+    for %%N in (10000 100000 1000000) do (
+        bin\sta.exe --generate %%K %%N bench\%%K_%%N.txt
+        for %%T in (1 2 4 8) do (
+            bin\sta.exe --circuit bench\%%K_%%N.txt --delays delays\gate_delays.txt --report bench\report.txt --threads %%T --benchmark %RESULTS%
+        )
+    )
+)
+
+echo.
+echo Results appended to %RESULTS%
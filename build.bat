@@ -4,7 +4,7 @@ echo Building Static Timing Analysis Tool...
 if not exist "bin" mkdir bin
 
 echo Compiling...
-g++ -std=c++17 -Wall -O2 src/main.cpp -o bin/sta.exe
+g++ -std=c++17 -Wall -O2 -pthread src/main.cpp -o bin/sta.exe -lpsapi
 
 if %ERRORLEVEL% EQU 0 (
     echo Build successful!
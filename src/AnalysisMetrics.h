@@ -0,0 +1,198 @@
+#ifndef ANALYSIS_METRICS_H
+#define ANALYSIS_METRICS_H
+
+#include <atomic>
+#include <chrono>
+#include <fstream>
+#include <iomanip>
+#include <string>
+#include <vector>
+
+#ifdef _WIN32
+#ifndef NOMINMAX
+#define NOMINMAX
+#endif
+#include <windows.h>
+#include <psapi.h>
+#else
+#include <sys/resource.h>
+#endif
+
+using namespace std;
+
+struct PhaseMetrics {
+    string name;
+    double wallSeconds;
+    double cpuSeconds;          // Process CPU time, summed over all threads
+    long long nodesVisited;
+    long long edgesVisited;
+    long long pathExpansions;   // Path-search candidates generated
+    long long peakRssBytes;     // Process high-water mark when the phase ended
+};
+
+// Per-phase wall/CPU time, work counters and peak memory for one run. Phases
+// are opened and closed in sequence (PhaseScope does both); the counters can
+// be bumped from worker threads while a phase is open.
+class AnalysisMetrics {
+private:
+    using Clock = chrono::steady_clock;
+
+    vector<PhaseMetrics> phases;
+    string currentName;
+    Clock::time_point wallStart;
+    double cpuStart;
+    atomic<long long> nodes;
+    atomic<long long> edges;
+    atomic<long long> expansions;
+
+public:
+    AnalysisMetrics();
+
+    void clear() { phases.clear(); }
+    void beginPhase(const string& name);
+    void endPhase();
+
+    void addNodesVisited(long long count) { nodes.fetch_add(count, memory_order_relaxed); }
+    void addEdgesVisited(long long count) { edges.fetch_add(count, memory_order_relaxed); }
+    void addPathExpansions(long long count) { expansions.fetch_add(count, memory_order_relaxed); }
+
+    const vector<PhaseMetrics>& getPhases() const { return phases; }
+    double getTotalWallSeconds() const;
+    double getTotalCpuSeconds() const;
+
+    // Sidecar files; return false if the file cannot be written
+    bool writeJson(const string& filename) const;
+    bool writeCsv(const string& filename) const;
+
+    static double processCpuSeconds();
+    static long long peakResidentBytes();
+};
+
+// Opens a phase for the lifetime of the scope
+class PhaseScope {
+private:
+    AnalysisMetrics& metrics;
+
+public:
+    PhaseScope(AnalysisMetrics& metricsValue, const string& name) : metrics(metricsValue) {
+        metrics.beginPhase(name);
+    }
+    ~PhaseScope() { metrics.endPhase(); }
+
+    PhaseScope(const PhaseScope&) = delete;
+    PhaseScope& operator=(const PhaseScope&) = delete;
+};
+
+// ===== Implementation =======================================================
+
+AnalysisMetrics::AnalysisMetrics() : cpuStart(0.0), nodes(0), edges(0), expansions(0) {
+}
+
+void AnalysisMetrics::beginPhase(const string& name) {
+    currentName = name;
+    nodes.store(0);
+    edges.store(0);
+    expansions.store(0);
+    cpuStart = processCpuSeconds();
+    wallStart = Clock::now();
+}
+
+void AnalysisMetrics::endPhase() {
+    PhaseMetrics phase;
+    phase.name = currentName;
+    phase.wallSeconds = chrono::duration<double>(Clock::now() - wallStart).count();
+    phase.cpuSeconds = processCpuSeconds() - cpuStart;
+    phase.nodesVisited = nodes.load();
+    phase.edgesVisited = edges.load();
+    phase.pathExpansions = expansions.load();
+    phase.peakRssBytes = peakResidentBytes();
+    phases.push_back(phase);
+}
+
+double AnalysisMetrics::getTotalWallSeconds() const {
+    double total = 0.0;
+    for (const auto& phase : phases) total += phase.wallSeconds;
+    return total;
+}
+
+double AnalysisMetrics::getTotalCpuSeconds() const {
+    double total = 0.0;
+    for (const auto& phase : phases) total += phase.cpuSeconds;
+    return total;
+}
+
+double AnalysisMetrics::processCpuSeconds() {
+#ifdef _WIN32
+    FILETIME creation, exit, kernel, user;
+    if (!GetProcessTimes(GetCurrentProcess(), &creation, &exit, &kernel, &user)) return 0.0;
+    auto toSeconds = [](const FILETIME& time) {
+        ULARGE_INTEGER ticks;
+        ticks.LowPart = time.dwLowDateTime;
+        ticks.HighPart = time.dwHighDateTime;
+        return ticks.QuadPart * 1e-7;     // 100 ns units
+    };
+    return toSeconds(kernel) + toSeconds(user);
+#else
+    struct rusage usage;
+    if (getrusage(RUSAGE_SELF, &usage) != 0) return 0.0;
+    return usage.ru_utime.tv_sec + usage.ru_utime.tv_usec * 1e-6 +
+           usage.ru_stime.tv_sec + usage.ru_stime.tv_usec * 1e-6;
+#endif
+}
+
+long long AnalysisMetrics::peakResidentBytes() {
+#ifdef _WIN32
+    PROCESS_MEMORY_COUNTERS counters;
+    if (!GetProcessMemoryInfo(GetCurrentProcess(), &counters, sizeof(counters))) return 0;
+    return static_cast<long long>(counters.PeakWorkingSetSize);
+#else
+    struct rusage usage;
+    if (getrusage(RUSAGE_SELF, &usage) != 0) return 0;
+#ifdef __APPLE__
+    return static_cast<long long>(usage.ru_maxrss);          // Already in bytes
+#else
+    return static_cast<long long>(usage.ru_maxrss) * 1024;   // Kilobytes on Linux
+#endif
+#endif
+}
+
+bool AnalysisMetrics::writeJson(const string& filename) const {
+    ofstream file(filename);
+    if (!file.is_open()) return false;
+
+    file << fixed << setprecision(6);
+    file << "{\n  \"phases\": [\n";
+    for (size_t i = 0; i < phases.size(); ++i) {
+        const PhaseMetrics& phase = phases[i];
+        file << "    {\"name\": \"" << phase.name << "\""
+             << ", \"wall_s\": " << phase.wallSeconds
+             << ", \"cpu_s\": " << phase.cpuSeconds
+             << ", \"nodes_visited\": " << phase.nodesVisited
+             << ", \"edges_visited\": " << phase.edgesVisited
+             << ", \"path_expansions\": " << phase.pathExpansions
+             << ", \"peak_rss_bytes\": " << phase.peakRssBytes << "}"
+             << (i + 1 < phases.size() ? ",\n" : "\n");
+    }
+    file << "  ],\n";
+    file << "  \"total_wall_s\": " << getTotalWallSeconds() << ",\n";
+    file << "  \"total_cpu_s\": " << getTotalCpuSeconds() << ",\n";
+    file << "  \"peak_rss_bytes\": " << peakResidentBytes() << "\n";
+    file << "}\n";
+    return static_cast<bool>(file);
+}
+
+bool AnalysisMetrics::writeCsv(const string& filename) const {
+    ofstream file(filename);
+    if (!file.is_open()) return false;
+
+    file << fixed << setprecision(6);
+    file << "phase,wall_s,cpu_s,nodes_visited,edges_visited,path_expansions,peak_rss_bytes\n";
+    for (const auto& phase : phases) {
+        file << phase.name << ',' << phase.wallSeconds << ',' << phase.cpuSeconds << ','
+             << phase.nodesVisited << ',' << phase.edgesVisited << ','
+             << phase.pathExpansions << ',' << phase.peakRssBytes << '\n';
+    }
+    return static_cast<bool>(file);
+}
+
+#endif // ANALYSIS_METRICS_H
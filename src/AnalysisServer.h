@@ -0,0 +1,703 @@
+#ifndef ANALYSIS_SERVER_H
+#define ANALYSIS_SERVER_H
+
+#include <atomic>
+#include <cerrno>
+#include <charconv>
+#include <condition_variable>
+#include <cstdlib>
+#include <istream>
+#include <map>
+#include <memory>
+#include <mutex>
+#include <ostream>
+#include <set>
+#include <shared_mutex>
+#include <stdexcept>
+#include <string>
+#include <thread>
+#include <vector>
+#include "Circuit.h"
+#include "TimingAnalyzer.h"
+
+#ifndef _WIN32
+#include <sys/socket.h>
+#include <sys/un.h>
+#include <unistd.h>
+#endif
+
+using namespace std;
+
+// One request line: a flat JSON object whose values are strings, numbers,
+// booleans, null or arrays of those. Nested objects are rejected.
+class JsonRequest {
+private:
+    struct Value {
+        enum Kind { STRING, NUMBER, BOOLEAN, NULL_VALUE, ARRAY } kind = NULL_VALUE;
+        string text;            // STRING contents
+        double number = 0.0;
+        bool flag = false;
+        vector<Value> items;    // ARRAY elements
+        string raw;             // Source text, echoed back for "id"
+    };
+
+    map<string, Value> fields;
+
+    static void skipSpace(const string& line, size_t& pos);
+    static string parseString(const string& line, size_t& pos);
+    static Value parseValue(const string& line, size_t& pos, bool allowArray);
+    const Value& require(const string& key, Value::Kind kind) const;
+
+public:
+    static JsonRequest parse(const string& line);
+
+    bool has(const string& key) const { return fields.count(key) != 0; }
+    string getString(const string& key) const { return require(key, Value::STRING).text; }
+    string getString(const string& key, const string& fallback) const {
+        return has(key) ? getString(key) : fallback;
+    }
+    double getNumber(const string& key) const { return require(key, Value::NUMBER).number; }
+    double getNumber(const string& key, double fallback) const {
+        return has(key) ? getNumber(key) : fallback;
+    }
+    bool getBool(const string& key, bool fallback) const {
+        return has(key) ? require(key, Value::BOOLEAN).flag : fallback;
+    }
+    vector<string> getStrings(const string& key) const;
+    // The request's "id" as JSON text, or null
+    string getId() const;
+};
+
+// Builds one response object; values are appended in call order
+class JsonResponse {
+private:
+    string body;
+
+    void key(const string& name);
+
+public:
+    static string quote(const string& text);
+    static string number(double value);     // Non-finite values become null
+
+    void add(const string& name, const string& value) { key(name); body += quote(value); }
+    void add(const string& name, const char* value) { key(name); body += quote(value); }
+    void add(const string& name, double value) { key(name); body += number(value); }
+    void add(const string& name, long long value) { key(name); body += to_string(value); }
+    void add(const string& name, int value) { key(name); body += to_string(value); }
+    void add(const string& name, size_t value) { key(name); body += to_string(value); }
+    void add(const string& name, bool value) { key(name); body += value ? "true" : "false"; }
+    void addRaw(const string& name, const string& json) { key(name); body += json; }
+    string str() const { return "{" + body + "}"; }
+};
+
+// Long-running analysis service. Clients send one JSON object per line and
+// get one JSON object per line back, in order, over stdin/stdout or a Unix
+// domain socket (one thread per connection). Loaded circuits stay in memory
+// as named sessions:
+//
+//   {"op":"load","session":"cpu","circuit":"cpu.txt","delays":"lib.txt"}
+//       optional "corners":[...], "snapshot":"cpu.snap", "threads":4,
+//       "analyze":false to skip the analysis and answer slack on demand
+//   {"op":"analyze","session":"cpu"}            full re-analysis
+//   {"op":"summary","session":"cpu"}
+//   {"op":"slack","session":"cpu","nodes":["a","b"]}     or "node":"a"
+//   {"op":"paths","session":"cpu","k":5}        optional "endpoint":"out"
+//   {"op":"worst_path","session":"cpu","node":"n42"}   latest path into any node
+//   {"op":"set_delay","session":"cpu","gate":"G1","delay":0.2}   re-analyzes with corners
+//   {"op":"sessions"}   {"op":"unload","session":"cpu"}   {"op":"shutdown"}
+//
+// "session" defaults to "default" and any "id" is echoed back. Replies carry
+// "ok":true or "ok":false with an "error" message. summary, slack, paths and
+// worst_path only read a session and run concurrently with each other; load, analyze
+// and set_delay take the session exclusively. A session loaded without
+// analysis answers slack by timing just the cones of the nodes asked for (see
+// TimingQuery.h), which takes it exclusively too; summary, paths and
+// worst_path need an analyze first.
+class AnalysisServer {
+private:
+    struct Session {
+        shared_mutex lock;
+        Circuit circuit;
+        TimingAnalyzer analyzer;
+        string circuitFile;
+        string delayFile;
+        bool analyzed;
+
+        Session() : analyzer(circuit), analyzed(false) {}
+    };
+
+    int defaultThreads;
+    atomic<bool> stopping;
+
+    mutex sessionsLock;
+    map<string, shared_ptr<Session>> sessions;
+
+    // Socket mode
+    int listenDescriptor;
+    mutex clientsLock;
+    condition_variable clientsDone;
+    set<int> clientDescriptors;
+
+    shared_ptr<Session> findSession(const JsonRequest& request);
+    static string sessionName(const JsonRequest& request) { return request.getString("session", "default"); }
+    static void addSummary(const Session& session, JsonResponse& response);
+    static void requireAnalyzed(const Session& session);
+    static string pathsJson(const vector<TimingPath>& paths);
+
+    void handleLoad(const JsonRequest& request, JsonResponse& response);
+    void handleAnalyze(const JsonRequest& request, JsonResponse& response);
+    void handleSummary(const JsonRequest& request, JsonResponse& response);
+    void handleSlack(const JsonRequest& request, JsonResponse& response);
+    void handlePaths(const JsonRequest& request, JsonResponse& response);
+    void handleWorstPath(const JsonRequest& request, JsonResponse& response);
+    void handleSetDelay(const JsonRequest& request, JsonResponse& response);
+    void handleSessions(JsonResponse& response);
+    void handleUnload(const JsonRequest& request, JsonResponse& response);
+    void handleShutdown();
+
+    void serveClient(int descriptor);
+
+public:
+    explicit AnalysisServer(int threads);
+
+    AnalysisServer(const AnalysisServer&) = delete;
+    AnalysisServer& operator=(const AnalysisServer&) = delete;
+
+    // Answers one request line; never throws
+    string handle(const string& line);
+
+    // Serves until end of input or a shutdown request
+    void serveStream(istream& in, ostream& out);
+    void serveSocket(const string& path);
+};
+
+// ===== Implementation =======================================================
+
+void JsonRequest::skipSpace(const string& line, size_t& pos) {
+    while (pos < line.size() && (line[pos] == ' ' || line[pos] == '\t' || line[pos] == '\r' || line[pos] == '\n')) {
+        ++pos;
+    }
+}
+
+string JsonRequest::parseString(const string& line, size_t& pos) {
+    if (pos >= line.size() || line[pos] != '"') throw runtime_error("Expected a string");
+    string text;
+    for (++pos; pos < line.size() && line[pos] != '"'; ++pos) {
+        char c = line[pos];
+        if (c == '\\') {
+            if (++pos >= line.size()) break;
+            switch (line[pos]) {
+                case 'n': c = '\n'; break;
+                case 't': c = '\t'; break;
+                case 'r': c = '\r'; break;
+                case 'b': c = '\b'; break;
+                case 'f': c = '\f'; break;
+                case 'u': throw runtime_error("\\u escapes are not supported");
+                default: c = line[pos]; break;     // \" \\ \/
+            }
+        }
+        text += c;
+    }
+    if (pos >= line.size()) throw runtime_error("Unterminated string");
+    ++pos;
+    return text;
+}
+
+JsonRequest::Value JsonRequest::parseValue(const string& line, size_t& pos, bool allowArray) {
+    skipSpace(line, pos);
+    if (pos >= line.size()) throw runtime_error("Expected a value");
+    size_t start = pos;
+    Value value;
+    char c = line[pos];
+    if (c == '"') {
+        value.kind = Value::STRING;
+        value.text = parseString(line, pos);
+    } else if (c == '[' && allowArray) {
+        value.kind = Value::ARRAY;
+        ++pos;
+        skipSpace(line, pos);
+        if (pos < line.size() && line[pos] == ']') {
+            ++pos;
+        } else {
+            while (true) {
+                value.items.push_back(parseValue(line, pos, false));
+                skipSpace(line, pos);
+                if (pos < line.size() && line[pos] == ',') { ++pos; continue; }
+                if (pos < line.size() && line[pos] == ']') { ++pos; break; }
+                throw runtime_error("Expected ',' or ']'");
+            }
+        }
+    } else if (line.compare(pos, 4, "true") == 0) {
+        value.kind = Value::BOOLEAN;
+        value.flag = true;
+        pos += 4;
+    } else if (line.compare(pos, 5, "false") == 0) {
+        value.kind = Value::BOOLEAN;
+        pos += 5;
+    } else if (line.compare(pos, 4, "null") == 0) {
+        pos += 4;
+    } else {
+        value.kind = Value::NUMBER;
+        const char* begin = line.c_str() + pos;
+        char* end = nullptr;
+        value.number = strtod(begin, &end);
+        if (end == begin) throw runtime_error("Unexpected character in request");
+        pos += end - begin;
+    }
+    value.raw = line.substr(start, pos - start);
+    return value;
+}
+
+JsonRequest JsonRequest::parse(const string& line) {
+    JsonRequest request;
+    size_t pos = 0;
+    skipSpace(line, pos);
+    if (pos >= line.size() || line[pos] != '{') throw runtime_error("Request must be a JSON object");
+    ++pos;
+    skipSpace(line, pos);
+    if (pos < line.size() && line[pos] == '}') return request;
+    while (true) {
+        skipSpace(line, pos);
+        string key = parseString(line, pos);
+        skipSpace(line, pos);
+        if (pos >= line.size() || line[pos] != ':') throw runtime_error("Expected ':'");
+        ++pos;
+        request.fields[key] = parseValue(line, pos, true);
+        skipSpace(line, pos);
+        if (pos < line.size() && line[pos] == ',') { ++pos; continue; }
+        if (pos < line.size() && line[pos] == '}') break;
+        throw runtime_error("Expected ',' or '}'");
+    }
+    return request;
+}
+
+const JsonRequest::Value& JsonRequest::require(const string& key, Value::Kind kind) const {
+    auto it = fields.find(key);
+    if (it == fields.end()) throw runtime_error("Missing field: " + key);
+    if (it->second.kind != kind) throw runtime_error("Wrong type for field: " + key);
+    return it->second;
+}
+
+vector<string> JsonRequest::getStrings(const string& key) const {
+    vector<string> texts;
+    for (const Value& item : require(key, Value::ARRAY).items) {
+        if (item.kind != Value::STRING) throw runtime_error("Expected strings in field: " + key);
+        texts.push_back(item.text);
+    }
+    return texts;
+}
+
+string JsonRequest::getId() const {
+    auto it = fields.find("id");
+    return it == fields.end() ? "null" : it->second.raw;
+}
+
+void JsonResponse::key(const string& name) {
+    if (!body.empty()) body += ',';
+    body += quote(name);
+    body += ':';
+}
+
+string JsonResponse::quote(const string& text) {
+    string quoted = "\"";
+    for (char c : text) {
+        if (c == '"' || c == '\\') {
+            quoted += '\\';
+            quoted += c;
+        } else if (c == '\n') {
+            quoted += "\\n";
+        } else if (static_cast<unsigned char>(c) < 0x20) {
+            quoted += ' ';
+        } else {
+            quoted += c;
+        }
+    }
+    return quoted + "\"";
+}
+
+string JsonResponse::number(double value) {
+    if (value != value || value == numeric_limits<double>::infinity() ||
+        value == -numeric_limits<double>::infinity()) {
+        return "null";
+    }
+    char digits[32];
+    auto result = to_chars(digits, digits + sizeof(digits), value);
+    return string(digits, result.ptr);
+}
+
+AnalysisServer::AnalysisServer(int threads)
+    : defaultThreads(threads), stopping(false), listenDescriptor(-1) {
+}
+
+string AnalysisServer::handle(const string& line) {
+    string id = "null";
+    JsonResponse response;
+    try {
+        JsonRequest request = JsonRequest::parse(line);
+        id = request.getId();
+        string op = request.getString("op");
+        if (op == "load") handleLoad(request, response);
+        else if (op == "analyze") handleAnalyze(request, response);
+        else if (op == "summary") handleSummary(request, response);
+        else if (op == "slack") handleSlack(request, response);
+        else if (op == "paths") handlePaths(request, response);
+        else if (op == "worst_path") handleWorstPath(request, response);
+        else if (op == "set_delay") handleSetDelay(request, response);
+        else if (op == "sessions") handleSessions(response);
+        else if (op == "unload") handleUnload(request, response);
+        else if (op == "shutdown") handleShutdown();
+        else throw runtime_error("Unknown op: " + op);
+    } catch (const exception& e) {
+        JsonResponse failure;
+        failure.addRaw("id", id);
+        failure.add("ok", false);
+        failure.add("error", e.what());
+        return failure.str();
+    }
+    return "{\"id\":" + id + ",\"ok\":true" + (response.str().size() > 2 ? "," : "") +
+           response.str().substr(1);
+}
+
+shared_ptr<AnalysisServer::Session> AnalysisServer::findSession(const JsonRequest& request) {
+    string name = sessionName(request);
+    lock_guard<mutex> guard(sessionsLock);
+    auto it = sessions.find(name);
+    if (it == sessions.end()) throw runtime_error("No such session: " + name);
+    return it->second;
+}
+
+void AnalysisServer::addSummary(const Session& session, JsonResponse& response) {
+    const TimingAnalyzer& analyzer = session.analyzer;
+    response.add("worst_slack", analyzer.getWorstSlack());
+    response.add("worst_hold_slack", analyzer.getWorstHoldSlack());
+    response.add("total_delay", analyzer.getTotalDelay());
+    response.add("violation", analyzer.isTimingViolation());
+    response.add("paths", analyzer.getAllPaths().size());
+    response.add("critical_paths", analyzer.getCriticalPaths().size());
+    if (!analyzer.getCornerResults().empty()) {
+        string corners = "[";
+        for (const auto& corner : analyzer.getCornerResults()) {
+            if (corners.size() > 1) corners += ',';
+            JsonResponse entry;
+            entry.add("name", corner.name);
+            entry.add("worst_slack", corner.worstSlack);
+            entry.add("worst_hold_slack", corner.worstHoldSlack);
+            entry.add("total_delay", corner.totalDelay);
+            corners += entry.str();
+        }
+        response.addRaw("corners", corners + "]");
+        response.add("merged_worst_slack", analyzer.getMergedWorstSlack());
+        response.add("merged_worst_hold_slack", analyzer.getMergedWorstHoldSlack());
+    }
+    if (!analyzer.getStageResults().empty()) {
+        string stages = "[";
+        for (const auto& stage : analyzer.getStageResults()) {
+            if (stages.size() > 1) stages += ',';
+            JsonResponse entry;
+            entry.add("nodes", stage.nodeCount);
+            entry.add("worst_endpoint", stage.worstEndpoint);
+            entry.add("worst_slack", stage.worstSlack);
+            entry.add("worst_hold_slack", stage.worstHoldSlack);
+            stages += entry.str();
+        }
+        response.addRaw("stages", stages + "]");
+    }
+}
+
+void AnalysisServer::requireAnalyzed(const Session& session) {
+    if (!session.analyzed) {
+        throw runtime_error("Session was loaded without analysis; send analyze first");
+    }
+}
+
+string AnalysisServer::pathsJson(const vector<TimingPath>& paths) {
+    string json = "[";
+    for (const auto& path : paths) {
+        if (json.size() > 1) json += ',';
+        string nodes = "[", delays = "[";
+        for (size_t i = 0; i < path.nodes.size(); ++i) {
+            if (i > 0) {
+                nodes += ',';
+                delays += ',';
+            }
+            nodes += JsonResponse::quote(path.nodes[i]);
+            delays += JsonResponse::number(path.stageDelays[i]);
+        }
+        JsonResponse entry;
+        entry.add("slack", path.slack);
+        entry.add("delay", path.totalDelay);
+        entry.addRaw("nodes", nodes + "]");
+        entry.addRaw("stage_delays", delays + "]");
+        json += entry.str();
+    }
+    return json + "]";
+}
+
+void AnalysisServer::handleLoad(const JsonRequest& request, JsonResponse& response) {
+    // Build the session privately; it replaces any old one only once analyzed
+    auto session = make_shared<Session>();
+    session->circuitFile = request.getString("circuit");
+    session->delayFile = request.getString("delays", "");
+    vector<string> corners = request.has("corners") ? request.getStrings("corners") : vector<string>();
+    if (!corners.empty()) session->delayFile = corners[0];
+    if (session->delayFile.empty()) throw runtime_error("Missing field: delays");
+
+    Circuit& circuit = session->circuit;
+    TimingAnalyzer& analyzer = session->analyzer;
+    AnalysisMetrics& metrics = analyzer.getMetrics();
+    string snapshot = request.getString("snapshot", "");
+    if (snapshot.empty()) {
+        {
+            PhaseScope phase(metrics, "parse");
+            circuit.loadCircuit(session->circuitFile);
+        }
+        PhaseScope phase(metrics, "delays");
+        circuit.loadDelays(session->delayFile);
+    } else {
+        PhaseScope phase(metrics, "load");
+        circuit.loadCached(session->circuitFile, session->delayFile, snapshot);
+    }
+    if (!corners.empty()) {
+        PhaseScope phase(metrics, "corners");
+        circuit.loadCorners(corners);
+    }
+
+    analyzer.setThreadCount(static_cast<int>(request.getNumber("threads", defaultThreads)));
+    analyzer.setPathLimits(static_cast<int>(request.getNumber("max_paths", 100)));
+    session->analyzed = request.getBool("analyze", true);
+    if (session->analyzed) analyzer.analyze();
+    circuit.getGraph();     // Leave the graph clean so readers never rebuild it
+
+    const TimingGraph& graph = circuit.getLiveGraph();
+    response.add("session", sessionName(request));
+    response.add("nodes", graph.getNodeCount());
+    response.add("gates", graph.getGateCount());
+    response.add("seconds", metrics.getTotalWallSeconds());
+    if (session->analyzed) addSummary(*session, response);
+
+    lock_guard<mutex> guard(sessionsLock);
+    sessions[sessionName(request)] = session;
+}
+
+void AnalysisServer::handleAnalyze(const JsonRequest& request, JsonResponse& response) {
+    shared_ptr<Session> session = findSession(request);
+    unique_lock<shared_mutex> guard(session->lock);
+    // Metrics would otherwise grow with every request
+    session->analyzer.getMetrics().clear();
+    session->analyzer.analyze();
+    session->analyzed = true;
+    session->circuit.getGraph();
+    response.add("seconds", session->analyzer.getMetrics().getTotalWallSeconds());
+    addSummary(*session, response);
+}
+
+void AnalysisServer::handleSummary(const JsonRequest& request, JsonResponse& response) {
+    shared_ptr<Session> session = findSession(request);
+    shared_lock<shared_mutex> guard(session->lock);
+    requireAnalyzed(*session);
+    addSummary(*session, response);
+}
+
+void AnalysisServer::handleSlack(const JsonRequest& request, JsonResponse& response) {
+    shared_ptr<Session> session = findSession(request);
+    vector<string> names = request.has("nodes") ? request.getStrings("nodes")
+                                                : vector<string>(1, request.getString("node"));
+    string nodes = "[";
+    auto addNode = [&nodes](const string& name, const NodeTiming& result) {
+        if (nodes.size() > 1) nodes += ',';
+        JsonResponse entry;
+        entry.add("name", name);
+        entry.add("arrival", result.arrival);
+        entry.add("required", result.required);
+        entry.add("slack", result.slack);
+        entry.add("early_arrival", result.earlyArrival);
+        entry.add("hold_required", result.holdRequired);
+        entry.add("hold_slack", result.holdSlack);
+        nodes += entry.str();
+    };
+    
+    shared_lock<shared_mutex> guard(session->lock);
+    if (session->analyzed) {
+        const TimingGraph& graph = session->circuit.getLiveGraph();
+        const TimingStore& timing = session->circuit.getTiming();
+        for (const string& name : names) {
+            NodeId id = graph.findNode(name);
+            if (id == INVALID_ID || static_cast<size_t>(id) >= timing.slack.size()) {
+                throw runtime_error("Unknown node: " + name);
+            }
+            addNode(name, {timing.arrival[id], timing.required[id], timing.slack[id],
+                           timing.earlyArrival[id], timing.holdRequired[id], timing.holdSlack[id]});
+        }
+    } else {
+        // On-demand queries fill the analyzer's memo, so they take the session
+        // exclusively (and see the full results if an analyze got in first)
+        guard.unlock();
+        unique_lock<shared_mutex> exclusive(session->lock);
+        for (const string& name : names) {
+            addNode(name, session->analyzer.queryTiming(name));
+        }
+    }
+    response.addRaw("nodes", nodes + "]");
+}
+
+void AnalysisServer::handlePaths(const JsonRequest& request, JsonResponse& response) {
+    shared_ptr<Session> session = findSession(request);
+    int k = static_cast<int>(request.getNumber("k", 10));
+    if (k < 1) throw runtime_error("k must be positive");
+    shared_lock<shared_mutex> guard(session->lock);
+    requireAnalyzed(*session);
+    vector<TimingPath> paths = request.has("endpoint")
+                                   ? session->analyzer.getWorstPathsTo(request.getString("endpoint"), k)
+                                   : session->analyzer.getWorstPaths(k);
+    response.addRaw("paths", pathsJson(paths));
+}
+
+void AnalysisServer::handleWorstPath(const JsonRequest& request, JsonResponse& response) {
+    shared_ptr<Session> session = findSession(request);
+    string node = request.getString("node");
+    shared_lock<shared_mutex> guard(session->lock);
+    requireAnalyzed(*session);
+    response.addRaw("paths", pathsJson(vector<TimingPath>(1, session->analyzer.worstPathTo(node))));
+}
+
+void AnalysisServer::handleSetDelay(const JsonRequest& request, JsonResponse& response) {
+    shared_ptr<Session> session = findSession(request);
+    string gate = request.getString("gate");
+    double delay = request.getNumber("delay");
+    unique_lock<shared_mutex> guard(session->lock);
+    if (!session->circuit.getGate(gate)) throw runtime_error("Unknown gate: " + gate);
+    if (session->analyzed && !session->circuit.getCorners().empty()) {
+        // Edits retime the primary corner only, so the override is just
+        // recorded and one full analysis brings every corner and the merged
+        // slack in the reply up to date
+        session->circuit.setGateDelay(gate, delay);
+        session->analyzer.getMetrics().clear();
+        session->analyzer.analyze();
+    } else {
+        session->analyzer.setGateDelay(gate, delay);
+        if (session->analyzed) session->analyzer.updatePaths();
+    }
+    session->circuit.getGraph();
+    if (session->analyzed) addSummary(*session, response);
+}
+
+void AnalysisServer::handleSessions(JsonResponse& response) {
+    string names = "[";
+    lock_guard<mutex> guard(sessionsLock);
+    for (const auto& entry : sessions) {
+        if (names.size() > 1) names += ',';
+        names += JsonResponse::quote(entry.first);
+    }
+    response.addRaw("sessions", names + "]");
+}
+
+void AnalysisServer::handleUnload(const JsonRequest& request, JsonResponse& response) {
+    // Queries still holding the session finish before it is freed
+    string name = sessionName(request);
+    lock_guard<mutex> guard(sessionsLock);
+    if (sessions.erase(name) == 0) throw runtime_error("No such session: " + name);
+    response.add("session", name);
+}
+
+void AnalysisServer::handleShutdown() {
+    stopping = true;
+#ifndef _WIN32
+    // Wakes the accept loop
+    if (listenDescriptor >= 0) ::shutdown(listenDescriptor, SHUT_RDWR);
+#endif
+}
+
+void AnalysisServer::serveStream(istream& in, ostream& out) {
+    string line;
+    while (!stopping && getline(in, line)) {
+        if (line.find_first_not_of(" \t\r") == string::npos) continue;
+        out << handle(line) << '\n' << flush;
+    }
+}
+
+#ifdef _WIN32
+
+void AnalysisServer::serveClient(int) {
+}
+
+void AnalysisServer::serveSocket(const string&) {
+    throw runtime_error("Unix domain sockets are not available on this platform; use --serve - (stdin)");
+}
+
+#else
+
+void AnalysisServer::serveClient(int descriptor) {
+    string pending;
+    char buffer[1 << 16];
+    bool open = true;
+    while (open && !stopping) {
+        ssize_t received = ::read(descriptor, buffer, sizeof(buffer));
+        if (received < 0 && errno == EINTR) continue;
+        if (received <= 0) break;
+        pending.append(buffer, static_cast<size_t>(received));
+
+        size_t start = 0, newline;
+        while (open && (newline = pending.find('\n', start)) != string::npos) {
+            string line = pending.substr(start, newline - start);
+            start = newline + 1;
+            if (line.find_first_not_of(" \t\r") == string::npos) continue;
+            string reply = handle(line) + '\n';
+            for (size_t sent = 0; sent < reply.size();) {
+                ssize_t written = ::send(descriptor, reply.data() + sent, reply.size() - sent, MSG_NOSIGNAL);
+                if (written < 0 && errno == EINTR) continue;
+                if (written <= 0) { open = false; break; }
+                sent += static_cast<size_t>(written);
+            }
+        }
+        pending.erase(0, start);
+    }
+
+    ::close(descriptor);
+    lock_guard<mutex> guard(clientsLock);
+    clientDescriptors.erase(descriptor);
+    clientsDone.notify_all();
+}
+
+void AnalysisServer::serveSocket(const string& path) {
+    sockaddr_un address = {};
+    address.sun_family = AF_UNIX;
+    if (path.size() >= sizeof(address.sun_path)) {
+        throw runtime_error("Socket path too long: " + path);
+    }
+    path.copy(address.sun_path, path.size());
+
+    int descriptor = ::socket(AF_UNIX, SOCK_STREAM, 0);
+    if (descriptor < 0) throw runtime_error("Cannot create socket");
+    ::unlink(path.c_str());
+    if (::bind(descriptor, reinterpret_cast<const sockaddr*>(&address), sizeof(address)) != 0 ||
+        ::listen(descriptor, 64) != 0) {
+        ::close(descriptor);
+        throw runtime_error("Cannot listen on socket: " + path);
+    }
+    listenDescriptor = descriptor;
+
+    while (!stopping) {
+        int client = ::accept(descriptor, nullptr, nullptr);
+        if (client < 0) {
+            if (errno == EINTR || errno == ECONNABORTED) continue;
+            break;
+        }
+        lock_guard<mutex> guard(clientsLock);
+        clientDescriptors.insert(client);
+        thread(&AnalysisServer::serveClient, this, client).detach();
+    }
+
+    // Unblock clients waiting for input, then wait for them to finish
+    unique_lock<mutex> guard(clientsLock);
+    for (int client : clientDescriptors) ::shutdown(client, SHUT_RDWR);
+    clientsDone.wait(guard, [this] { return clientDescriptors.empty(); });
+    guard.unlock();
+
+    listenDescriptor = -1;
+    ::close(descriptor);
+    ::unlink(path.c_str());
+}
+
+#endif
+
+#endif // ANALYSIS_SERVER_H
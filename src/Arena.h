@@ -0,0 +1,122 @@
+#ifndef ARENA_H
+#define ARENA_H
+
+#include <algorithm>
+#include <cstddef>
+#include <cstdlib>
+#include <new>
+#include <type_traits>
+#include <utility>
+#include <vector>
+
+using namespace std;
+
+// Bump allocator for objects that share one lifetime, such as the Nodes and
+// Gates of a Circuit. Allocation is a pointer increment inside large blocks
+// and release() frees every block at once without running destructors, so
+// only trivially destructible types may be created in an arena.
+class Arena {
+private:
+    static constexpr size_t DEFAULT_BLOCK_SIZE = 1 << 20;
+
+    vector<char*> blocks;
+    char* cursor;
+    char* limit;
+    size_t bytesAllocated;      // Handed out to callers
+    size_t bytesReserved;       // Held in blocks
+
+    void addBlock(size_t minimumBytes);
+
+public:
+    Arena() : cursor(nullptr), limit(nullptr), bytesAllocated(0), bytesReserved(0) {}
+    ~Arena() { release(); }
+
+    Arena(const Arena&) = delete;
+    Arena& operator=(const Arena&) = delete;
+    Arena(Arena&& other) noexcept;
+    Arena& operator=(Arena&& other) noexcept;
+
+    void* allocate(size_t bytes, size_t alignment = alignof(max_align_t));
+
+    template <class T, class... Args>
+    T* create(Args&&... args) {
+        static_assert(is_trivially_destructible<T>::value,
+                      "Arena objects are freed without running destructors");
+        return new (allocate(sizeof(T), alignof(T))) T(forward<Args>(args)...);
+    }
+
+    // Uninitialized storage for count elements
+    template <class T>
+    T* allocateArray(size_t count) {
+        static_assert(is_trivially_destructible<T>::value,
+                      "Arena objects are freed without running destructors");
+        return static_cast<T*>(allocate(sizeof(T) * count, alignof(T)));
+    }
+
+    // Frees every block; all pointers handed out become invalid
+    void release();
+
+    size_t getBytesAllocated() const { return bytesAllocated; }
+    size_t getBytesReserved() const { return bytesReserved; }
+};
+
+// ===== Implementation =======================================================
+
+Arena::Arena(Arena&& other) noexcept
+    : blocks(move(other.blocks)), cursor(other.cursor), limit(other.limit),
+      bytesAllocated(other.bytesAllocated), bytesReserved(other.bytesReserved) {
+    other.blocks.clear();
+    other.cursor = other.limit = nullptr;
+    other.bytesAllocated = other.bytesReserved = 0;
+}
+
+Arena& Arena::operator=(Arena&& other) noexcept {
+    if (this != &other) {
+        release();
+        blocks = move(other.blocks);
+        cursor = other.cursor;
+        limit = other.limit;
+        bytesAllocated = other.bytesAllocated;
+        bytesReserved = other.bytesReserved;
+        other.blocks.clear();
+        other.cursor = other.limit = nullptr;
+        other.bytesAllocated = other.bytesReserved = 0;
+    }
+    return *this;
+}
+
+void Arena::addBlock(size_t minimumBytes) {
+    size_t size = max(DEFAULT_BLOCK_SIZE, minimumBytes);
+    char* block = static_cast<char*>(malloc(size));
+    if (!block) throw bad_alloc();
+    blocks.push_back(block);
+    cursor = block;
+    limit = block + size;
+    bytesReserved += size;
+}
+
+void* Arena::allocate(size_t bytes, size_t alignment) {
+    size_t padding = (alignment - reinterpret_cast<size_t>(cursor) % alignment) % alignment;
+    if (!cursor || padding + bytes > static_cast<size_t>(limit - cursor)) {
+        // malloc returns max_align_t-aligned memory, which covers every
+        // alignment these objects need
+        addBlock(bytes);
+        padding = 0;
+    }
+    void* result = cursor + padding;
+    cursor += padding + bytes;
+    bytesAllocated += bytes;
+    return result;
+}
+
+void Arena::release() {
+    for (char* block : blocks) {
+        free(block);
+    }
+    blocks.clear();
+    cursor = limit = nullptr;
+    bytesAllocated = 0;
+    bytesReserved = 0;
+}
+
+#endif // ARENA_H
@@ -1,51 +1,164 @@
 #ifndef CIRCUIT_H
 #define CIRCUIT_H
 
+#include <ostream>
 #include <string>
 #include <vector>
 #include <map>
 #include <memory>
+#include "Arena.h"
+#include "CornerTiming.h"
+#include "DelayTable.h"
 #include "Gate.h"
 #include "Node.h"
+#include "TimingGraph.h"
 
 using namespace std;
+class NetlistParser;
+
 class Circuit {
 private:
-    map<string, shared_ptr<Node>> nodes;
-    vector<shared_ptr<Gate>> gates;
+    // Every Node and Gate lives in the arena and is freed with it at once.
+    // Nodes are found by name through a table hashed by interned Symbol.
+    Arena arena;
+    vector<Node*> nodes;                // Creation order
+    SymbolMap<Node*> nodeIndex{nullptr};
+    mutable vector<Node*> sortedNodes;  // Name order, rebuilt after additions
+    mutable bool sortedNodesStale;
+    vector<Gate*> gates;
     map<string, double> gateDelays;
+    map<string, double> gateSigmas;     // Optional third column: delay standard deviation
+    vector<double> typeDelays;          // gateDelays resolved per GateType
+    vector<double> typeSigmas;          // gateSigmas resolved per GateType
     vector<string> primaryInputs;
     vector<string> primaryOutputs;
     double clockPeriod;
+    double holdTime;                    // Hold requirement at the primary outputs
+    string netlistSource;
+    string delaySource;
+    vector<DelayCorner> corners;        // Extra libraries for multi-corner analysis
+    DelayTableLibrary delayTables;      // Load/slew tables of the primary library
+    DelayCalculator delayCalculator;
+    vector<char> delayOverrides;        // Per gate, as in gates: delay set by setGateDelay
+    
+    // Compiled graph used by all analysis passes
+    TimingGraph graph;
+    vector<Node*> nodesById;
+    bool graphDirty;
+    
+    // Analysis results indexed by NodeId; Nodes read their values from here
+    TimingStore timing;
+    
+    void registerNode(Node* node);
+    Node* findOrCreateNode(Symbol name, bool isInput, bool isOutput);
+    void instantiateModels(const NetlistParser& parser, const vector<Node*>& nodeObjects,
+                           const string& netlistFile);
+    
+    void bindDelays();
+    static map<string, double> readDelayLibrary(const string& filename,
+                                                map<string, double>* sigmas = nullptr,
+                                                DelayTableLibrary* tables = nullptr);
+    static vector<double> resolvePerType(const map<string, double>& library);
 
 public:
     Circuit();
     ~Circuit() = default;
+    Circuit(const Circuit&) = delete;
+    Circuit& operator=(const Circuit&) = delete;
 
-    // File I/O
+    // File I/O. Netlists may instantiate extracted timing models (MODEL and
+    // INSTANCE lines, see TimingModel.h) as one MACRO gate per model output.
     void loadCircuit(const string& filename);
     void loadDelays(const string& filename);
     
+    // Multi-corner libraries, all timed in one pass by TimingAnalyzer. The
+    // first becomes the primary library (as if passed to loadDelays), which
+    // drives the node table, paths and ECO updates. Each corner is named
+    // after its file without directory or extension. Every corner keeps its
+    // own SETUP_TIME, HOLD_TIME and delay tables.
+    void loadCorners(const vector<string>& filenames);
+    const vector<DelayCorner>& getCorners() const { return corners; }
+    // Delay of every gate in one corner: its library's delay per type, or
+    // for gates with a table, the delay at their load and slew under that
+    // corner's tables, the way calculateDelays binds the primary library
+    void calculateCornerDelays(int corner, vector<double>& delays) const;
+    
+    // Binary snapshots of the loaded circuit (see CircuitSnapshot.h).
+    // loadSnapshot only accepts a snapshot compiled from exactly these source
+    // files and leaves the circuit untouched otherwise; loadCached falls back
+    // to the text files and then rewrites the snapshot.
+    bool saveSnapshot(const string& filename);
+    bool loadSnapshot(const string& filename, const string& netlistFile, const string& delayFile);
+    void loadCached(const string& netlistFile, const string& delayFile, const string& snapshotFile);
+    
     // Circuit construction
     void addNode(const string& name, bool isInput = false, bool isOutput = false);
     void addGate(const string& type, const string& name, 
                 const vector<string>& inputs, const string& output);
     
-    // Getters
-    map<string, shared_ptr<Node>>& getNodes() { return nodes; }
-    vector<shared_ptr<Gate>>& getGates() { return gates; }
+    // Getters. getNodes() lists nodes in name order; gates removed by an
+    // edit leave a nullptr in getGates() until the graph is rebuilt.
+    const vector<Node*>& getNodes() const;
+    int getNodeCount() const { return static_cast<int>(nodes.size()); }
+    vector<Gate*>& getGates() { return gates; }
+    const Arena& getArena() const { return arena; }
     vector<string>& getPrimaryInputs() { return primaryInputs; }
     vector<string>& getPrimaryOutputs() { return primaryOutputs; }
     double getClockPeriod() const { return clockPeriod; }
     void setClockPeriod(double period) { clockPeriod = period; }
+    double getHoldTime() const { return holdTime; }
+    void setHoldTime(double time) { holdTime = time; }
+    // Register checks at DFF data inputs, from the library's SETUP_TIME and
+    // HOLD_TIME lines (0 when absent); clock-to-Q is the DFF delay
+    double getSetupTime() const { return getGateDelay("SETUP_TIME"); }
+    double getRegisterHoldTime() const { return getGateDelay("HOLD_TIME"); }
+    
+    // Table delay model (see DelayTable.h). With tables in the library,
+    // calculateDelays binds every tabled gate's delay from its load and
+    // input slew and fills the slew and capacitance of every node;
+    // updateDelays redoes that after an edit, starting from the nodes whose
+    // fanout pins changed and those whose driver changed, and returns the
+    // gates whose delay changed. Slews start at the library's INPUT_SLEW and
+    // primary outputs carry an extra OUTPUT_LOAD. Gates given a delay by
+    // setGateDelay keep it until loadDelays or setGateType rebinds them.
+    bool hasDelayTables() const { return delayTables.hasTables(); }
+    void calculateDelays();
+    void updateDelays(const vector<NodeId>& loadChanged, const vector<NodeId>& driverChanged,
+                      vector<GateId>& changedGates);
+    const DelayCalculator& getDelayCalculator() const { return delayCalculator; }
+    
+    // Netlist edits (ECO). Once the graph is compiled, these and addGate
+    // patch it in place instead of forcing a rebuild.
+    void setGateDelay(const string& gateName, double delay);
+    void setGateType(const string& gateName, const string& type);
+    void removeGate(const string& gateName);
+    void reconnectGateInput(const string& gateName, int pin, const string& nodeName);
+    
+    // Compiled timing graph (rebuilt lazily after construction changes).
+    // getGraph() also restores the level order after edits; getLiveGraph()
+    // skips that and only guarantees valid connectivity and node levels.
+    void buildGraph();
+    const TimingGraph& getGraph();
+    const TimingGraph& getLiveGraph() const { return graph; }
+    Node* getNodeById(NodeId id) const { return nodesById[id]; }
+    TimingStore& getTiming() { return timing; }
+    const TimingStore& getTiming() const { return timing; }
     
     // Utility functions
-    shared_ptr<Node> getNode(const string& name);
+    Gate* getGate(const string& gateName);
+    Node* getNode(const string& name) const;
     double getGateDelay(const string& gateType) const;
+    double getGateDelay(GateType type) const { return typeDelays[static_cast<int>(type)]; }
+    // Delay standard deviation per GateType, 0 where the library gives none
+    const vector<double>& getTypeSigmas() const { return typeSigmas; }
     void printCircuit() const;
     
-    // Validation
+    // Validation: validateCircuit checks that every gate references nodes of
+    // this circuit. printValidationWarnings writes what ordering the compiled
+    // graph found (loops, multiply-driven, undriven and dangling nets; see
+    // GraphValidation) and returns false if there was anything.
     bool validateCircuit() const;
+    bool printValidationWarnings(ostream& out) const;
 };
 
 #endif // CIRCUIT_H
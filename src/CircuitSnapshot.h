@@ -0,0 +1,366 @@
+#ifndef CIRCUIT_SNAPSHOT_H
+#define CIRCUIT_SNAPSHOT_H
+
+#include <cstdint>
+#include <cstring>
+#include <fstream>
+#include <map>
+#include <string>
+#include <string_view>
+#include <vector>
+#include "TimingGraph.h"
+#include "NetlistParser.h"
+
+using namespace std;
+
+// Versioned binary image of a compiled circuit: interned node and gate names,
+// gate types, connectivity, primary I/O and the bound delay library. Every
+// section is a flat array aligned to 8 bytes, so a mapped snapshot is read in
+// place without any decoding. The header carries a checksum of the payload
+// and fingerprints of the netlist and delay files it was compiled from.
+//
+// Layout: SnapshotHeader, then the sections in Section order. Offsets in the
+// header are relative to the start of the file.
+class CircuitSnapshot {
+public:
+    static const uint32_t FORMAT_VERSION = 3;
+
+    enum Section {
+        STRING_POOL,            // char: every name, back to back
+        NODE_NAME_OFFSETS,      // uint64 x (nodes + 1), into STRING_POOL
+        NODE_FLAGS,             // uint8 x nodes: bit 0 input, bit 1 output
+        GATE_NAME_OFFSETS,      // uint64 x (gates + 1)
+        GATE_TYPES,             // int32 x gates, index into TYPE_NAME_OFFSETS
+        GATE_OUTPUTS,           // int32 x gates
+        GATE_DELAYS,            // double x gates, as bound in the graph
+        FANIN_OFFSETS,          // int32 x (gates + 1), into FANIN_NODES
+        FANIN_NODES,            // int32 x edges
+        TYPE_NAME_OFFSETS,      // uint64 x (types + 1)
+        CIRCUIT_INPUTS,         // int32: every INPUT mention, in file order
+        CIRCUIT_OUTPUTS,        // int32: every OUTPUT mention, in file order
+        LIBRARY_NAME_OFFSETS,   // uint64 x (library entries + 1)
+        LIBRARY_DELAYS,         // double x library entries
+        LIBRARY_SIGMAS,         // double x library entries, 0 when not given
+        SECTION_COUNT
+    };
+
+private:
+    struct SnapshotHeader {
+        char magic[8];
+        uint32_t version;
+        uint32_t byteOrder;             // Reads back as BYTE_ORDER_MARK on a matching host
+        uint64_t fileSize;
+        uint64_t payloadChecksum;       // hashBytes over everything after the header
+        uint64_t netlistFingerprint;
+        uint64_t delayFingerprint;
+        double clockPeriod;
+        double holdTime;
+        uint64_t nodeCount;
+        uint64_t gateCount;
+        uint64_t sectionOffsets[SECTION_COUNT];
+        uint64_t sectionSizes[SECTION_COUNT];   // In bytes, before padding
+    };
+
+    static const uint32_t BYTE_ORDER_MARK = 0x01020304;
+
+    MappedFile file;
+    const SnapshotHeader* header;
+
+    template <typename T>
+    const T* section(Section id) const {
+        return reinterpret_cast<const T*>(file.getData() + header->sectionOffsets[id]);
+    }
+    template <typename T>
+    size_t sectionCount(Section id) const { return header->sectionSizes[id] / sizeof(T); }
+
+    string_view poolString(Section offsets, size_t index) const;
+    bool validate() const;
+
+    static void appendName(vector<char>& pool, vector<uint64_t>& offsets, const string& name);
+
+public:
+    CircuitSnapshot();
+
+    // Maps the file and checks magic, version, byte order, section bounds,
+    // checksum and ID ranges. Returns false if any of them fails.
+    bool open(const string& filename);
+
+    // Writes the live gates of a finalized graph; removed gates are dropped
+    // and the rest renumbered. Returns false if the file cannot be written.
+    static bool write(const string& filename,
+                      const TimingGraph& graph,
+                      double clockPeriod,
+                      double holdTime,
+                      const map<string, double>& library,
+                      const map<string, double>& librarySigmas,
+                      const vector<NodeId>& circuitInputs,
+                      const vector<NodeId>& circuitOutputs,
+                      uint64_t netlistFingerprint,
+                      uint64_t delayFingerprint);
+
+    // Content hash of a source file, used to detect stale snapshots
+    static bool fingerprintFile(const string& filename, uint64_t& fingerprint);
+    static uint64_t hashBytes(const char* data, size_t size);
+
+    uint64_t getNetlistFingerprint() const { return header->netlistFingerprint; }
+    uint64_t getDelayFingerprint() const { return header->delayFingerprint; }
+    double getClockPeriod() const { return header->clockPeriod; }
+    double getHoldTime() const { return header->holdTime; }
+
+    int getNodeCount() const { return static_cast<int>(header->nodeCount); }
+    string_view getNodeName(NodeId node) const { return poolString(NODE_NAME_OFFSETS, node); }
+    bool isInput(NodeId node) const { return (section<uint8_t>(NODE_FLAGS)[node] & 1) != 0; }
+    bool isOutput(NodeId node) const { return (section<uint8_t>(NODE_FLAGS)[node] & 2) != 0; }
+
+    int getGateCount() const { return static_cast<int>(header->gateCount); }
+    int getEdgeCount() const { return static_cast<int>(sectionCount<int32_t>(FANIN_NODES)); }
+    string_view getGateName(GateId gate) const { return poolString(GATE_NAME_OFFSETS, gate); }
+    string_view getGateType(GateId gate) const {
+        return poolString(TYPE_NAME_OFFSETS, section<int32_t>(GATE_TYPES)[gate]);
+    }
+    NodeId getOutput(GateId gate) const { return section<int32_t>(GATE_OUTPUTS)[gate]; }
+    double getDelay(GateId gate) const { return section<double>(GATE_DELAYS)[gate]; }
+    const NodeId* faninBegin(GateId gate) const {
+        return section<int32_t>(FANIN_NODES) + section<int32_t>(FANIN_OFFSETS)[gate];
+    }
+    const NodeId* faninEnd(GateId gate) const {
+        return section<int32_t>(FANIN_NODES) + section<int32_t>(FANIN_OFFSETS)[gate + 1];
+    }
+
+    const NodeId* circuitInputsBegin() const { return section<int32_t>(CIRCUIT_INPUTS); }
+    const NodeId* circuitInputsEnd() const {
+        return circuitInputsBegin() + sectionCount<int32_t>(CIRCUIT_INPUTS);
+    }
+    const NodeId* circuitOutputsBegin() const { return section<int32_t>(CIRCUIT_OUTPUTS); }
+    const NodeId* circuitOutputsEnd() const {
+        return circuitOutputsBegin() + sectionCount<int32_t>(CIRCUIT_OUTPUTS);
+    }
+
+    int getLibrarySize() const { return static_cast<int>(sectionCount<double>(LIBRARY_DELAYS)); }
+    string_view getLibraryType(int entry) const { return poolString(LIBRARY_NAME_OFFSETS, entry); }
+    double getLibraryDelay(int entry) const { return section<double>(LIBRARY_DELAYS)[entry]; }
+    double getLibrarySigma(int entry) const { return section<double>(LIBRARY_SIGMAS)[entry]; }
+};
+
+// ===== Implementation =======================================================
+
+static_assert(sizeof(NodeId) == sizeof(int32_t), "snapshot stores IDs as int32");
+
+CircuitSnapshot::CircuitSnapshot() : header(nullptr) {
+}
+
+uint64_t CircuitSnapshot::hashBytes(const char* data, size_t size) {
+    // Word-at-a-time multiply/xorshift mix; meant to catch corruption and
+    // edits, not to resist deliberate collisions
+    const uint64_t multiplier = 0x9E3779B97F4A7C15ULL;
+    uint64_t hash = 0xCBF29CE484222325ULL ^ (size * multiplier);
+    size_t words = size / 8;
+    for (size_t i = 0; i < words; ++i) {
+        uint64_t word;
+        memcpy(&word, data + i * 8, 8);
+        hash = (hash ^ word) * multiplier;
+        hash ^= hash >> 32;
+    }
+    uint64_t tail = 0;
+    if (size > words * 8) memcpy(&tail, data + words * 8, size - words * 8);
+    hash = (hash ^ tail) * multiplier;
+    return hash ^ (hash >> 29);
+}
+
+bool CircuitSnapshot::fingerprintFile(const string& filename, uint64_t& fingerprint) {
+    MappedFile source;
+    if (!source.open(filename)) return false;
+    fingerprint = hashBytes(source.getData(), source.getSize());
+    return true;
+}
+
+string_view CircuitSnapshot::poolString(Section offsets, size_t index) const {
+    const uint64_t* bounds = section<uint64_t>(offsets);
+    return string_view(section<char>(STRING_POOL) + bounds[index],
+                       static_cast<size_t>(bounds[index + 1] - bounds[index]));
+}
+
+bool CircuitSnapshot::open(const string& filename) {
+    header = nullptr;
+    if (!file.open(filename)) return false;
+    if (file.getSize() < sizeof(SnapshotHeader)) return false;
+
+    header = reinterpret_cast<const SnapshotHeader*>(file.getData());
+    if (validate()) return true;
+
+    header = nullptr;
+    file.close();
+    return false;
+}
+
+bool CircuitSnapshot::validate() const {
+    if (memcmp(header->magic, "STASNAP", 8) != 0) return false;
+    if (header->version != FORMAT_VERSION || header->byteOrder != BYTE_ORDER_MARK) return false;
+    if (header->fileSize != file.getSize()) return false;
+
+    for (int id = 0; id < SECTION_COUNT; ++id) {
+        uint64_t offset = header->sectionOffsets[id];
+        if (offset % 8 != 0 || offset < sizeof(SnapshotHeader) || offset > header->fileSize ||
+            header->sectionSizes[id] > header->fileSize - offset) {
+            return false;
+        }
+    }
+
+    const char* payload = file.getData() + sizeof(SnapshotHeader);
+    if (hashBytes(payload, file.getSize() - sizeof(SnapshotHeader)) != header->payloadChecksum) {
+        return false;
+    }
+
+    // The checksum guards against damage; these guard the accessors against
+    // a well-formed file that is internally inconsistent
+    uint64_t nodes = header->nodeCount;
+    uint64_t gates = header->gateCount;
+    uint64_t poolSize = header->sectionSizes[STRING_POOL];
+    auto checkOffsets = [&](Section id, uint64_t entries) {
+        if (sectionCount<uint64_t>(id) != entries + 1) return false;
+        const uint64_t* offsets = section<uint64_t>(id);
+        for (uint64_t i = 0; i < entries; ++i) {
+            if (offsets[i] > offsets[i + 1]) return false;
+        }
+        return offsets[entries] <= poolSize;
+    };
+    auto checkIds = [&](const int32_t* ids, size_t count, uint64_t limit) {
+        for (size_t i = 0; i < count; ++i) {
+            if (ids[i] < 0 || static_cast<uint64_t>(ids[i]) >= limit) return false;
+        }
+        return true;
+    };
+
+    if (sectionCount<uint64_t>(TYPE_NAME_OFFSETS) == 0) return false;
+    uint64_t types = sectionCount<uint64_t>(TYPE_NAME_OFFSETS) - 1;
+    uint64_t libraryEntries = sectionCount<double>(LIBRARY_DELAYS);
+    if (!checkOffsets(TYPE_NAME_OFFSETS, types) || !checkOffsets(NODE_NAME_OFFSETS, nodes) ||
+        !checkOffsets(GATE_NAME_OFFSETS, gates) || !checkOffsets(LIBRARY_NAME_OFFSETS, libraryEntries)) {
+        return false;
+    }
+    if (sectionCount<uint8_t>(NODE_FLAGS) != nodes || sectionCount<int32_t>(GATE_TYPES) != gates ||
+        sectionCount<int32_t>(GATE_OUTPUTS) != gates || sectionCount<double>(GATE_DELAYS) != gates ||
+        sectionCount<int32_t>(FANIN_OFFSETS) != gates + 1 ||
+        sectionCount<double>(LIBRARY_SIGMAS) != libraryEntries) {
+        return false;
+    }
+
+    const int32_t* faninOffsets = section<int32_t>(FANIN_OFFSETS);
+    uint64_t edges = sectionCount<int32_t>(FANIN_NODES);
+    if (faninOffsets[0] != 0 || static_cast<uint64_t>(faninOffsets[gates]) != edges) return false;
+    for (uint64_t gate = 0; gate < gates; ++gate) {
+        if (faninOffsets[gate] > faninOffsets[gate + 1]) return false;
+    }
+
+    return checkIds(section<int32_t>(GATE_TYPES), gates, types) &&
+           checkIds(section<int32_t>(GATE_OUTPUTS), gates, nodes) &&
+           checkIds(section<int32_t>(FANIN_NODES), edges, nodes) &&
+           checkIds(section<int32_t>(CIRCUIT_INPUTS), sectionCount<int32_t>(CIRCUIT_INPUTS), nodes) &&
+           checkIds(section<int32_t>(CIRCUIT_OUTPUTS), sectionCount<int32_t>(CIRCUIT_OUTPUTS), nodes);
+}
+
+void CircuitSnapshot::appendName(vector<char>& pool, vector<uint64_t>& offsets, const string& name) {
+    pool.insert(pool.end(), name.begin(), name.end());
+    offsets.push_back(pool.size());
+}
+
+bool CircuitSnapshot::write(const string& filename,
+                            const TimingGraph& graph,
+                            double clockPeriod,
+                            double holdTime,
+                            const map<string, double>& library,
+                            const map<string, double>& librarySigmas,
+                            const vector<NodeId>& circuitInputs,
+                            const vector<NodeId>& circuitOutputs,
+                            uint64_t netlistFingerprint,
+                            uint64_t delayFingerprint) {
+    vector<char> pool;
+    // Each name table starts where the pool currently ends
+    vector<uint64_t> nodeNameOffsets, gateNameOffsets, typeNameOffsets, libraryNameOffsets;
+    vector<uint8_t> nodeFlags;
+    vector<int32_t> gateTypes, gateOutputs, faninOffsets(1, 0), faninNodes;
+    vector<double> gateDelays, libraryDelays, librarySigmaValues;
+
+    nodeNameOffsets.push_back(pool.size());
+    for (NodeId node = 0; node < graph.getNodeCount(); ++node) {
+        appendName(pool, nodeNameOffsets, graph.getNodeName(node));
+        nodeFlags.push_back((graph.isInput(node) ? 1 : 0) | (graph.isOutput(node) ? 2 : 0));
+    }
+
+    vector<string> typeNames;
+    gateNameOffsets.push_back(pool.size());
+    for (GateId gate = 0; gate < graph.getGateCount(); ++gate) {
+        if (graph.isRemoved(gate)) continue;
+        const string& type = graph.getGateTypeName(gate);
+        auto it = find(typeNames.begin(), typeNames.end(), type);
+        if (it == typeNames.end()) {
+            it = typeNames.insert(typeNames.end(), type);
+        }
+
+        appendName(pool, gateNameOffsets, graph.getGateName(gate));
+        gateTypes.push_back(static_cast<int32_t>(it - typeNames.begin()));
+        gateOutputs.push_back(graph.getOutput(gate));
+        gateDelays.push_back(graph.getDelay(gate));
+        faninNodes.insert(faninNodes.end(), graph.faninBegin(gate), graph.faninEnd(gate));
+        faninOffsets.push_back(static_cast<int32_t>(faninNodes.size()));
+    }
+    typeNameOffsets.push_back(pool.size());
+    for (const auto& type : typeNames) {
+        appendName(pool, typeNameOffsets, type);
+    }
+    libraryNameOffsets.push_back(pool.size());
+    for (const auto& entry : library) {
+        appendName(pool, libraryNameOffsets, entry.first);
+        libraryDelays.push_back(entry.second);
+        auto sigma = librarySigmas.find(entry.first);
+        librarySigmaValues.push_back(sigma != librarySigmas.end() ? sigma->second : 0.0);
+    }
+
+    SnapshotHeader head;
+    memset(&head, 0, sizeof(head));
+    memcpy(head.magic, "STASNAP", 8);
+    head.version = FORMAT_VERSION;
+    head.byteOrder = BYTE_ORDER_MARK;
+    head.netlistFingerprint = netlistFingerprint;
+    head.delayFingerprint = delayFingerprint;
+    head.clockPeriod = clockPeriod;
+    head.holdTime = holdTime;
+    head.nodeCount = static_cast<uint64_t>(graph.getNodeCount());
+    head.gateCount = gateTypes.size();
+
+    // Sections are laid out in enum order, each padded to 8 bytes
+    vector<char> payload;
+    auto place = [&](Section id, const void* data, size_t bytes) {
+        head.sectionOffsets[id] = sizeof(SnapshotHeader) + payload.size();
+        head.sectionSizes[id] = bytes;
+        const char* begin = static_cast<const char*>(data);
+        payload.insert(payload.end(), begin, begin + bytes);
+        payload.resize((payload.size() + 7) & ~static_cast<size_t>(7), 0);
+    };
+    place(STRING_POOL, pool.data(), pool.size());
+    place(NODE_NAME_OFFSETS, nodeNameOffsets.data(), nodeNameOffsets.size() * sizeof(uint64_t));
+    place(NODE_FLAGS, nodeFlags.data(), nodeFlags.size());
+    place(GATE_NAME_OFFSETS, gateNameOffsets.data(), gateNameOffsets.size() * sizeof(uint64_t));
+    place(GATE_TYPES, gateTypes.data(), gateTypes.size() * sizeof(int32_t));
+    place(GATE_OUTPUTS, gateOutputs.data(), gateOutputs.size() * sizeof(int32_t));
+    place(GATE_DELAYS, gateDelays.data(), gateDelays.size() * sizeof(double));
+    place(FANIN_OFFSETS, faninOffsets.data(), faninOffsets.size() * sizeof(int32_t));
+    place(FANIN_NODES, faninNodes.data(), faninNodes.size() * sizeof(int32_t));
+    place(TYPE_NAME_OFFSETS, typeNameOffsets.data(), typeNameOffsets.size() * sizeof(uint64_t));
+    place(CIRCUIT_INPUTS, circuitInputs.data(), circuitInputs.size() * sizeof(int32_t));
+    place(CIRCUIT_OUTPUTS, circuitOutputs.data(), circuitOutputs.size() * sizeof(int32_t));
+    place(LIBRARY_NAME_OFFSETS, libraryNameOffsets.data(), libraryNameOffsets.size() * sizeof(uint64_t));
+    place(LIBRARY_DELAYS, libraryDelays.data(), libraryDelays.size() * sizeof(double));
+    place(LIBRARY_SIGMAS, librarySigmaValues.data(), librarySigmaValues.size() * sizeof(double));
+
+    head.fileSize = sizeof(SnapshotHeader) + payload.size();
+    head.payloadChecksum = hashBytes(payload.data(), payload.size());
+
+    ofstream out(filename, ios::binary | ios::trunc);
+    if (!out.is_open()) return false;
+    out.write(reinterpret_cast<const char*>(&head), sizeof(head));
+    out.write(payload.data(), static_cast<streamsize>(payload.size()));
+    return static_cast<bool>(out);
+}
+
+#endif // CIRCUIT_SNAPSHOT_H
@@ -0,0 +1,153 @@
+#ifndef CORNER_TIMING_H
+#define CORNER_TIMING_H
+
+#include <cstddef>
+#include <limits>
+#include <string>
+#include <vector>
+#include "DelayTable.h"
+#include "SimdDouble.h"
+#include "TimingGraph.h"
+
+using namespace std;
+
+// One delay library of a multi-corner run (e.g. slow, typical, fast)
+struct DelayCorner {
+    string name;
+    string source;
+    vector<double> typeDelays;      // Indexed by GateType
+    double setupTime;               // The library's SETUP_TIME
+    double registerHoldTime;        // The library's HOLD_TIME
+    DelayTableLibrary tables;       // Load/slew tables, if the library has any
+    double inputSlew;
+    double outputLoad;
+};
+
+// Worst slacks and longest path of one corner after analysis
+struct CornerResult {
+    string name;
+    double worstSlack;
+    double totalDelay;
+    double worstHoldSlack;
+};
+
+// Arrival and required times of every corner, propagated together. Each
+// node owns `stride` consecutive doubles, one lane per corner, with stride
+// rounded up to a whole number of SIMD vectors so a gate is timed for all
+// corners with a few vector max/min/add operations. Early arrival and hold
+// required times get lanes of their own, so every corner is checked for
+// setup and hold against its own library's SETUP_TIME and HOLD_TIME. Unused
+// lanes carry arrival 0, required +inf and delay 0.
+//
+// Delays are kept per gate type, which stays in L1 however large the
+// design is, unless a corner has delay tables: then every gate gets its
+// own row of delays, bound from that corner's tables (see
+// Circuit::calculateCornerDelays). Lane 0 of either table is zero: the
+// primary corner uses each gate's bound delay instead, so per-gate overrides
+// are honoured.
+struct CornerTimingStore {
+    int cornerCount = 0;
+    int stride = 0;
+    vector<double> arrival;         // node * stride + corner
+    vector<double> required;        // node * stride + corner
+    vector<double> earlyArrival;    // node * stride + corner
+    vector<double> holdRequired;    // node * stride + corner
+    vector<double> typeDelay;       // GateType * stride + corner
+    vector<double> gateDelay;       // GateId * stride + corner; empty without tables
+    vector<double> setupTime;       // One per lane
+    vector<double> registerHoldTime;
+
+    void clear();
+    void reset(int nodeCount, const vector<DelayCorner>& corners);
+
+    double* arrivalOf(NodeId node) { return arrival.data() + static_cast<size_t>(node) * stride; }
+    double* requiredOf(NodeId node) { return required.data() + static_cast<size_t>(node) * stride; }
+    double* earlyArrivalOf(NodeId node) { return earlyArrival.data() + static_cast<size_t>(node) * stride; }
+    double* holdRequiredOf(NodeId node) { return holdRequired.data() + static_cast<size_t>(node) * stride; }
+    const double* arrivalOf(NodeId node) const { return arrival.data() + static_cast<size_t>(node) * stride; }
+    const double* requiredOf(NodeId node) const { return required.data() + static_cast<size_t>(node) * stride; }
+    const double* earlyArrivalOf(NodeId node) const { return earlyArrival.data() + static_cast<size_t>(node) * stride; }
+    const double* holdRequiredOf(NodeId node) const { return holdRequired.data() + static_cast<size_t>(node) * stride; }
+    const double* delayOf(GateType type) const { return typeDelay.data() + static_cast<size_t>(type) * stride; }
+    const double* delayOf(const TimingGraph& graph, GateId gate) const {
+        return gateDelay.empty() ? delayOf(graph.getGateType(gate))
+                                 : gateDelay.data() + static_cast<size_t>(gate) * stride;
+    }
+
+    // Lowest setup / hold slack of each corner over all nodes, clamped at `initial`
+    vector<double> minSlackPerCorner(double initial) const;
+    vector<double> minHoldSlackPerCorner(double initial) const;
+
+private:
+    static vector<double> minDifferencePerCorner(const vector<double>& minuend, const vector<double>& subtrahend,
+                                                 int cornerCount, int stride, double initial);
+};
+
+// ===== Implementation =======================================================
+
+void CornerTimingStore::clear() {
+    cornerCount = 0;
+    stride = 0;
+    arrival.clear();
+    required.clear();
+    earlyArrival.clear();
+    holdRequired.clear();
+    typeDelay.clear();
+    gateDelay.clear();
+    setupTime.clear();
+    registerHoldTime.clear();
+}
+
+void CornerTimingStore::reset(int nodeCount, const vector<DelayCorner>& corners) {
+    cornerCount = static_cast<int>(corners.size());
+    stride = (cornerCount + SIMD_WIDTH - 1) / SIMD_WIDTH * SIMD_WIDTH;
+    arrival.assign(static_cast<size_t>(nodeCount) * stride, 0.0);
+    required.assign(static_cast<size_t>(nodeCount) * stride, numeric_limits<double>::infinity());
+    earlyArrival.assign(static_cast<size_t>(nodeCount) * stride, 0.0);
+    holdRequired.assign(static_cast<size_t>(nodeCount) * stride, -numeric_limits<double>::infinity());
+    typeDelay.assign(static_cast<size_t>(GATE_TYPE_COUNT) * stride, 0.0);
+    gateDelay.clear();
+    setupTime.assign(stride, 0.0);
+    registerHoldTime.assign(stride, 0.0);
+    for (int c = 0; c < cornerCount; ++c) {
+        setupTime[c] = corners[c].setupTime;
+        registerHoldTime[c] = corners[c].registerHoldTime;
+    }
+    for (int type = 0; type < GATE_TYPE_COUNT; ++type) {
+        for (int c = 1; c < cornerCount; ++c) {
+            typeDelay[static_cast<size_t>(type) * stride + c] = corners[c].typeDelays[type];
+        }
+    }
+}
+
+vector<double> CornerTimingStore::minSlackPerCorner(double initial) const {
+    return minDifferencePerCorner(required, arrival, cornerCount, stride, initial);
+}
+
+vector<double> CornerTimingStore::minHoldSlackPerCorner(double initial) const {
+    return minDifferencePerCorner(earlyArrival, holdRequired, cornerCount, stride, initial);
+}
+
+vector<double> CornerTimingStore::minDifferencePerCorner(const vector<double>& minuend,
+                                                         const vector<double>& subtrahend,
+                                                         int cornerCount, int stride, double initial) {
+    // One vector accumulator per SIMD group of corners
+    vector<double> result(cornerCount);
+    size_t nodeCount = stride ? minuend.size() / stride : 0;
+    alignas(32) double lanes[SIMD_WIDTH];
+    for (int group = 0; group < stride; group += SIMD_WIDTH) {
+        SimdDouble lowest = simdBroadcast(initial);
+        const double* from = minuend.data() + group;
+        const double* take = subtrahend.data() + group;
+        for (size_t node = 0; node < nodeCount; ++node) {
+            lowest = simdMin(lowest, simdSub(simdLoad(from + node * stride), simdLoad(take + node * stride)));
+        }
+        simdStore(lanes, lowest);
+        for (int i = 0; i < SIMD_WIDTH && group + i < cornerCount; ++i) {
+            result[group + i] = lanes[i];
+        }
+    }
+    return result;
+}
+
+#endif // CORNER_TIMING_H
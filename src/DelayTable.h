@@ -0,0 +1,420 @@
+#ifndef DELAY_TABLE_H
+#define DELAY_TABLE_H
+
+#include <algorithm>
+#include <cstdint>
+#include <cstring>
+#include <istream>
+#include <queue>
+#include <stdexcept>
+#include <string>
+#include <utility>
+#include <vector>
+#include "GateType.h"
+#include "SimdDouble.h"
+#include "TimingGraph.h"
+
+using namespace std;
+
+// Delay and output slew of one gate type as 2-D tables (a non-linear delay
+// model): rows follow the slew at the gate's inputs, columns the load on its
+// output, both ascending. Values between breakpoints are interpolated
+// bilinearly; outside the grid the outermost cells are extrapolated.
+struct DelayTable {
+    vector<double> slewIndex;
+    vector<double> loadIndex;
+    vector<double> delays;      // slewIndex.size() x loadIndex.size(), row by row
+    vector<double> slews;       // Same layout; empty: the input slew passes through
+
+    bool empty() const { return delays.empty(); }
+};
+
+// Table part of a delay library. Besides "<type> <delay> [sigma]", a library
+// file may hold
+//   PIN_CAP <type> <capacitance>       load of each input pin of the type
+//   SLEW_INDEX <type> <slew>...        row breakpoints (ns)
+//   LOAD_INDEX <type> <load>...        column breakpoints (same unit as PIN_CAP)
+//   DELAY_TABLE <type> <delay>...      one line per row, one value per column
+//   SLEW_TABLE <type> <slew>...        output slews, same layout
+// Types with a DELAY_TABLE are timed from it; the others keep their constant
+// delay and pass their worst input slew through.
+class DelayTableLibrary {
+public:
+    DelayTableLibrary() { clear(); }
+
+    void clear();
+    static bool isTableKeyword(const string& word);
+    // Reads the values after a keyword and type name; throws on bad input
+    void parseLine(const string& keyword, istream& values);
+    // Checks every table's shape once the file is read
+    void validate(const string& source) const;
+
+    bool hasTables() const;
+    const DelayTable& getTable(GateType type) const { return tables[static_cast<int>(type)]; }
+    double getPinCapacitance(GateType type) const { return pinCapacitance[static_cast<int>(type)]; }
+
+private:
+    vector<DelayTable> tables;              // Indexed by GateType
+    vector<double> pinCapacitance;          // Indexed by GateType
+};
+
+// Delay calculation with a table library, run before propagation. A net's
+// load is the capacitance of every input pin it drives (plus OUTPUT_LOAD on
+// primary outputs), and each gate is looked up at its load and the worst slew
+// among its inputs; the resulting delay is bound into the gate like a
+// library delay, so every pass downstream works unchanged. Primary inputs,
+// undriven nets and register clock pins have the library's INPUT_SLEW.
+//
+// Loads are sums of a few pin capacitances and repeat all over a netlist,
+// while slews vary continuously. The load half of each interpolation is
+// therefore memoized per (type, load) in a direct-mapped cache as the table
+// rows already blended along the load axis, leaving one 1-D interpolation
+// along the slew axis per lookup. Lookups are batched per level and
+// interpolated SIMD_WIDTH at a time, every lane going through the same
+// vector operations, so a value never depends on whether it came from a
+// full pass or an incremental update.
+class DelayCalculator {
+public:
+    static const int CACHE_BITS = 14;           // 2^14 cache entries
+    static const int CACHE_SIZE = 1 << CACHE_BITS;
+
+    DelayCalculator();
+
+    void setLibrary(const DelayTableLibrary* library, double inputSlew, double outputLoad);
+
+    // Every node's load and slew, and the delay of every gate with a table;
+    // delays holds one entry per gate and is left alone for the others.
+    // Gates flagged in fixedDelays (per GateId, may be null or short) keep
+    // their delay, but their output slew is still looked up.
+    void calculate(const TimingGraph& graph, vector<double>& loads, vector<double>& slews,
+                   vector<double>& delays, const vector<char>* fixedDelays);
+    // After an edit: recomputes the loads and slews of loadChanged and
+    // recompute, and onwards while slews change. Gates whose delay changed
+    // are appended to changedGates with their new delay.
+    void update(const TimingGraph& graph, const vector<NodeId>& loadChanged,
+                const vector<NodeId>& recompute, vector<double>& loads, vector<double>& slews,
+                vector<pair<GateId, double>>& changedGates, const vector<char>* fixedDelays);
+
+    // Table lookups since the last full calculation, and those whose load
+    // interpolation came from the cache
+    long long getLookupCount() const { return lookupCount; }
+    long long getCacheHitCount() const { return cacheHitCount; }
+
+private:
+    struct Request {
+        GateType type;
+        double slew;
+        double load;
+    };
+    struct CacheEntry {
+        uint64_t loadBits;
+        int type;                   // -1 for empty
+    };
+
+    const DelayTableLibrary* library;
+    double inputSlew;
+    double outputLoad;
+    vector<CacheEntry> cache;
+    vector<double> blendedRows;     // Per entry: delay rows, then slew rows
+    int rowStride;                  // Most rows of any table
+    long long lookupCount;
+    long long cacheHitCount;
+
+    double nodeLoad(const TimingGraph& graph, NodeId node) const;
+    static bool isFixed(const vector<char>* fixedDelays, GateId gate) {
+        return fixedDelays && gate < static_cast<GateId>(fixedDelays->size()) && (*fixedDelays)[gate];
+    }
+    // What drives a node and at which input slew; false if nothing is looked
+    // up (the slew is then final)
+    bool prepare(const TimingGraph& graph, NodeId node, const vector<double>& slews,
+                 GateId& gate, double& slew) const;
+    const double* rowsAtLoad(GateType type, double load);
+    void interpolate(const Request* requests, int count, double* delays, double* slews);
+    static void bracket(const vector<double>& index, double value, int& low, int& high, double& weight);
+};
+
+// ===== Implementation =======================================================
+
+void DelayTableLibrary::clear() {
+    tables.assign(GATE_TYPE_COUNT, DelayTable());
+    pinCapacitance.assign(GATE_TYPE_COUNT, 0.0);
+}
+
+bool DelayTableLibrary::isTableKeyword(const string& word) {
+    return word == "PIN_CAP" || word == "SLEW_INDEX" || word == "LOAD_INDEX" ||
+           word == "DELAY_TABLE" || word == "SLEW_TABLE";
+}
+
+void DelayTableLibrary::parseLine(const string& keyword, istream& values) {
+    string typeName;
+    if (!(values >> typeName)) throw runtime_error(keyword + " needs a gate type");
+    GateType type = parseGateType(typeName);
+    if (type == GateType::UNKNOWN) throw runtime_error("Unknown gate type in " + keyword + ": " + typeName);
+
+    vector<double> numbers;
+    double value;
+    while (values >> value) numbers.push_back(value);
+    if (!values.eof()) throw runtime_error("Bad number in " + keyword + " " + typeName);
+    if (numbers.empty()) throw runtime_error(keyword + " " + typeName + " has no values");
+
+    DelayTable& table = tables[static_cast<int>(type)];
+    if (keyword == "PIN_CAP") {
+        pinCapacitance[static_cast<int>(type)] = numbers[0];
+    } else if (keyword == "SLEW_INDEX") {
+        table.slewIndex = numbers;
+    } else if (keyword == "LOAD_INDEX") {
+        table.loadIndex = numbers;
+    } else if (keyword == "DELAY_TABLE") {
+        table.delays.insert(table.delays.end(), numbers.begin(), numbers.end());
+    } else {
+        table.slews.insert(table.slews.end(), numbers.begin(), numbers.end());
+    }
+}
+
+void DelayTableLibrary::validate(const string& source) const {
+    for (int type = 0; type < GATE_TYPE_COUNT; ++type) {
+        const DelayTable& table = tables[type];
+        string name = GATE_TYPE_TRAITS[type].name;
+        if (table.empty()) {
+            if (!table.slews.empty()) throw runtime_error(source + ": SLEW_TABLE " + name + " without DELAY_TABLE");
+            continue;
+        }
+        if (table.slewIndex.empty() || table.loadIndex.empty()) {
+            throw runtime_error(source + ": DELAY_TABLE " + name + " needs SLEW_INDEX and LOAD_INDEX");
+        }
+        for (const vector<double>* index : {&table.slewIndex, &table.loadIndex}) {
+            for (size_t i = 1; i < index->size(); ++i) {
+                if (!((*index)[i] > (*index)[i - 1])) {
+                    throw runtime_error(source + ": table index of " + name + " must be ascending");
+                }
+            }
+        }
+        size_t cells = table.slewIndex.size() * table.loadIndex.size();
+        if (table.delays.size() != cells || (!table.slews.empty() && table.slews.size() != cells)) {
+            throw runtime_error(source + ": tables of " + name + " need " + to_string(cells) + " values");
+        }
+    }
+}
+
+bool DelayTableLibrary::hasTables() const {
+    for (const DelayTable& table : tables) {
+        if (!table.empty()) return true;
+    }
+    return false;
+}
+
+DelayCalculator::DelayCalculator()
+    : library(nullptr), inputSlew(0.0), outputLoad(0.0), rowStride(0), lookupCount(0), cacheHitCount(0) {
+}
+
+void DelayCalculator::setLibrary(const DelayTableLibrary* libraryValue, double inputSlewValue,
+                                 double outputLoadValue) {
+    library = libraryValue;
+    inputSlew = inputSlewValue;
+    outputLoad = outputLoadValue;
+    rowStride = 0;
+    for (int type = 0; type < GATE_TYPE_COUNT; ++type) {
+        const DelayTable& table = library->getTable(static_cast<GateType>(type));
+        if (!table.empty()) rowStride = max(rowStride, static_cast<int>(table.slewIndex.size()));
+    }
+    cache.assign(CACHE_SIZE, CacheEntry{0, -1});
+    blendedRows.assign(static_cast<size_t>(CACHE_SIZE) * 2 * rowStride, 0.0);
+    lookupCount = 0;
+    cacheHitCount = 0;
+}
+
+double DelayCalculator::nodeLoad(const TimingGraph& graph, NodeId node) const {
+    double load = graph.isOutput(node) ? outputLoad : 0.0;
+    for (const GateId* g = graph.fanoutBegin(node); g != graph.fanoutEnd(node); ++g) {
+        load += library->getPinCapacitance(graph.getGateType(*g));
+    }
+    return load;
+}
+
+bool DelayCalculator::prepare(const TimingGraph& graph, NodeId node, const vector<double>& slews,
+                              GateId& gate, double& slew) const {
+    gate = graph.getDriver(node);
+    slew = inputSlew;
+    if (gate == INVALID_ID) return false;
+    if (!graph.isRegister(gate)) {
+        // Worst slew among the inputs
+        const NodeId* in = graph.faninBegin(gate);
+        slew = slews[*in];
+        for (++in; in != graph.faninEnd(gate); ++in) slew = max(slew, slews[*in]);
+    }
+    return !library->getTable(graph.getGateType(gate)).empty();
+}
+
+void DelayCalculator::bracket(const vector<double>& index, double value, int& low, int& high,
+                              double& weight) {
+    // Interval holding the value, the first or last one outside the grid
+    int size = static_cast<int>(index.size());
+    if (size == 1) {
+        low = high = 0;
+        weight = 0.0;
+        return;
+    }
+    high = static_cast<int>(upper_bound(index.begin(), index.end(), value) - index.begin());
+    high = min(max(high, 1), size - 1);
+    low = high - 1;
+    weight = (value - index[low]) / (index[high] - index[low]);
+}
+
+const double* DelayCalculator::rowsAtLoad(GateType type, double load) {
+    uint64_t loadBits;
+    memcpy(&loadBits, &load, sizeof(loadBits));
+    // Multiplicative hash; the top bits depend on every bit of the key
+    uint64_t key = loadBits ^ (static_cast<uint64_t>(type) * 0xC2B2AE3D27D4EB4FULL);
+    size_t slot = (key * 0x9E3779B97F4A7C15ULL) >> (64 - CACHE_BITS);
+    double* rows = blendedRows.data() + slot * 2 * rowStride;
+    CacheEntry& entry = cache[slot];
+    if (entry.type == static_cast<int>(type) && entry.loadBits == loadBits) {
+        ++cacheHitCount;
+        return rows;
+    }
+
+    const DelayTable& table = library->getTable(type);
+    int column0, column1;
+    double weight;
+    bracket(table.loadIndex, load, column0, column1, weight);
+    int columns = static_cast<int>(table.loadIndex.size());
+    for (int row = 0; row < static_cast<int>(table.slewIndex.size()); ++row) {
+        const double* delays = table.delays.data() + row * columns;
+        rows[row] = delays[column0] + weight * (delays[column1] - delays[column0]);
+        if (table.slews.empty()) continue;
+        const double* slews = table.slews.data() + row * columns;
+        rows[rowStride + row] = slews[column0] + weight * (slews[column1] - slews[column0]);
+    }
+    entry.loadBits = loadBits;
+    entry.type = static_cast<int>(type);
+    return rows;
+}
+
+void DelayCalculator::interpolate(const Request* requests, int count, double* delays, double* slews) {
+    // The two rows around each request's slew, structure of arrays; the tail
+    // is padded with copies of the last request so every lane of every
+    // vector is a real lookup
+    const int BATCH = 64;
+    alignas(32) double low[2][BATCH];
+    alignas(32) double high[2][BATCH];
+    alignas(32) double weight[BATCH];
+    alignas(32) double result[2][BATCH];
+    for (int first = 0; first < count; first += BATCH) {
+        int size = min(BATCH, count - first);
+        int padded = (size + SIMD_WIDTH - 1) / SIMD_WIDTH * SIMD_WIDTH;
+        for (int i = 0; i < size; ++i) {
+            const Request& request = requests[first + i];
+            const DelayTable& table = library->getTable(request.type);
+            const double* rows = rowsAtLoad(request.type, request.load);
+            int row0, row1;
+            bracket(table.slewIndex, request.slew, row0, row1, weight[i]);
+            low[0][i] = rows[row0];
+            high[0][i] = rows[row1];
+            bool slewTable = !table.slews.empty();
+            low[1][i] = slewTable ? rows[rowStride + row0] : request.slew;
+            high[1][i] = slewTable ? rows[rowStride + row1] : request.slew;
+        }
+        for (int i = size; i < padded; ++i) {
+            weight[i] = weight[size - 1];
+            for (int value = 0; value < 2; ++value) {
+                low[value][i] = low[value][size - 1];
+                high[value][i] = high[value][size - 1];
+            }
+        }
+        lookupCount += size;
+        for (int i = 0; i < padded; i += SIMD_WIDTH) {
+            SimdDouble a = simdLoad(weight + i);
+            for (int value = 0; value < 2; ++value) {
+                SimdDouble v0 = simdLoad(low[value] + i);
+                SimdDouble v1 = simdLoad(high[value] + i);
+                simdStore(result[value] + i, simdAdd(v0, simdMul(a, simdSub(v1, v0))));
+            }
+        }
+        copy(result[0], result[0] + size, delays + first);
+        copy(result[1], result[1] + size, slews + first);
+    }
+}
+
+void DelayCalculator::calculate(const TimingGraph& graph, vector<double>& loads, vector<double>& slews,
+                                vector<double>& delays, const vector<char>* fixedDelays) {
+    int nodeCount = graph.getNodeCount();
+    lookupCount = 0;
+    cacheHitCount = 0;
+    loads.resize(nodeCount);
+    slews.assign(nodeCount, 0.0);
+    for (NodeId node = 0; node < nodeCount; ++node) loads[node] = nodeLoad(graph, node);
+
+    // Level by level, so every input slew is final before it is read; the
+    // lookups of a level are interpolated together
+    vector<Request> requests;
+    vector<NodeId> looked;
+    vector<double> levelDelays, levelSlews;
+    for (int level = 0; level < graph.getLevelCount(); ++level) {
+        requests.clear();
+        looked.clear();
+        for (const NodeId* n = graph.levelBegin(level); n != graph.levelEnd(level); ++n) {
+            GateId gate;
+            double slew;
+            if (!prepare(graph, *n, slews, gate, slew)) {
+                slews[*n] = slew;
+                continue;
+            }
+            requests.push_back({graph.getGateType(gate), slew, loads[*n]});
+            looked.push_back(*n);
+        }
+        levelDelays.resize(requests.size());
+        levelSlews.resize(requests.size());
+        interpolate(requests.data(), static_cast<int>(requests.size()), levelDelays.data(), levelSlews.data());
+        for (size_t i = 0; i < looked.size(); ++i) {
+            GateId gate = graph.getDriver(looked[i]);
+            if (!isFixed(fixedDelays, gate)) delays[gate] = levelDelays[i];
+            slews[looked[i]] = levelSlews[i];
+        }
+    }
+}
+
+void DelayCalculator::update(const TimingGraph& graph, const vector<NodeId>& loadChanged,
+                             const vector<NodeId>& recompute, vector<double>& loads, vector<double>& slews,
+                             vector<pair<GateId, double>>& changedGates, const vector<char>* fixedDelays) {
+    // Lowest level first, like TimingAnalyzer::retimeArrivals; a node is
+    // looked up again when its load or an input slew changed
+    using Entry = pair<int, NodeId>;
+    priority_queue<Entry, vector<Entry>, greater<Entry>> pending;
+    vector<char> queued(graph.getNodeCount(), 0);
+    auto push = [&](NodeId node) {
+        if (node == INVALID_ID || queued[node] || graph.getLevel(node) < 0) return;
+        queued[node] = 1;
+        pending.push({graph.getLevel(node), node});
+    };
+    for (const vector<NodeId>* seeds : {&loadChanged, &recompute}) {
+        for (NodeId node : *seeds) {
+            if (node == INVALID_ID) continue;
+            loads[node] = nodeLoad(graph, node);
+            push(node);
+        }
+    }
+
+    while (!pending.empty()) {
+        NodeId node = pending.top().second;
+        pending.pop();
+        GateId gate;
+        double slew;
+        if (prepare(graph, node, slews, gate, slew)) {
+            Request request = {graph.getGateType(gate), slew, loads[node]};
+            double delay;
+            interpolate(&request, 1, &delay, &slew);
+            if (delay != graph.getDelay(gate) && !isFixed(fixedDelays, gate)) {
+                changedGates.push_back({gate, delay});
+            }
+        }
+        if (slew == slews[node]) continue;
+        slews[node] = slew;
+        for (const GateId* g = graph.fanoutBegin(node); g != graph.fanoutEnd(node); ++g) {
+            NodeId output = graph.getOutput(*g);
+            if (graph.getDriver(output) != *g || graph.isRegister(*g)) continue;
+            push(output);
+        }
+    }
+}
+
+#endif // DELAY_TABLE_H
@@ -3,37 +3,55 @@
 
 #include <algorithm>
 #include <iostream>
-#include <map>
-#include <memory>
 #include <string>
+#include <string_view>
 #include <vector>
+#include "Arena.h"
+#include "GateType.h"
+#include "Node.h"
+#include "StringInterner.h"
 using namespace std;
+// Gates are created in their Circuit's arena and refer to the nodes they
+// connect by handle; the input list is an arena array as well.
 class Gate {
 private:
-    string type;
-    string name;
-    vector<string> inputs;
-    string output;
+    GateType type;
+    Symbol name;
+    int inputCount;
+    Node** inputs;
+    Node* output;
     double delay;
-
-    bool checkMinimumInputs(int count) const;
+    const double* arcDelays;    // MACRO gates: one delay per input, in the arena
 
 public:
-    Gate(const string& type,
-         const string& name,
-         const vector<string>& inputs,
-         const string& output,
+    Gate(GateType type,
+         Symbol name,
+         Node** inputs,
+         int inputCount,
+         Node* output,
          double delay = 0.0);
 
     // Getters
-    const string& getType() const { return type; }
-    const string& getName() const { return name; }
-    const vector<string>& getInputs() const { return inputs; }
-    const string& getOutput() const { return output; }
+    const string& getType() const { return getGateTypeName(type); }
+    GateType getGateType() const { return type; }
+    const string& getName() const { return StringInterner::global().text(name); }
+    Symbol getNameSymbol() const { return name; }
+    int getInputCount() const { return inputCount; }
+    Node* getInput(int pin) const { return inputs[pin]; }
+    Node* const* inputsBegin() const { return inputs; }
+    Node* const* inputsEnd() const { return inputs + inputCount; }
+    vector<string> getInputNames() const;
+    Node* getOutputNode() const { return output; }
+    const string& getOutput() const { return output->getName(); }
     double getDelay() const { return delay; }
+    const double* getArcDelays() const { return arcDelays; }
 
     // Setters
     void setDelay(double newDelay) { delay = newDelay; }
+    void setType(const string& newType) { type = parseGateType(newType); }
+    void setType(GateType newType) { type = newType; }
+    void setInput(int pin, Node* node) { inputs[pin] = node; }
+    void setArcDelays(const double* delays) { arcDelays = delays; }
 
     // Behavior helpers
     bool evaluate(const vector<bool>& inputValues) const;
@@ -52,147 +70,104 @@ public:
 
 class GateFactory {
 public:
-    static shared_ptr<Gate> createGate(const string& type,
-                                            const string& name,
-                                            const vector<string>& inputs,
-                                            const string& output);
+    // Reports an unknown type or a wrong input count on cerr
+    static bool isValidGate(string_view type, const string& name, int inputCount);
+    // Creates the gate in the arena, copying the input handles; returns
+    // nullptr (after reporting why) if the gate is not valid
+    static Gate* createGate(Arena& arena,
+                            string_view type,
+                            Symbol name,
+                            Node* const* inputs,
+                            int inputCount,
+                            Node* output);
 };
 
 // ===== Implementation =======================================================
 
-Gate::Gate(const string& typeValue,
-           const string& nameValue,
-           const vector<string>& inputList,
-           const string& outputValue,
+Gate::Gate(GateType typeValue,
+           Symbol nameValue,
+           Node** inputList,
+           int inputCountValue,
+           Node* outputNode,
            double delayValue)
     : type(typeValue),
       name(nameValue),
+      inputCount(inputCountValue),
       inputs(inputList),
-      output(outputValue),
-      delay(delayValue) {
+      output(outputNode),
+      delay(delayValue),
+      arcDelays(nullptr) {
 }
 
-bool Gate::checkMinimumInputs(int count) const {
-    return count >= 2;
+vector<string> Gate::getInputNames() const {
+    vector<string> names;
+    names.reserve(inputCount);
+    for (int pin = 0; pin < inputCount; ++pin) {
+        names.push_back(inputs[pin]->getName());
+    }
+    return names;
 }
 
 bool Gate::evaluate(const vector<bool>& inputValues) const {
-    if (type == "AND") {
-        if (!checkMinimumInputs(static_cast<int>(inputValues.size()))) return false;
+    if (!isValidInputCount(static_cast<int>(inputValues.size()))) return false;
+
+    switch (type) {
+    case GateType::AND:
+    case GateType::NAND: {
         bool result = true;
         for (auto value : inputValues) {
             result = result && value;
         }
-        return result;
+        return type == GateType::AND ? result : !result;
     }
 
-    if (type == "OR") {
-        if (!checkMinimumInputs(static_cast<int>(inputValues.size()))) return false;
+    case GateType::OR:
+    case GateType::NOR: {
         bool result = false;
         for (auto value : inputValues) {
             result = result || value;
         }
-        return result;
+        return type == GateType::OR ? result : !result;
     }
 
-    if (type == "XOR") {
-        if (inputValues.size() != 2) return false;
+    case GateType::XOR:
+    case GateType::HALF_ADDER:
         return inputValues[0] != inputValues[1];
-    }
-
-    if (type == "NAND") {
-        if (!checkMinimumInputs(static_cast<int>(inputValues.size()))) return false;
-        bool result = true;
-        for (auto value : inputValues) {
-            result = result && value;
-        }
-        return !result;
-    }
 
-    if (type == "NOR") {
-        if (!checkMinimumInputs(static_cast<int>(inputValues.size()))) return false;
-        bool result = false;
-        for (auto value : inputValues) {
-            result = result || value;
-        }
-        return !result;
-    }
-
-    if (type == "XNOR") {
-        if (inputValues.size() != 2) return false;
+    case GateType::XNOR:
         return inputValues[0] == inputValues[1];
-    }
 
-    if (type == "NOT") {
-        if (inputValues.size() != 1) return false;
+    case GateType::NOT:
         return !inputValues[0];
-    }
 
-    if (type == "HALF_ADDER") {
-        if (inputValues.size() != 2) return false;
-        return inputValues[0] != inputValues[1];
-    }
-
-    if (type == "FULL_ADDER") {
-        if (inputValues.size() != 3) return false;
-        bool result = inputValues[0];
-        for (size_t i = 1; i < inputValues.size(); ++i) {
-            result = result != inputValues[i];
-        }
-        return result;
-    }
+    case GateType::FULL_ADDER:
+        return (inputValues[0] != inputValues[1]) != inputValues[2];
 
-    if (type == "MUX2TO1") {
-        if (inputValues.size() != 3) return false;
+    case GateType::MUX2TO1:
         return inputValues[2] ? inputValues[1] : inputValues[0];
-    }
 
-    if (type == "MUX_SWITCH") {
-        if (inputValues.size() != 2) return false;
+    case GateType::MUX_SWITCH:
         return inputValues[1] ? inputValues[0] : false;
-    }
 
-    return false;
+    case GateType::DFF:
+        return inputValues[0];      // Next state
+
+    default:
+        return false;
+    }
 }
 
 string Gate::getTruthTable() const {
-    if (type == "AND") return "AND: 0&0=0, 0&1=0, 1&0=0, 1&1=1";
-    if (type == "OR") return "OR: 0|0=0, 0|1=1, 1|0=1, 1|1=1";
-    if (type == "XOR") return "XOR: 0^0=0, 0^1=1, 1^0=1, 1^1=0";
-    if (type == "NAND") return "NAND: !(0&0)=1, !(0&1)=1, !(1&0)=1, !(1&1)=0";
-    if (type == "NOR") return "NOR: !(0|0)=1, !(0|1)=0, !(1|0)=0, !(1|1)=0";
-    if (type == "XNOR") return "XNOR: 0==0=1, 0==1=0, 1==0=0, 1==1=1";
-    if (type == "NOT") return "NOT: !0=1, !1=0";
-    if (type == "HALF_ADDER") return "HALF_ADDER: A,B -> Sum,Carry";
-    if (type == "FULL_ADDER") return "FULL_ADDER: A,B,Cin -> Sum,Carry";
-    if (type == "MUX2TO1") return "MUX2TO1: S=0->D0, S=1->D1";
-    if (type == "MUX_SWITCH") return "MUX_SWITCH: S=0->0, S=1->D";
-    return "UNKNOWN";
+    return getGateTraits(type).truthTable;
 }
 
 int Gate::getExpectedInputCount() const {
-    if (type == "NOT") return 1;
-    if (type == "HALF_ADDER") return 2;
-    if (type == "FULL_ADDER") return 3;
-    if (type == "MUX2TO1") return 3;
-    if (type == "MUX_SWITCH") return 2;
-    if (type == "XOR") return 2;
-    if (type == "XNOR") return 2;
-    return 2;
+    return getGateTraits(type).expectedInputs;
 }
 
 bool Gate::isValidInputCount(int count) const {
-    if (type == "AND") return count >= 2;
-    if (type == "OR") return count >= 2;
-    if (type == "NAND") return count >= 2;
-    if (type == "NOR") return count >= 2;
-    if (type == "XOR" || type == "XNOR") return count == 2;
-    if (type == "NOT") return count == 1;
-    if (type == "HALF_ADDER") return count == 2;
-    if (type == "FULL_ADDER") return count == 3;
-    if (type == "MUX2TO1") return count == 3;
-    if (type == "MUX_SWITCH") return count == 2;
-    return true;
+    const GateTypeTraits& traits = getGateTraits(type);
+    return count >= traits.minInputs && (traits.maxInputs < 0 || count <= traits.maxInputs);
 }
 
 double Gate::calculateDelay(const vector<double>& inputArrivalTimes) const {
@@ -208,40 +183,53 @@ double Gate::calculateSlew(const vector<double>& inputSlews) const {
 }
 
 double Gate::calculateCapacitance() const {
-    return 1.0 + static_cast<double>(inputs.size()) * 0.5;
+    return 1.0 + static_cast<double>(inputCount) * 0.5;
 }
 
 void Gate::printGate() const {
-    cout << type << " " << name << " (";
-    for (size_t i = 0; i < inputs.size(); ++i) {
-        cout << inputs[i];
-        if (i < inputs.size() - 1) {
+    cout << getType() << " " << getName() << " (";
+    for (int i = 0; i < inputCount; ++i) {
+        cout << inputs[i]->getName();
+        if (i < inputCount - 1) {
             cout << ", ";
         }
     }
-    cout << ") -> " << output << " [delay: " << delay << " ns]" << endl;
+    cout << ") -> " << getOutput() << " [delay: " << delay << " ns]" << endl;
 }
 
-shared_ptr<Gate> GateFactory::createGate(const string& type,
-                                              const string& name,
-                                              const vector<string>& inputs,
-                                              const string& output) {
-    static const vector<string> knownTypes = {
-        "AND", "OR", "XOR", "NAND", "NOR", "XNOR",
-        "NOT", "HALF_ADDER", "FULL_ADDER", "MUX2TO1", "MUX_SWITCH"
-    };
-
-    if (find(knownTypes.begin(), knownTypes.end(), type) == knownTypes.end()) {
+bool GateFactory::isValidGate(string_view type, const string& name, int inputCount) {
+    GateType gateType = parseGateType(type);
+    if (gateType == GateType::UNKNOWN) {
         cerr << "Unknown gate type: " << type << endl;
-        return nullptr;
+        return false;
     }
-
-    auto gate = make_shared<Gate>(type, name, inputs, output);
-    if (!gate->isValidInputCount(static_cast<int>(inputs.size()))) {
+    if (gateType == GateType::MACRO) {
+        // Macro outputs need their arc delays and come from INSTANCE lines
+        cerr << "Gate " << name << ": MACRO gates are created by INSTANCE lines" << endl;
+        return false;
+    }
+    
+    const GateTypeTraits& traits = getGateTraits(gateType);
+    if (inputCount < traits.minInputs || (traits.maxInputs >= 0 && inputCount > traits.maxInputs)) {
         cerr << "Invalid input count for gate " << name << " of type " << type << endl;
+        return false;
+    }
+    return true;
+}
+
+Gate* GateFactory::createGate(Arena& arena,
+                              string_view type,
+                              Symbol name,
+                              Node* const* inputs,
+                              int inputCount,
+                              Node* output) {
+    if (!isValidGate(type, StringInterner::global().text(name), inputCount)) {
         return nullptr;
     }
-    return gate;
+    
+    Node** inputList = arena.allocateArray<Node*>(inputCount);
+    copy(inputs, inputs + inputCount, inputList);
+    return arena.create<Gate>(parseGateType(type), name, inputList, inputCount, output);
 }
 
 #endif // GATE_H
@@ -0,0 +1,76 @@
+#ifndef GATE_TYPE_H
+#define GATE_TYPE_H
+
+#include <cstdint>
+#include <string>
+#include <string_view>
+using namespace std;
+
+// Every gate kind GateFactory accepts. UNKNOWN stands for any other name and
+// always comes last, so the known types index the traits and delay tables.
+enum class GateType : uint8_t {
+    AND, OR, XOR, NAND, NOR, XNOR, NOT,
+    HALF_ADDER, FULL_ADDER, MUX2TO1, MUX_SWITCH,
+    MACRO,          // One output of an extracted timing model (see TimingModel.h)
+    DFF,            // Edge-triggered register; its delay is clock-to-Q
+    UNKNOWN
+};
+
+const int GATE_TYPE_COUNT = static_cast<int>(GateType::UNKNOWN) + 1;
+
+struct GateTypeTraits {
+    const char* name;
+    int minInputs;
+    int maxInputs;              // -1 for no upper bound
+    int expectedInputs;
+    const char* truthTable;
+};
+
+// Indexed by GateType
+constexpr GateTypeTraits GATE_TYPE_TRAITS[GATE_TYPE_COUNT] = {
+    {"AND",        2, -1, 2, "AND: 0&0=0, 0&1=0, 1&0=0, 1&1=1"},
+    {"OR",         2, -1, 2, "OR: 0|0=0, 0|1=1, 1|0=1, 1|1=1"},
+    {"XOR",        2,  2, 2, "XOR: 0^0=0, 0^1=1, 1^0=1, 1^1=0"},
+    {"NAND",       2, -1, 2, "NAND: !(0&0)=1, !(0&1)=1, !(1&0)=1, !(1&1)=0"},
+    {"NOR",        2, -1, 2, "NOR: !(0|0)=1, !(0|1)=0, !(1|0)=0, !(1|1)=0"},
+    {"XNOR",       2,  2, 2, "XNOR: 0==0=1, 0==1=0, 1==0=0, 1==1=1"},
+    {"NOT",        1,  1, 1, "NOT: !0=1, !1=0"},
+    {"HALF_ADDER", 2,  2, 2, "HALF_ADDER: A,B -> Sum,Carry"},
+    {"FULL_ADDER", 3,  3, 3, "FULL_ADDER: A,B,Cin -> Sum,Carry"},
+    {"MUX2TO1",    3,  3, 3, "MUX2TO1: S=0->D0, S=1->D1"},
+    {"MUX_SWITCH", 2,  2, 2, "MUX_SWITCH: S=0->0, S=1->D"},
+    {"MACRO",      1, -1, 1, "MACRO: timing model only, no logic function"},
+    {"DFF",        1,  1, 1, "DFF: Q takes D at each clock edge"},
+    {"UNKNOWN",    0, -1, 2, "UNKNOWN"}
+};
+
+inline const GateTypeTraits& getGateTraits(GateType type) {
+    return GATE_TYPE_TRAITS[static_cast<int>(type)];
+}
+
+// Name <-> enum conversion; meant for the I/O boundary, not for hot loops
+GateType parseGateType(string_view name);
+const string& getGateTypeName(GateType type);
+
+// ===== Implementation =======================================================
+
+GateType parseGateType(string_view name) {
+    for (int type = 0; type < GATE_TYPE_COUNT - 1; ++type) {
+        if (name == GATE_TYPE_TRAITS[type].name) return static_cast<GateType>(type);
+    }
+    return GateType::UNKNOWN;
+}
+
+const string& getGateTypeName(GateType type) {
+    // Owned strings so callers can keep handing out const string&
+    static const string names[GATE_TYPE_COUNT] = {
+        GATE_TYPE_TRAITS[0].name, GATE_TYPE_TRAITS[1].name, GATE_TYPE_TRAITS[2].name,
+        GATE_TYPE_TRAITS[3].name, GATE_TYPE_TRAITS[4].name, GATE_TYPE_TRAITS[5].name,
+        GATE_TYPE_TRAITS[6].name, GATE_TYPE_TRAITS[7].name, GATE_TYPE_TRAITS[8].name,
+        GATE_TYPE_TRAITS[9].name, GATE_TYPE_TRAITS[10].name, GATE_TYPE_TRAITS[11].name,
+        GATE_TYPE_TRAITS[12].name, GATE_TYPE_TRAITS[13].name
+    };
+    return names[static_cast<int>(type)];
+}
+
+#endif // GATE_TYPE_H
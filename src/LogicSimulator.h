@@ -0,0 +1,253 @@
+#ifndef LOGIC_SIMULATOR_H
+#define LOGIC_SIMULATOR_H
+
+#include <cstdint>
+#include <functional>
+#include <stdexcept>
+#include <string>
+#include <vector>
+#include "TimingGraph.h"
+
+using namespace std;
+
+using PatternWord = uint64_t;
+
+// Bit-parallel zero-delay logic simulation over a compiled TimingGraph. Each
+// node holds a block of words and bit b of word w is the node's value under
+// pattern w * 64 + b, so one pass over the gates in topological order applies
+// blockWords * 64 patterns. The per-word loops are plain bitwise operations
+// the compiler turns into SIMD code.
+//
+// Gate functions match Gate::evaluate: HALF_ADDER and FULL_ADDER drive their
+// sum (XOR of the inputs), MUX2TO1 selects D1 when S is set (inputs D0 D1 S)
+// and MUX_SWITCH passes D while S is set (inputs D S). Undriven nodes that
+// are not primary inputs, and nodes on a combinational cycle, read as 0.
+class LogicSimulator {
+public:
+    // Called once per simulated block. patternCount is how many of the block's
+    // patterns are valid, starting at pattern number firstPattern.
+    using BlockVisitor = function<void(const LogicSimulator&, long long firstPattern, int patternCount)>;
+
+    static const int MAX_EXHAUSTIVE_INPUTS = 40;
+
+private:
+    enum Operation : uint8_t {
+        OP_AND, OP_OR, OP_NAND, OP_NOR, OP_XOR, OP_XNOR, OP_NOT,
+        OP_MUX2TO1, OP_MUX_SWITCH, OP_CONSTANT_ZERO
+    };
+
+    const TimingGraph& graph;
+    int blockWords;
+    vector<uint8_t> gateOperations;     // Per GateId, resolved once from the GateType
+    vector<int> inputIndex;             // Per NodeId: position in getPrimaryInputs(), or -1
+    vector<PatternWord> values;         // Node-major: values[node * blockWords + w]
+
+    static Operation operationFor(GateType type);
+    void evaluateGate(GateId gate, PatternWord* out) const;
+
+public:
+    explicit LogicSimulator(const TimingGraph& graph, int blockWords = 4);
+
+    int getBlockWords() const { return blockWords; }
+    int getPatternsPerBlock() const { return blockWords * 64; }
+    int getInputCount() const { return static_cast<int>(graph.getPrimaryInputs().size()); }
+
+    // Simulates one block. stimulus holds blockWords words per primary input,
+    // in getPrimaryInputs() order.
+    void simulate(const vector<PatternWord>& stimulus);
+
+    // Results of the last simulate() call
+    const PatternWord* nodeWords(NodeId node) const { return values.data() + static_cast<size_t>(node) * blockWords; }
+    bool getValue(NodeId node, int pattern) const {
+        return (nodeWords(node)[pattern >> 6] >> (pattern & 63)) & 1;
+    }
+
+    // Drivers. Exhaustive enumerates all 2^inputs patterns, with primary input
+    // i taking bit i of the pattern number; random applies patternCount
+    // uniformly random patterns from a seeded generator.
+    void runExhaustive(const BlockVisitor& visit);
+    void runRandom(long long patternCount, uint64_t seed, const BlockVisitor& visit);
+};
+
+// ===== Implementation =======================================================
+
+LogicSimulator::LogicSimulator(const TimingGraph& graphValue, int blockWordCount)
+    : graph(graphValue), blockWords(max(1, blockWordCount)) {
+    gateOperations.resize(graph.getGateCount());
+    for (GateId gate = 0; gate < graph.getGateCount(); ++gate) {
+        // A timing model keeps delays only, so there is nothing to evaluate
+        if (graph.getGateType(gate) == GateType::MACRO && !graph.isRemoved(gate)) {
+            throw runtime_error("Cannot simulate " + graph.getGateName(gate) +
+                                ": timing model instances have no logic function");
+        }
+        // Patterns are evaluated combinationally, with no state between them
+        if (graph.isRegister(gate) && !graph.isRemoved(gate)) {
+            throw runtime_error("Cannot simulate " + graph.getGateName(gate) +
+                                ": registers need sequential simulation");
+        }
+        gateOperations[gate] = operationFor(graph.getGateType(gate));
+    }
+
+    inputIndex.assign(graph.getNodeCount(), -1);
+    const vector<NodeId>& inputs = graph.getPrimaryInputs();
+    for (size_t i = 0; i < inputs.size(); ++i) {
+        inputIndex[inputs[i]] = static_cast<int>(i);
+    }
+}
+
+LogicSimulator::Operation LogicSimulator::operationFor(GateType type) {
+    switch (type) {
+    case GateType::AND: return OP_AND;
+    case GateType::OR: return OP_OR;
+    case GateType::NAND: return OP_NAND;
+    case GateType::NOR: return OP_NOR;
+    case GateType::XOR:
+    case GateType::HALF_ADDER:
+    case GateType::FULL_ADDER: return OP_XOR;
+    case GateType::XNOR: return OP_XNOR;
+    case GateType::NOT: return OP_NOT;
+    case GateType::MUX2TO1: return OP_MUX2TO1;
+    case GateType::MUX_SWITCH: return OP_MUX_SWITCH;
+    default: return OP_CONSTANT_ZERO;
+    }
+}
+
+void LogicSimulator::evaluateGate(GateId gate, PatternWord* out) const {
+    const NodeId* in = graph.faninBegin(gate);
+    int inputCount = graph.getFaninCount(gate);
+    auto word = [&](int pin) { return nodeWords(in[pin]); };
+
+    switch (gateOperations[gate]) {
+    case OP_AND:
+    case OP_NAND: {
+        const PatternWord* first = word(0);
+        for (int w = 0; w < blockWords; ++w) out[w] = first[w];
+        for (int pin = 1; pin < inputCount; ++pin) {
+            const PatternWord* next = word(pin);
+            for (int w = 0; w < blockWords; ++w) out[w] &= next[w];
+        }
+        if (gateOperations[gate] == OP_NAND) {
+            for (int w = 0; w < blockWords; ++w) out[w] = ~out[w];
+        }
+        break;
+    }
+    case OP_OR:
+    case OP_NOR: {
+        const PatternWord* first = word(0);
+        for (int w = 0; w < blockWords; ++w) out[w] = first[w];
+        for (int pin = 1; pin < inputCount; ++pin) {
+            const PatternWord* next = word(pin);
+            for (int w = 0; w < blockWords; ++w) out[w] |= next[w];
+        }
+        if (gateOperations[gate] == OP_NOR) {
+            for (int w = 0; w < blockWords; ++w) out[w] = ~out[w];
+        }
+        break;
+    }
+    case OP_XOR:
+    case OP_XNOR: {
+        const PatternWord* first = word(0);
+        for (int w = 0; w < blockWords; ++w) out[w] = first[w];
+        for (int pin = 1; pin < inputCount; ++pin) {
+            const PatternWord* next = word(pin);
+            for (int w = 0; w < blockWords; ++w) out[w] ^= next[w];
+        }
+        if (gateOperations[gate] == OP_XNOR) {
+            for (int w = 0; w < blockWords; ++w) out[w] = ~out[w];
+        }
+        break;
+    }
+    case OP_NOT: {
+        const PatternWord* a = word(0);
+        for (int w = 0; w < blockWords; ++w) out[w] = ~a[w];
+        break;
+    }
+    case OP_MUX2TO1: {
+        const PatternWord* d0 = word(0);
+        const PatternWord* d1 = word(1);
+        const PatternWord* select = word(2);
+        for (int w = 0; w < blockWords; ++w) out[w] = (d1[w] & select[w]) | (d0[w] & ~select[w]);
+        break;
+    }
+    case OP_MUX_SWITCH: {
+        const PatternWord* d = word(0);
+        const PatternWord* select = word(1);
+        for (int w = 0; w < blockWords; ++w) out[w] = d[w] & select[w];
+        break;
+    }
+    default:
+        for (int w = 0; w < blockWords; ++w) out[w] = 0;
+        break;
+    }
+}
+
+void LogicSimulator::simulate(const vector<PatternWord>& stimulus) {
+    if (stimulus.size() != static_cast<size_t>(getInputCount()) * blockWords) {
+        throw runtime_error("Simulation stimulus must hold " + to_string(blockWords) +
+                            " words per primary input");
+    }
+
+    // Nodes outside the topological order (cycles) keep reading as 0
+    values.assign(static_cast<size_t>(graph.getNodeCount()) * blockWords, 0);
+    for (NodeId node : graph.getTopologicalOrder()) {
+        PatternWord* out = values.data() + static_cast<size_t>(node) * blockWords;
+        GateId driver = graph.getDriver(node);
+        if (driver != INVALID_ID) {
+            evaluateGate(driver, out);
+        } else if (inputIndex[node] >= 0) {
+            const PatternWord* source = stimulus.data() + static_cast<size_t>(inputIndex[node]) * blockWords;
+            for (int w = 0; w < blockWords; ++w) out[w] = source[w];
+        }
+    }
+}
+
+void LogicSimulator::runExhaustive(const BlockVisitor& visit) {
+    int inputCount = getInputCount();
+    if (inputCount > MAX_EXHAUSTIVE_INPUTS) {
+        throw runtime_error("Exhaustive simulation supports at most " +
+                            to_string(MAX_EXHAUSTIVE_INPUTS) + " primary inputs");
+    }
+
+    // Within a 64-pattern word, inputs 0-5 follow fixed bit masks; higher
+    // inputs are constant across the word and taken from the word's number
+    static const PatternWord lowInputMasks[6] = {
+        0xAAAAAAAAAAAAAAAAULL, 0xCCCCCCCCCCCCCCCCULL, 0xF0F0F0F0F0F0F0F0ULL,
+        0xFF00FF00FF00FF00ULL, 0xFFFF0000FFFF0000ULL, 0xFFFFFFFF00000000ULL
+    };
+
+    long long totalPatterns = 1LL << inputCount;
+    long long blockPatterns = getPatternsPerBlock();
+    vector<PatternWord> stimulus(static_cast<size_t>(inputCount) * blockWords);
+    for (long long first = 0; first < totalPatterns; first += blockPatterns) {
+        for (int i = 0; i < inputCount; ++i) {
+            for (int w = 0; w < blockWords; ++w) {
+                long long wordStart = first + 64LL * w;
+                stimulus[static_cast<size_t>(i) * blockWords + w] =
+                    i < 6 ? lowInputMasks[i] : (((wordStart >> i) & 1) ? ~0ULL : 0ULL);
+            }
+        }
+        simulate(stimulus);
+        visit(*this, first, static_cast<int>(min(blockPatterns, totalPatterns - first)));
+    }
+}
+
+void LogicSimulator::runRandom(long long patternCount, uint64_t seed, const BlockVisitor& visit) {
+    // splitmix64: fast, seedable and good enough for stimulus
+    uint64_t state = seed;
+    auto next = [&state]() {
+        uint64_t z = (state += 0x9E3779B97F4A7C15ULL);
+        z = (z ^ (z >> 30)) * 0xBF58476D1CE4E5B9ULL;
+        z = (z ^ (z >> 27)) * 0x94D049BB133111EBULL;
+        return z ^ (z >> 31);
+    };
+
+    long long blockPatterns = getPatternsPerBlock();
+    vector<PatternWord> stimulus(static_cast<size_t>(getInputCount()) * blockWords);
+    for (long long first = 0; first < patternCount; first += blockPatterns) {
+        for (auto& word : stimulus) word = next();
+        simulate(stimulus);
+        visit(*this, first, static_cast<int>(min(blockPatterns, patternCount - first)));
+    }
+}
+
+#endif // LOGIC_SIMULATOR_H
@@ -0,0 +1,386 @@
+#ifndef MONTE_CARLO_H
+#define MONTE_CARLO_H
+
+#include <algorithm>
+#include <cmath>
+#include <cstdint>
+#include <limits>
+#include <memory>
+#include <mutex>
+#include <stdexcept>
+#include <vector>
+#include "SimdDouble.h"
+#include "ThreadPool.h"
+#include "TimingGraph.h"
+
+using namespace std;
+
+// Slack distribution of one endpoint over all samples
+struct EndpointStatistics {
+    NodeId node;
+    double meanSlack;
+    double sigmaSlack;
+    double minSlack;
+    double maxSlack;
+    double yield;           // Fraction of samples with slack >= 0
+};
+
+struct MonteCarloResult {
+    int sampleCount = 0;
+    uint64_t seed = 0;
+    vector<EndpointStatistics> endpoints;   // In TimingGraph::getEndpoints() order
+    vector<double> worstSlack;              // Per sample: lowest endpoint slack
+    vector<double> totalDelay;              // Per sample: latest driven endpoint arrival
+    double yield = 0.0;                     // Fraction of samples where every endpoint passes
+
+    // Value below which `fraction` of the samples fall (nearest rank)
+    static double percentile(vector<double> samples, double fraction);
+};
+
+// Statistical timing by Monte Carlo sampling over a compiled TimingGraph.
+// Every gate delay is drawn independently per sample from a normal
+// distribution around the gate's bound delay, with the standard deviation
+// given for its type (negative draws are clamped to 0); types without a sigma
+// stay fixed. Endpoint slack is the endpoint's required time (the clock
+// period, less the setup time at register data inputs) minus its arrival;
+// register outputs launch at a sampled clock-to-Q.
+//
+// Samples are propagated BATCH_SIZE at a time: each node holds one arrival per
+// sample of the batch, so a gate is timed for the whole batch with SIMD
+// max/add operations. Batches run in parallel on the pool when every worker
+// can have its own arrival array within SCRATCH_BUDGET_BYTES; larger graphs
+// run one batch at a time with each level split across the pool instead.
+//
+// Delay draws come from a counter-based generator keyed by (seed, gate,
+// sample), and batch statistics are merged in batch order, so results depend
+// only on the seed and sample count, not on the thread count.
+class MonteCarloAnalyzer {
+public:
+    static const int BATCH_SIZE = 16;
+    static const size_t SCRATCH_BUDGET_BYTES = size_t(256) << 20;
+
+    MonteCarloAnalyzer(const TimingGraph& graph, const vector<double>& typeSigmas, double clockPeriod,
+                       double setupTime);
+
+    MonteCarloResult run(int sampleCount, uint64_t seed, ThreadPool* pool);
+
+private:
+    // Running sums of one endpoint over a batch
+    struct EndpointPartial {
+        double sum;
+        double sumSquares;
+        double minSlack;
+        double maxSlack;
+        long long passCount;
+    };
+
+    static const int NORMAL_TABLE_BITS = 16;
+
+    const TimingGraph& graph;
+    vector<double> typeSigmas;          // One per GateType, 0 where none was given
+    double clockPeriod;
+    double setupTime;
+    uint64_t seedKey;
+    vector<NodeId> endpoints;
+    vector<double> endpointRequired;
+
+    // Free arrival arrays, one in use per concurrently running batch
+    mutex scratchLock;
+    vector<unique_ptr<vector<double>>> freeScratch;
+
+    static const vector<double>& normalTable();
+    static double inverseNormal(double p);
+    static uint64_t mix(uint64_t value);
+
+    unique_ptr<vector<double>> acquireScratch();
+    void releaseScratch(unique_ptr<vector<double>> scratch);
+
+    void addDelayDraws(double* out, GateId gate, double mean, double sigma, long long firstSample) const;
+    void launchRegisters(double* arrival, long long firstSample) const;
+    void timeNodes(double* arrival, const NodeId* nodes, int begin, int end, long long firstSample) const;
+    void runBatch(double* arrival, long long batch, ThreadPool* levelPool) const;
+    void collectBatch(const double* arrival, long long batch, int sampleCount,
+                      EndpointPartial* partials, MonteCarloResult& result) const;
+};
+
+// ===== Implementation =======================================================
+
+double MonteCarloResult::percentile(vector<double> samples, double fraction) {
+    if (samples.empty()) return 0.0;
+    size_t rank = static_cast<size_t>(fraction * (samples.size() - 1) + 0.5);
+    rank = min(rank, samples.size() - 1);
+    nth_element(samples.begin(), samples.begin() + rank, samples.end());
+    return samples[rank];
+}
+
+MonteCarloAnalyzer::MonteCarloAnalyzer(const TimingGraph& graphValue, const vector<double>& sigmas,
+                                       double period, double setup)
+    : graph(graphValue), typeSigmas(sigmas), clockPeriod(period), setupTime(setup), seedKey(0) {
+    // Types past the end of a short sigma list stay fixed
+    typeSigmas.resize(GATE_TYPE_COUNT, 0.0);
+}
+
+double MonteCarloAnalyzer::inverseNormal(double p) {
+    // Acklam's rational approximation, relative error below 1.2e-9
+    static const double a[] = {-3.969683028665376e+01, 2.209460984245205e+02, -2.759285104469687e+02,
+                               1.383577518672690e+02, -3.066479806614716e+01, 2.506628277459239e+00};
+    static const double b[] = {-5.447609879822406e+01, 1.615858368580409e+02, -1.556989798598866e+02,
+                               6.680131188771972e+01, -1.328068155288572e+01};
+    static const double c[] = {-7.784894002430293e-03, -3.223964580411365e-01, -2.400758277161838e+00,
+                               -2.549671010243105e+00, 4.374664141464968e+00, 2.938163982698783e+00};
+    static const double d[] = {7.784695709041462e-03, 3.224671290700398e-01, 2.445134137142996e+00,
+                               3.754408661907416e+00};
+    const double low = 0.02425;
+    if (p < low || p > 1.0 - low) {
+        double q = sqrt(-2.0 * log(p < low ? p : 1.0 - p));
+        double x = (((((c[0] * q + c[1]) * q + c[2]) * q + c[3]) * q + c[4]) * q + c[5]) /
+                   ((((d[0] * q + d[1]) * q + d[2]) * q + d[3]) * q + 1.0);
+        return p < low ? x : -x;
+    }
+    double q = p - 0.5;
+    double r = q * q;
+    return (((((a[0] * r + a[1]) * r + a[2]) * r + a[3]) * r + a[4]) * r + a[5]) * q /
+           (((((b[0] * r + b[1]) * r + b[2]) * r + b[3]) * r + b[4]) * r + 1.0);
+}
+
+const vector<double>& MonteCarloAnalyzer::normalTable() {
+    // Standard normal quantiles at 2^16 evenly spaced probabilities, rescaled
+    // to exactly unit variance; a draw is one lookup instead of a log and a
+    // square root. Tails are cut at about 4.3 sigma.
+    static const vector<double> table = [] {
+        size_t size = size_t(1) << NORMAL_TABLE_BITS;
+        vector<double> values(size);
+        double sumSquares = 0.0;
+        for (size_t i = 0; i < size; ++i) {
+            values[i] = inverseNormal((i + 0.5) / size);
+            sumSquares += values[i] * values[i];
+        }
+        double scale = 1.0 / sqrt(sumSquares / size);
+        for (double& value : values) value *= scale;
+        return values;
+    }();
+    return table;
+}
+
+uint64_t MonteCarloAnalyzer::mix(uint64_t value) {
+    // splitmix64 finalizer
+    value = (value ^ (value >> 30)) * 0xBF58476D1CE4E5B9ULL;
+    value = (value ^ (value >> 27)) * 0x94D049BB133111EBULL;
+    return value ^ (value >> 31);
+}
+
+unique_ptr<vector<double>> MonteCarloAnalyzer::acquireScratch() {
+    {
+        lock_guard<mutex> guard(scratchLock);
+        if (!freeScratch.empty()) {
+            unique_ptr<vector<double>> scratch = move(freeScratch.back());
+            freeScratch.pop_back();
+            return scratch;
+        }
+    }
+    // Undriven nodes and nodes on cycles are never written and stay at 0
+    return make_unique<vector<double>>(static_cast<size_t>(graph.getNodeCount()) * BATCH_SIZE, 0.0);
+}
+
+void MonteCarloAnalyzer::releaseScratch(unique_ptr<vector<double>> scratch) {
+    lock_guard<mutex> guard(scratchLock);
+    freeScratch.push_back(move(scratch));
+}
+
+void MonteCarloAnalyzer::addDelayDraws(double* out, GateId gate, double mean, double sigma,
+                                       long long firstSample) const {
+    // One 64-bit draw gives the table indices of four samples
+    const vector<double>& normal = normalTable();
+    const uint64_t indexMask = (uint64_t(1) << NORMAL_TABLE_BITS) - 1;
+    for (int group = 0; group < BATCH_SIZE / 4; ++group) {
+        uint64_t key = (static_cast<uint64_t>(gate) << 32) |
+                       static_cast<uint64_t>(firstSample / 4 + group);
+        uint64_t bits = mix(key ^ seedKey);
+        for (int k = 0; k < 4; ++k) {
+            double delay = mean + sigma * normal[(bits >> (16 * k)) & indexMask];
+            out[group * 4 + k] += max(delay, 0.0);
+        }
+    }
+}
+
+void MonteCarloAnalyzer::launchRegisters(double* arrival, long long firstSample) const {
+    double sigma = typeSigmas[static_cast<int>(GateType::DFF)];
+    for (GateId reg : graph.getRegisters()) {
+        NodeId output = graph.getOutput(reg);
+        if (graph.getDriver(output) != reg) continue;
+        double* out = arrival + static_cast<size_t>(output) * BATCH_SIZE;
+        double mean = graph.getDelay(reg);
+        fill(out, out + BATCH_SIZE, sigma == 0.0 ? mean : 0.0);
+        if (sigma != 0.0) addDelayDraws(out, reg, mean, sigma, firstSample);
+    }
+}
+
+void MonteCarloAnalyzer::timeNodes(double* arrival, const NodeId* nodes, int begin, int end,
+                                   long long firstSample) const {
+    static_assert(BATCH_SIZE % 4 == 0 && BATCH_SIZE % SIMD_WIDTH == 0,
+                  "a batch is whole SIMD vectors and whole groups of four draws");
+    for (int i = begin; i < end; ++i) {
+        NodeId node = nodes[i];
+        GateId driver = graph.getDriver(node);
+        const NodeId* in = graph.faninBegin(driver);
+        const NodeId* inEnd = graph.faninEnd(driver);
+        double* out = arrival + static_cast<size_t>(node) * BATCH_SIZE;
+
+        double mean = graph.getDelay(driver);
+        double sigma = typeSigmas[static_cast<int>(graph.getGateType(driver))];
+        SimdDouble meanVector = simdBroadcast(mean);
+        if (graph.hasArcDelays(driver)) {
+            // Timing model arcs do not vary; only the gate's own delay does
+            const double* arc = graph.arcDelaysBegin(driver);
+            for (int lane = 0; lane < BATCH_SIZE; ++lane) {
+                double latest = -numeric_limits<double>::infinity();
+                for (int pin = 0; in + pin != inEnd; ++pin) {
+                    latest = max(latest, arrival[static_cast<size_t>(in[pin]) * BATCH_SIZE + lane] + arc[pin]);
+                }
+                out[lane] = sigma == 0.0 ? latest + mean : latest;
+            }
+        } else {
+            for (int lane = 0; lane < BATCH_SIZE; lane += SIMD_WIDTH) {
+                const NodeId* pin = in;
+                SimdDouble latest = simdLoad(arrival + static_cast<size_t>(*pin) * BATCH_SIZE + lane);
+                for (++pin; pin != inEnd; ++pin) {
+                    latest = simdMax(latest, simdLoad(arrival + static_cast<size_t>(*pin) * BATCH_SIZE + lane));
+                }
+                simdStore(out + lane, sigma == 0.0 ? simdAdd(latest, meanVector) : latest);
+            }
+        }
+        if (sigma != 0.0) addDelayDraws(out, driver, mean, sigma, firstSample);
+    }
+}
+
+void MonteCarloAnalyzer::runBatch(double* arrival, long long batch, ThreadPool* levelPool) const {
+    long long firstSample = batch * BATCH_SIZE;
+    launchRegisters(arrival, firstSample);
+    for (int level = 1; level < graph.getLevelCount(); ++level) {
+        const NodeId* levelNodes = graph.levelBegin(level);
+        auto body = [&](int begin, int end) {
+            timeNodes(arrival, levelNodes, begin, end, firstSample);
+        };
+        if (levelPool) {
+            levelPool->parallelFor(graph.getLevelSize(level), 256, body);
+        } else {
+            body(0, graph.getLevelSize(level));
+        }
+    }
+}
+
+void MonteCarloAnalyzer::collectBatch(const double* arrival, long long batch, int sampleCount,
+                                      EndpointPartial* partials, MonteCarloResult& result) const {
+    long long firstSample = batch * BATCH_SIZE;
+    int valid = static_cast<int>(min<long long>(BATCH_SIZE, sampleCount - firstSample));
+    double worst[BATCH_SIZE];
+    double latest[BATCH_SIZE];
+    fill(worst, worst + BATCH_SIZE, numeric_limits<double>::infinity());
+    fill(latest, latest + BATCH_SIZE, 0.0);
+
+    for (size_t e = 0; e < endpoints.size(); ++e) {
+        NodeId node = endpoints[e];
+        double required = endpointRequired[e];
+        const double* values = arrival + static_cast<size_t>(node) * BATCH_SIZE;
+        bool timed = graph.getDriver(node) != INVALID_ID && graph.getLevel(node) >= 0;
+        EndpointPartial& partial = partials[e];
+        partial = {0.0, 0.0, numeric_limits<double>::infinity(), -numeric_limits<double>::infinity(), 0};
+        for (int s = 0; s < valid; ++s) {
+            double slack = required - values[s];
+            partial.sum += slack;
+            partial.sumSquares += slack * slack;
+            partial.minSlack = min(partial.minSlack, slack);
+            partial.maxSlack = max(partial.maxSlack, slack);
+            if (slack >= 0.0) ++partial.passCount;
+            worst[s] = min(worst[s], slack);
+            if (timed) latest[s] = max(latest[s], values[s]);
+        }
+    }
+    for (int s = 0; s < valid; ++s) {
+        result.worstSlack[firstSample + s] = worst[s];
+        result.totalDelay[firstSample + s] = latest[s];
+    }
+}
+
+MonteCarloResult MonteCarloAnalyzer::run(int sampleCount, uint64_t seed, ThreadPool* pool) {
+    if (sampleCount < 1) {
+        throw runtime_error("Monte Carlo needs at least one sample");
+    }
+    seedKey = mix(seed + 0x9E3779B97F4A7C15ULL);
+
+    MonteCarloResult result;
+    result.sampleCount = sampleCount;
+    result.seed = seed;
+    result.worstSlack.assign(sampleCount, 0.0);
+    result.totalDelay.assign(sampleCount, 0.0);
+
+    endpoints = graph.getEndpoints();
+    endpointRequired.clear();
+    for (NodeId endpoint : endpoints) {
+        endpointRequired.push_back(graph.getEndpointRequired(endpoint, clockPeriod, setupTime));
+    }
+    size_t endpointCount = endpoints.size();
+    long long batchCount = (sampleCount + BATCH_SIZE - 1) / BATCH_SIZE;
+
+    // Batch-parallel when every worker fits its own arrival array in the
+    // budget, otherwise one batch at a time with level-parallel propagation
+    int threads = pool ? pool->getThreadCount() : 1;
+    size_t scratchBytes = static_cast<size_t>(graph.getNodeCount()) * BATCH_SIZE * sizeof(double);
+    bool batchParallel = pool && scratchBytes * threads <= SCRATCH_BUDGET_BYTES;
+    long long waveSize = batchParallel ? 4LL * threads : 1;
+
+    vector<EndpointPartial> partials(static_cast<size_t>(waveSize) * endpointCount);
+    vector<double> sums(endpointCount, 0.0), sumSquares(endpointCount, 0.0);
+    vector<double> minSlacks(endpointCount, numeric_limits<double>::infinity());
+    vector<double> maxSlacks(endpointCount, -numeric_limits<double>::infinity());
+    vector<long long> passCounts(endpointCount, 0);
+
+    for (long long waveStart = 0; waveStart < batchCount; waveStart += waveSize) {
+        int waveBatches = static_cast<int>(min(waveSize, batchCount - waveStart));
+        auto body = [&](int begin, int end) {
+            unique_ptr<vector<double>> scratch = acquireScratch();
+            for (int i = begin; i < end; ++i) {
+                long long batch = waveStart + i;
+                runBatch(scratch->data(), batch, batchParallel ? nullptr : pool);
+                collectBatch(scratch->data(), batch, sampleCount,
+                             partials.data() + static_cast<size_t>(i) * endpointCount, result);
+            }
+            releaseScratch(move(scratch));
+        };
+        if (batchParallel) {
+            pool->parallelFor(waveBatches, 1, body);
+        } else {
+            body(0, waveBatches);
+        }
+
+        // Merge in batch order so sums do not depend on scheduling
+        for (int i = 0; i < waveBatches; ++i) {
+            const EndpointPartial* batchPartials = partials.data() + static_cast<size_t>(i) * endpointCount;
+            for (size_t e = 0; e < endpointCount; ++e) {
+                sums[e] += batchPartials[e].sum;
+                sumSquares[e] += batchPartials[e].sumSquares;
+                minSlacks[e] = min(minSlacks[e], batchPartials[e].minSlack);
+                maxSlacks[e] = max(maxSlacks[e], batchPartials[e].maxSlack);
+                passCounts[e] += batchPartials[e].passCount;
+            }
+        }
+    }
+    {
+        lock_guard<mutex> guard(scratchLock);
+        freeScratch.clear();
+    }
+
+    result.endpoints.reserve(endpointCount);
+    for (size_t e = 0; e < endpointCount; ++e) {
+        double mean = sums[e] / sampleCount;
+        double variance = max(0.0, sumSquares[e] / sampleCount - mean * mean);
+        result.endpoints.push_back({endpoints[e], mean, sqrt(variance), minSlacks[e], maxSlacks[e],
+                                    static_cast<double>(passCounts[e]) / sampleCount});
+    }
+    long long passing = count_if(result.worstSlack.begin(), result.worstSlack.end(),
+                                 [](double slack) { return slack >= 0.0; });
+    result.yield = static_cast<double>(passing) / sampleCount;
+    return result;
+}
+
+#endif // MONTE_CARLO_H
@@ -0,0 +1,401 @@
+#ifndef NETLIST_GENERATOR_H
+#define NETLIST_GENERATOR_H
+
+#include <algorithm>
+#include <charconv>
+#include <cstdint>
+#include <fstream>
+#include <stdexcept>
+#include <string>
+#include <vector>
+#include "GateType.h"
+
+using namespace std;
+
+// Seeded synthetic netlists for scaling experiments, written in the same
+// CLOCK_PERIOD / INPUT / OUTPUT / GATE format the parser reads. Netlists are
+// streamed, so files of 10^8 gates never have to fit in memory.
+//
+//   random      one large random DAG; most inputs come from the last 1024
+//               nodes, the rest from anywhere earlier
+//   adder       64-bit ripple-carry adders
+//   multiplier  16x16 ripple-carry array multipliers
+//   mux         1024-to-1 MUX2TO1 trees
+//   mesh        64-wide, 256-deep meshes where every node feeds two nodes
+//               of the next row, giving exponentially many reconvergent paths
+//   pipeline    the same meshes with a row of DFFs after every 16 rows, so
+//               each unit is 16 register-bounded stages
+//
+// All kinds except random repeat one block ("unit") until the gate target is
+// met; unit k prefixes its names with u<k>_ and declares its own inputs and
+// outputs ahead of its gates.
+class NetlistGenerator {
+public:
+    enum Kind { RANDOM_DAG, ADDER_ARRAY, MULTIPLIER_ARRAY, MUX_TREE, RECONVERGENT_MESH, PIPELINED_MESH };
+
+    static bool parseKind(const string& name, Kind& kind);
+    static const char* getKindName(Kind kind);
+
+    NetlistGenerator(Kind kind, long long targetGates, uint64_t seed);
+
+    // Writes the netlist and returns the number of gates written
+    long long writeFile(const string& filename);
+
+private:
+    // One unit, with nodes numbered locally: inputs first, then gate outputs
+    struct UnitGate {
+        GateType type;
+        int output;
+        vector<int> inputs;
+    };
+    struct Unit {
+        int inputCount = 0;
+        int nodeCount = 0;
+        vector<UnitGate> gates;
+        vector<int> outputs;
+
+        int addInput() { ++inputCount; return nodeCount++; }
+        int addGate(GateType type, vector<int> inputs);
+    };
+
+    // Buffered writer; the standard stream formatting is far too slow here
+    class LineWriter {
+    private:
+        ofstream& out;
+        string buffer;
+    public:
+        explicit LineWriter(ofstream& stream) : out(stream) { buffer.reserve(1 << 20); }
+        ~LineWriter() { flush(); }
+        LineWriter& operator<<(const char* text) { buffer += text; return *this; }
+        LineWriter& operator<<(const string& text) { buffer += text; return *this; }
+        LineWriter& operator<<(char c) { buffer += c; return *this; }
+        LineWriter& operator<<(long long value);
+        void endLine();
+        void flush();
+    };
+
+    Kind kind;
+    long long targetGates;
+    uint64_t rngState;
+
+    uint64_t nextRandom();
+    uint64_t nextBelow(uint64_t bound) { return nextRandom() % bound; }
+    GateType randomGateType(int& inputCount);
+
+    Unit buildAdder(int bits) const;
+    Unit buildMultiplier(int bits) const;
+    Unit buildMuxTree(int selectBits) const;
+    Unit buildMesh(int width, int depth, int stageDepth);
+    static int getUnitDepth(const Unit& unit);
+
+    long long writeRandomDag(LineWriter& out);
+    long long writeUnits(LineWriter& out, const Unit& unit);
+    static void writeUnitName(LineWriter& out, long long unitIndex, const Unit& unit, int node);
+};
+
+// ===== Implementation =======================================================
+
+bool NetlistGenerator::parseKind(const string& name, Kind& kind) {
+    static const Kind kinds[] = {RANDOM_DAG, ADDER_ARRAY, MULTIPLIER_ARRAY, MUX_TREE, RECONVERGENT_MESH,
+                                 PIPELINED_MESH};
+    for (Kind candidate : kinds) {
+        if (name == getKindName(candidate)) {
+            kind = candidate;
+            return true;
+        }
+    }
+    return false;
+}
+
+const char* NetlistGenerator::getKindName(Kind kind) {
+    switch (kind) {
+    case RANDOM_DAG: return "random";
+    case ADDER_ARRAY: return "adder";
+    case MULTIPLIER_ARRAY: return "multiplier";
+    case MUX_TREE: return "mux";
+    case RECONVERGENT_MESH: return "mesh";
+    case PIPELINED_MESH: return "pipeline";
+    }
+    return "unknown";
+}
+
+NetlistGenerator::NetlistGenerator(Kind kindValue, long long targetGateCount, uint64_t seed)
+    : kind(kindValue), targetGates(max(1LL, targetGateCount)), rngState(seed) {
+}
+
+uint64_t NetlistGenerator::nextRandom() {
+    // splitmix64
+    uint64_t z = (rngState += 0x9E3779B97F4A7C15ULL);
+    z = (z ^ (z >> 30)) * 0xBF58476D1CE4E5B9ULL;
+    z = (z ^ (z >> 27)) * 0x94D049BB133111EBULL;
+    return z ^ (z >> 31);
+}
+
+GateType NetlistGenerator::randomGateType(int& inputCount) {
+    // Every factory type, with the plain logic gates weighted up
+    static const GateType types[] = {
+        GateType::AND, GateType::AND, GateType::OR, GateType::OR,
+        GateType::NAND, GateType::NAND, GateType::NOR, GateType::XOR,
+        GateType::XNOR, GateType::NOT, GateType::HALF_ADDER, GateType::FULL_ADDER,
+        GateType::MUX2TO1, GateType::MUX_SWITCH
+    };
+    GateType type = types[nextBelow(sizeof(types) / sizeof(types[0]))];
+    const GateTypeTraits& traits = getGateTraits(type);
+    inputCount = traits.maxInputs < 0 ? traits.minInputs + static_cast<int>(nextBelow(3))
+                                      : traits.expectedInputs;
+    return type;
+}
+
+int NetlistGenerator::Unit::addGate(GateType type, vector<int> inputs) {
+    gates.push_back({type, nodeCount, move(inputs)});
+    return nodeCount++;
+}
+
+NetlistGenerator::Unit NetlistGenerator::buildAdder(int bits) const {
+    Unit unit;
+    vector<int> a(bits), b(bits);
+    for (int i = 0; i < bits; ++i) a[i] = unit.addInput();
+    for (int i = 0; i < bits; ++i) b[i] = unit.addInput();
+    int carry = unit.addInput();
+
+    for (int i = 0; i < bits; ++i) {
+        // FULL_ADDER drives only the sum, so the carry is built from gates
+        unit.outputs.push_back(unit.addGate(GateType::FULL_ADDER, {a[i], b[i], carry}));
+        int propagate = unit.addGate(GateType::XOR, {a[i], b[i]});
+        int generate = unit.addGate(GateType::AND, {a[i], b[i]});
+        int carried = unit.addGate(GateType::AND, {propagate, carry});
+        carry = unit.addGate(GateType::OR, {generate, carried});
+    }
+    unit.outputs.push_back(carry);
+    return unit;
+}
+
+NetlistGenerator::Unit NetlistGenerator::buildMultiplier(int bits) const {
+    Unit unit;
+    vector<int> a(bits), b(bits);
+    for (int i = 0; i < bits; ++i) a[i] = unit.addInput();
+    for (int i = 0; i < bits; ++i) b[i] = unit.addInput();
+
+    // Running sum, one partial-product row added per step with a ripple adder
+    vector<int> sum(2 * bits, -1);
+    for (int i = 0; i < bits; ++i) {
+        sum[i] = unit.addGate(GateType::AND, {a[i], b[0]});
+    }
+    for (int row = 1; row < bits; ++row) {
+        int carry = -1;
+        for (int i = 0; i < bits; ++i) {
+            int position = row + i;
+            int product = unit.addGate(GateType::AND, {a[i], b[row]});
+            int addend = sum[position];
+            if (addend < 0 && carry < 0) {
+                sum[position] = product;
+            } else if (addend < 0 || carry < 0) {
+                int other = addend < 0 ? carry : addend;
+                sum[position] = unit.addGate(GateType::HALF_ADDER, {product, other});
+                carry = unit.addGate(GateType::AND, {product, other});
+            } else {
+                sum[position] = unit.addGate(GateType::FULL_ADDER, {product, addend, carry});
+                int propagate = unit.addGate(GateType::XOR, {product, addend});
+                int generate = unit.addGate(GateType::AND, {product, addend});
+                int carried = unit.addGate(GateType::AND, {propagate, carry});
+                carry = unit.addGate(GateType::OR, {generate, carried});
+            }
+        }
+        sum[row + bits] = carry;
+    }
+    for (int bit : sum) {
+        if (bit >= 0) unit.outputs.push_back(bit);
+    }
+    return unit;
+}
+
+NetlistGenerator::Unit NetlistGenerator::buildMuxTree(int selectBits) const {
+    Unit unit;
+    vector<int> data(static_cast<size_t>(1) << selectBits);
+    for (auto& input : data) input = unit.addInput();
+    vector<int> selects(selectBits);
+    for (auto& select : selects) select = unit.addInput();
+
+    for (int level = 0; level < selectBits; ++level) {
+        vector<int> next(data.size() / 2);
+        for (size_t i = 0; i < next.size(); ++i) {
+            next[i] = unit.addGate(GateType::MUX2TO1, {data[2 * i], data[2 * i + 1], selects[level]});
+        }
+        data.swap(next);
+    }
+    unit.outputs.push_back(data[0]);
+    return unit;
+}
+
+// stageDepth > 0 registers the mesh after every stageDepth rows
+NetlistGenerator::Unit NetlistGenerator::buildMesh(int width, int depth, int stageDepth) {
+    Unit unit;
+    vector<int> row(width);
+    for (auto& input : row) input = unit.addInput();
+
+    for (int step = 0; step < depth; ++step) {
+        if (stageDepth > 0 && step > 0 && step % stageDepth == 0) {
+            for (auto& node : row) node = unit.addGate(GateType::DFF, {node});
+        }
+        vector<int> next(width);
+        for (int i = 0; i < width; ++i) {
+            int inputCount;
+            GateType type = randomGateType(inputCount);
+            vector<int> inputs;
+            for (int pin = 0; pin < inputCount; ++pin) {
+                inputs.push_back(row[(i + pin) % width]);
+            }
+            next[i] = unit.addGate(type, inputs);
+        }
+        row.swap(next);
+    }
+    unit.outputs = row;
+    return unit;
+}
+
+int NetlistGenerator::getUnitDepth(const Unit& unit) {
+    // Gates are in topological order by construction; a register starts a
+    // new path, counting its clock-to-Q as one gate
+    vector<int> depth(unit.nodeCount, 0);
+    int deepest = 0;
+    for (const auto& gate : unit.gates) {
+        int level = 0;
+        for (int input : gate.inputs) level = max(level, depth[input]);
+        depth[gate.output] = gate.type == GateType::DFF ? 1 : level + 1;
+        deepest = max(deepest, level + 1);
+    }
+    return deepest;
+}
+
+NetlistGenerator::LineWriter& NetlistGenerator::LineWriter::operator<<(long long value) {
+    char digits[24];
+    auto result = to_chars(digits, digits + sizeof(digits), value);
+    buffer.append(digits, result.ptr);
+    return *this;
+}
+
+void NetlistGenerator::LineWriter::endLine() {
+    buffer += '\n';
+    if (buffer.size() >= (1 << 20)) flush();
+}
+
+void NetlistGenerator::LineWriter::flush() {
+    out.write(buffer.data(), static_cast<streamsize>(buffer.size()));
+    buffer.clear();
+}
+
+long long NetlistGenerator::writeRandomDag(LineWriter& out) {
+    const int inputCount = 256;
+    const long long window = 1024;
+    long long outputCount = min(1024LL, max(1LL, targetGates / 100));
+    auto nodeName = [&](long long node) {
+        out << (node < inputCount ? "i" : "n") << (node < inputCount ? node : node - inputCount);
+    };
+
+    // Depth is not known while streaming, so the period is only nominal
+    out << "CLOCK_PERIOD 10.0";
+    out.endLine();
+    out << "INPUT";
+    for (long long i = 0; i < inputCount; ++i) {
+        out << ' ';
+        nodeName(i);
+    }
+    out.endLine();
+
+    for (long long gate = 0; gate < targetGates; ++gate) {
+        // The last gates drive the outputs; declare them before first use
+        if (gate == targetGates - outputCount) {
+            out << "OUTPUT";
+            for (long long o = gate; o < targetGates; ++o) {
+                out << ' ';
+                nodeName(inputCount + o);
+            }
+            out.endLine();
+        }
+
+        int pins;
+        GateType type = randomGateType(pins);
+        long long existing = inputCount + gate;
+        out << "GATE " << getGateTypeName(type) << " g" << gate << ' ';
+        nodeName(existing);
+        for (int pin = 0; pin < pins; ++pin) {
+            long long source = nextBelow(10) < 8
+                ? existing - 1 - static_cast<long long>(nextBelow(min(window, existing)))
+                : static_cast<long long>(nextBelow(existing));
+            out << ' ';
+            nodeName(source);
+        }
+        out.endLine();
+    }
+    return targetGates;
+}
+
+void NetlistGenerator::writeUnitName(LineWriter& out, long long unitIndex, const Unit& unit, int node) {
+    out << 'u' << unitIndex << '_';
+    if (node < unit.inputCount) {
+        out << 'i' << static_cast<long long>(node);
+    } else {
+        out << 'n' << static_cast<long long>(node - unit.inputCount);
+    }
+}
+
+long long NetlistGenerator::writeUnits(LineWriter& out, const Unit& unit) {
+    long long unitGates = max<long long>(1, unit.gates.size());
+    long long unitCount = (targetGates + unitGates - 1) / unitGates;
+
+    // Units run side by side, so the period only has to cover one of them
+    out << "CLOCK_PERIOD " << to_string(0.12 * getUnitDepth(unit));
+    out.endLine();
+    for (long long u = 0; u < unitCount; ++u) {
+        out << "INPUT";
+        for (int i = 0; i < unit.inputCount; ++i) {
+            out << ' ';
+            writeUnitName(out, u, unit, i);
+        }
+        out.endLine();
+        out << "OUTPUT";
+        for (int output : unit.outputs) {
+            out << ' ';
+            writeUnitName(out, u, unit, output);
+        }
+        out.endLine();
+
+        for (size_t g = 0; g < unit.gates.size(); ++g) {
+            const UnitGate& gate = unit.gates[g];
+            out << "GATE " << getGateTypeName(gate.type) << " u" << u << "_g" << static_cast<long long>(g) << ' ';
+            writeUnitName(out, u, unit, gate.output);
+            for (int input : gate.inputs) {
+                out << ' ';
+                writeUnitName(out, u, unit, input);
+            }
+            out.endLine();
+        }
+    }
+    return unitCount * static_cast<long long>(unit.gates.size());
+}
+
+long long NetlistGenerator::writeFile(const string& filename) {
+    ofstream file(filename, ios::binary | ios::trunc);
+    if (!file.is_open()) {
+        throw runtime_error("Cannot create netlist file: " + filename);
+    }
+
+    long long written = 0;
+    {
+        LineWriter out(file);
+        switch (kind) {
+        case RANDOM_DAG: written = writeRandomDag(out); break;
+        case ADDER_ARRAY: written = writeUnits(out, buildAdder(64)); break;
+        case MULTIPLIER_ARRAY: written = writeUnits(out, buildMultiplier(16)); break;
+        case MUX_TREE: written = writeUnits(out, buildMuxTree(10)); break;
+        case RECONVERGENT_MESH: written = writeUnits(out, buildMesh(64, 256, 0)); break;
+        case PIPELINED_MESH: written = writeUnits(out, buildMesh(64, 256, 16)); break;
+        }
+    }
+    if (!file) {
+        throw runtime_error("Failed writing netlist file: " + filename);
+    }
+    return written;
+}
+
+#endif // NETLIST_GENERATOR_H
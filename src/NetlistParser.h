@@ -0,0 +1,365 @@
+#ifndef NETLIST_PARSER_H
+#define NETLIST_PARSER_H
+
+#include <cstdint>
+#include <cstdlib>
+#include <cstring>
+#include <string>
+#include <string_view>
+#include <vector>
+#include "TimingGraph.h"
+
+#ifdef _WIN32
+#ifndef NOMINMAX
+#define NOMINMAX
+#endif
+#include <windows.h>
+#else
+#include <fcntl.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <unistd.h>
+#endif
+
+using namespace std;
+
+// Read-only memory mapping of a whole file
+class MappedFile {
+private:
+    const char* data;
+    size_t size;
+#ifdef _WIN32
+    HANDLE fileHandle;
+    HANDLE mappingHandle;
+#else
+    int fileDescriptor;
+#endif
+
+public:
+    MappedFile();
+    ~MappedFile();
+
+    MappedFile(const MappedFile&) = delete;
+    MappedFile& operator=(const MappedFile&) = delete;
+
+    bool open(const string& filename);
+    void close();
+
+    const char* getData() const { return data; }
+    size_t getSize() const { return size; }
+};
+
+struct NetlistGate {
+    string_view type;
+    string_view name;
+    NodeId output;
+    int firstInput;         // Read through NetlistParser::inputsBegin/End
+    int inputCount;
+};
+
+// MODEL <name> <file>: a timing model (TimingModel.h) the netlist instantiates
+struct NetlistModel {
+    string_view name;
+    string_view path;
+};
+
+// INSTANCE <model> <name> <pins>: the model's outputs, then its inputs
+struct NetlistInstance {
+    string_view model;
+    string_view name;
+    int firstPin;           // Read through NetlistParser::pinsBegin/End
+    int pinCount;
+};
+
+// Zero-copy parser for the CLOCK_PERIOD / HOLD_TIME / INPUT / OUTPUT / GATE /
+// MODEL / INSTANCE netlist format. The file is memory mapped and tokenized in place; every node name
+// is interned straight into a NodeId on first sight, in order of appearance.
+// Names are views into the mapping and stay valid while the parser lives.
+class NetlistParser {
+private:
+    MappedFile file;
+
+    // Open-addressing intern table. Slots keep the upper hash bits next to
+    // NodeId + 1 (0 marks empty) so probes rarely touch the names themselves
+    struct InternSlot {
+        uint32_t tag;
+        NodeId id;
+    };
+    vector<InternSlot> internSlots;
+    vector<string_view> nodeNames;
+    vector<char> inputFlags;        // Set only where the first mention is INPUT
+    vector<char> outputFlags;       // Set only where the first mention is OUTPUT
+    vector<NodeId> primaryInputs;   // Every INPUT mention, in file order
+    vector<NodeId> primaryOutputs;  // Every OUTPUT mention, in file order
+    vector<NetlistGate> gates;
+    vector<NodeId> gateInputs;
+    vector<NetlistModel> models;
+    vector<NetlistInstance> instances;
+    vector<NodeId> instancePins;
+
+    bool clockPeriodSet;
+    double clockPeriod;
+    bool holdTimeSet;
+    double holdTime;
+
+    NodeId intern(string_view name, bool isInput, bool isOutput);
+    void growInternTable();
+    static size_t hashName(string_view name);
+    void parseLine(const char* begin, const char* end);
+    static double parseNumber(string_view token);
+
+public:
+    NetlistParser();
+
+    // Returns false if the file cannot be opened
+    bool parse(const string& filename);
+
+    int getNodeCount() const { return static_cast<int>(nodeNames.size()); }
+    string_view getNodeName(NodeId node) const { return nodeNames[node]; }
+    bool isInput(NodeId node) const { return inputFlags[node] != 0; }
+    bool isOutput(NodeId node) const { return outputFlags[node] != 0; }
+    const vector<NodeId>& getPrimaryInputs() const { return primaryInputs; }
+    const vector<NodeId>& getPrimaryOutputs() const { return primaryOutputs; }
+    const vector<NetlistGate>& getGates() const { return gates; }
+    int getEdgeCount() const { return static_cast<int>(gateInputs.size()); }
+    const NodeId* inputsBegin(const NetlistGate& gate) const { return gateInputs.data() + gate.firstInput; }
+    const NodeId* inputsEnd(const NetlistGate& gate) const { return inputsBegin(gate) + gate.inputCount; }
+    const vector<NetlistModel>& getModels() const { return models; }
+    const vector<NetlistInstance>& getInstances() const { return instances; }
+    const NodeId* pinsBegin(const NetlistInstance& instance) const { return instancePins.data() + instance.firstPin; }
+    const NodeId* pinsEnd(const NetlistInstance& instance) const { return pinsBegin(instance) + instance.pinCount; }
+
+    bool hasClockPeriod() const { return clockPeriodSet; }
+    double getClockPeriod() const { return clockPeriod; }
+    bool hasHoldTime() const { return holdTimeSet; }
+    double getHoldTime() const { return holdTime; }
+};
+
+// ===== Implementation =======================================================
+
+#ifdef _WIN32
+MappedFile::MappedFile()
+    : data(nullptr), size(0), fileHandle(INVALID_HANDLE_VALUE), mappingHandle(nullptr) {
+}
+#else
+MappedFile::MappedFile() : data(nullptr), size(0), fileDescriptor(-1) {
+}
+#endif
+
+MappedFile::~MappedFile() {
+    close();
+}
+
+bool MappedFile::open(const string& filename) {
+    close();
+#ifdef _WIN32
+    fileHandle = CreateFileA(filename.c_str(), GENERIC_READ, FILE_SHARE_READ, nullptr,
+                             OPEN_EXISTING, FILE_FLAG_SEQUENTIAL_SCAN, nullptr);
+    if (fileHandle == INVALID_HANDLE_VALUE) return false;
+
+    LARGE_INTEGER fileSize;
+    if (!GetFileSizeEx(fileHandle, &fileSize)) {
+        close();
+        return false;
+    }
+    size = static_cast<size_t>(fileSize.QuadPart);
+    if (size == 0) return true;
+
+    mappingHandle = CreateFileMappingA(fileHandle, nullptr, PAGE_READONLY, 0, 0, nullptr);
+    if (!mappingHandle) {
+        close();
+        return false;
+    }
+    data = static_cast<const char*>(MapViewOfFile(mappingHandle, FILE_MAP_READ, 0, 0, 0));
+    if (!data) {
+        close();
+        return false;
+    }
+#else
+    fileDescriptor = ::open(filename.c_str(), O_RDONLY);
+    if (fileDescriptor < 0) return false;
+
+    struct stat info;
+    if (fstat(fileDescriptor, &info) != 0 || !S_ISREG(info.st_mode)) {
+        close();
+        return false;
+    }
+    size = static_cast<size_t>(info.st_size);
+    if (size == 0) return true;
+
+    void* mapping = mmap(nullptr, size, PROT_READ, MAP_PRIVATE, fileDescriptor, 0);
+    if (mapping == MAP_FAILED) {
+        close();
+        return false;
+    }
+    madvise(mapping, size, MADV_SEQUENTIAL);
+    data = static_cast<const char*>(mapping);
+#endif
+    return true;
+}
+
+void MappedFile::close() {
+#ifdef _WIN32
+    if (data) UnmapViewOfFile(data);
+    if (mappingHandle) CloseHandle(mappingHandle);
+    if (fileHandle != INVALID_HANDLE_VALUE) CloseHandle(fileHandle);
+    mappingHandle = nullptr;
+    fileHandle = INVALID_HANDLE_VALUE;
+#else
+    if (data) munmap(const_cast<char*>(data), size);
+    if (fileDescriptor >= 0) ::close(fileDescriptor);
+    fileDescriptor = -1;
+#endif
+    data = nullptr;
+    size = 0;
+}
+
+NetlistParser::NetlistParser()
+    : clockPeriodSet(false), clockPeriod(0.0), holdTimeSet(false), holdTime(0.0) {
+}
+
+bool NetlistParser::parse(const string& filename) {
+    if (!file.open(filename)) return false;
+
+    // Rough guess of one distinct node per 24 bytes avoids most rehashing
+    size_t capacity = 1024;
+    while (capacity < file.getSize() / 12) capacity <<= 1;
+    internSlots.assign(capacity, InternSlot{0, 0});
+
+    const char* cursor = file.getData();
+    const char* end = cursor + file.getSize();
+    while (cursor < end) {
+        const char* lineEnd = static_cast<const char*>(memchr(cursor, '\n', end - cursor));
+        if (!lineEnd) lineEnd = end;
+        // Same rule as the getline loop it replaces: skip empty and '#' lines
+        if (lineEnd != cursor && *cursor != '#') {
+            parseLine(cursor, lineEnd);
+        }
+        cursor = lineEnd + 1;
+    }
+    return true;
+}
+
+size_t NetlistParser::hashName(string_view name) {
+    // FNV-1a; names are short, so this beats the generic string hash
+    size_t hash = 14695981039346656037ULL;
+    for (char c : name) {
+        hash = (hash ^ static_cast<unsigned char>(c)) * 1099511628211ULL;
+    }
+    return hash;
+}
+
+NodeId NetlistParser::intern(string_view name, bool isInput, bool isOutput) {
+    size_t hash = hashName(name);
+    uint32_t tag = static_cast<uint32_t>(hash >> 32);
+    size_t mask = internSlots.size() - 1;
+    size_t slot = hash & mask;
+    while (internSlots[slot].id != 0) {
+        NodeId existing = internSlots[slot].id - 1;
+        if (internSlots[slot].tag == tag && nodeNames[existing] == name) return existing;
+        slot = (slot + 1) & mask;
+    }
+
+    NodeId id = static_cast<NodeId>(nodeNames.size());
+    internSlots[slot] = {tag, id + 1};
+    nodeNames.push_back(name);
+    inputFlags.push_back(isInput ? 1 : 0);
+    outputFlags.push_back(isOutput ? 1 : 0);
+
+    // Keep the load factor under one half
+    if (nodeNames.size() * 2 > internSlots.size()) growInternTable();
+    return id;
+}
+
+void NetlistParser::growInternTable() {
+    internSlots.assign(internSlots.size() * 2, InternSlot{0, 0});
+    size_t mask = internSlots.size() - 1;
+    for (NodeId id = 0; id < getNodeCount(); ++id) {
+        size_t hash = hashName(nodeNames[id]);
+        size_t slot = hash & mask;
+        while (internSlots[slot].id != 0) slot = (slot + 1) & mask;
+        internSlots[slot] = {static_cast<uint32_t>(hash >> 32), id + 1};
+    }
+}
+
+double NetlistParser::parseNumber(string_view token) {
+    // strtod needs a terminator, which the mapping does not have
+    char buffer[64];
+    size_t length = min(token.size(), sizeof(buffer) - 1);
+    memcpy(buffer, token.data(), length);
+    buffer[length] = '\0';
+    return strtod(buffer, nullptr);
+}
+
+void NetlistParser::parseLine(const char* begin, const char* end) {
+    auto isSpace = [](char c) {
+        return c == ' ' || c == '\t' || c == '\r' || c == '\v' || c == '\f';
+    };
+    auto nextToken = [&](string_view& token) {
+        while (begin < end && isSpace(*begin)) ++begin;
+        const char* start = begin;
+        while (begin < end && !isSpace(*begin)) ++begin;
+        token = string_view(start, begin - start);
+        return !token.empty();
+    };
+
+    string_view command;
+    if (!nextToken(command)) return;
+
+    string_view token;
+    if (command == "CLOCK_PERIOD") {
+        nextToken(token);
+        clockPeriod = parseNumber(token);
+        clockPeriodSet = true;
+    }
+    else if (command == "HOLD_TIME") {
+        nextToken(token);
+        holdTime = parseNumber(token);
+        holdTimeSet = true;
+    }
+    else if (command == "INPUT") {
+        while (nextToken(token)) {
+            primaryInputs.push_back(intern(token, true, false));
+        }
+    }
+    else if (command == "OUTPUT") {
+        while (nextToken(token)) {
+            primaryOutputs.push_back(intern(token, false, true));
+        }
+    }
+    else if (command == "GATE") {
+        NetlistGate gate;
+        nextToken(gate.type);
+        nextToken(gate.name);
+        string_view output;
+        nextToken(output);
+
+        // Inputs are interned before the output, as Circuit::addGate does
+        gate.firstInput = static_cast<int>(gateInputs.size());
+        while (nextToken(token)) {
+            gateInputs.push_back(intern(token, false, false));
+        }
+        gate.inputCount = static_cast<int>(gateInputs.size()) - gate.firstInput;
+        gate.output = intern(output, false, false);
+        gates.push_back(gate);
+    }
+    else if (command == "MODEL") {
+        NetlistModel model;
+        nextToken(model.name);
+        nextToken(model.path);
+        models.push_back(model);
+    }
+    else if (command == "INSTANCE") {
+        NetlistInstance instance;
+        nextToken(instance.model);
+        nextToken(instance.name);
+        instance.firstPin = static_cast<int>(instancePins.size());
+        while (nextToken(token)) {
+            instancePins.push_back(intern(token, false, false));
+        }
+        instance.pinCount = static_cast<int>(instancePins.size()) - instance.firstPin;
+        instances.push_back(instance);
+    }
+}
+
+#endif // NETLIST_PARSER_H
@@ -3,79 +3,71 @@
 
 #include <string>
 #include <vector>
-#include <memory>
+#include "StringInterner.h"
+#include "TimingStore.h"
 class Gate;
 using namespace std;
+// Nodes are created in their Circuit's arena and must stay trivially
+// destructible; the gates a node drives are found through the TimingGraph.
 class Node {
 private:
-    string name;
+    Symbol name;
     bool isPrimaryInput;
     bool isPrimaryOutput;
-    shared_ptr<Gate> fanin;  // Gate that drives this node
-    vector<shared_ptr<Gate>> fanouts;  // Gates driven by this node
+    Gate* fanin;  // Gate that drives this node
     
-    // Timing information
-    double arrivalTimeRise;
-    double arrivalTimeFall;
-    double requiredTimeRise;
-    double requiredTimeFall;
-    double slackRise;
-    double slackFall;
+    // Timing results live in the circuit's TimingStore at this node's ID;
+    // a node not yet bound to a compiled graph reads all zeros
+    const TimingStore* timing;
+    NodeId id;
     
-    // Additional timing parameters
-    double slewRise;
-    double slewFall;
-    double capacitance;
-    int fanoutCount;
+    double timingValue(const vector<double>& values) const {
+        return (id >= 0 && id < static_cast<NodeId>(values.size())) ? values[id] : 0.0;
+    }
 
 public:
-    Node(const string& name, bool isInput = false, bool isOutput = false);
-    ~Node() = default;
+    Node(Symbol name, bool isInput = false, bool isOutput = false);
 
     // Getters
-    const string& getName() const { return name; }
+    const string& getName() const { return StringInterner::global().text(name); }
+    Symbol getNameSymbol() const { return name; }
     bool isInput() const { return isPrimaryInput; }
     bool isOutput() const { return isPrimaryOutput; }
     
     // Timing getters
-    double getArrivalTimeRise() const { return arrivalTimeRise; }
-    double getArrivalTimeFall() const { return arrivalTimeFall; }
-    double getRequiredTimeRise() const { return requiredTimeRise; }
-    double getRequiredTimeFall() const { return requiredTimeFall; }
-    double getSlackRise() const { return slackRise; }
-    double getSlackFall() const { return slackFall; }
+    double getArrivalTimeRise() const { return timing ? timingValue(timing->arrival) : 0.0; }
+    double getArrivalTimeFall() const { return getArrivalTimeRise(); }
+    double getRequiredTimeRise() const { return timing ? timingValue(timing->required) : 0.0; }
+    double getRequiredTimeFall() const { return getRequiredTimeRise(); }
+    double getSlackRise() const { return timing ? timingValue(timing->slack) : 0.0; }
+    double getSlackFall() const { return getSlackRise(); }
     
-    // Additional parameter getters
-    double getSlewRise() const { return slewRise; }
-    double getSlewFall() const { return slewFall; }
-    double getCapacitance() const { return capacitance; }
-    int getFanoutCount() const { return fanoutCount; }
+    // Early (hold) timing
+    double getEarlyArrivalTime() const { return timing ? timingValue(timing->earlyArrival) : 0.0; }
+    double getHoldRequiredTime() const { return timing ? timingValue(timing->holdRequired) : 0.0; }
+    double getHoldSlack() const { return timing ? timingValue(timing->holdSlack) : 0.0; }
     
-    // Timing setters
-    void setArrivalTimeRise(double time) { arrivalTimeRise = time; }
-    void setArrivalTimeFall(double time) { arrivalTimeFall = time; }
-    void setRequiredTimeRise(double time) { requiredTimeRise = time; }
-    void setRequiredTimeFall(double time) { requiredTimeFall = time; }
-    void setSlackRise(double slack) { slackRise = slack; }
-    void setSlackFall(double slack) { slackFall = slack; }
+    // Additional parameter getters
+    double getSlewRise() const { return timing ? timingValue(timing->slew) : 0.0; }
+    double getSlewFall() const { return getSlewRise(); }
+    double getCapacitance() const { return timing ? timingValue(timing->capacitance) : 0.0; }
+    int getFanoutCount() const {
+        return (timing && id >= 0 && id < static_cast<NodeId>(timing->fanoutCount.size()))
+                   ? timing->fanoutCount[id] : 0;
+    }
     
-    // Additional parameter setters
-    void setSlewRise(double slew) { slewRise = slew; }
-    void setSlewFall(double slew) { slewFall = slew; }
-    void setCapacitance(double cap) { capacitance = cap; }
-    void setFanoutCount(int count) { fanoutCount = count; }
+    // Attaches the node to its slot in the circuit's timing results
+    void bindTiming(const TimingStore* store, NodeId nodeId) { timing = store; id = nodeId; }
+    NodeId getId() const { return id; }
     
     // Connection management
-    void setFanin(shared_ptr<Gate> gate) { fanin = gate; }
-    void addFanout(shared_ptr<Gate> gate) { fanouts.push_back(gate); }
-    shared_ptr<Gate> getFanin() const { return fanin; }
-    const vector<shared_ptr<Gate>>& getFanouts() const { return fanouts; }
+    void setFanin(Gate* gate) { fanin = gate; }
+    Gate* getFanin() const { return fanin; }
     
     // Utility functions
     double getMaxArrivalTime() const;
     double getMinRequiredTime() const;
     double getWorstSlack() const;
-    void resetTiming();
     void printTiming() const;
 };
 
@@ -0,0 +1,758 @@
+#ifndef PARTITIONED_ANALYSIS_H
+#define PARTITIONED_ANALYSIS_H
+
+#include <algorithm>
+#include <cerrno>
+#include <csignal>
+#include <cstdint>
+#include <iostream>
+#include <limits>
+#include <stdexcept>
+#include <string>
+#include <utility>
+#include <vector>
+#include "TimingGraph.h"
+#include "TimingStore.h"
+
+#ifndef _WIN32
+#include <sys/wait.h>
+#include <unistd.h>
+#endif
+
+using namespace std;
+
+// Splits the nodes of a TimingGraph into balanced partitions with few cut
+// edges, i.e. gate input pins whose net is owned by another partition than
+// the gate's output. The levelized nodes are ordered depth-first through the
+// fanin cones of the endpoints, which is a topological order that keeps
+// cones together, and cut into contiguous chunks of equal work (one unit per
+// node plus one per fanin pin). Every edge then runs from a partition to
+// itself or a later one. Refinement moves nodes across the boundaries
+// towards the side that holds more of their neighbours, as long as edges
+// keep running forwards and both partitions stay within IMBALANCE of the
+// average. Register D -> Q edges carry no timing and are ignored.
+class GraphPartitioner {
+public:
+    static constexpr double IMBALANCE = 0.05;
+    static const int REFINE_PASSES = 2;
+
+    // Partition of every node, in [0, partitionCount)
+    static vector<int> partition(const TimingGraph& graph, int partitionCount);
+    static long long countCutEdges(const TimingGraph& graph, const vector<int>& partOf);
+
+private:
+    static long long nodeWeight(const TimingGraph& graph, NodeId node);
+    // Levelized nodes in a topological order that keeps each endpoint's
+    // fanin cone together
+    static vector<NodeId> coneOrder(const TimingGraph& graph);
+};
+
+// Arrival and required times computed by one worker process per partition.
+// Each worker owns the timing of its partition's nodes and reads the nodes of
+// other partitions that its gates have as inputs ("ghosts"). Rounds run in
+// lockstep: the coordinator sends every worker the current late/early
+// arrivals of its ghosts and the required times other partitions contribute
+// to its exported nodes; each worker re-times its partition forward and
+// backward and sends back its exported arrivals and its contributions to its
+// ghosts' required times. The exchange stops at the first round that changes
+// nothing. The graph is acyclic, so that is the single-process result; with
+// edges only running to later partitions, it takes at most one round per
+// partition.
+//
+// Workers apply the same operations in the same order as
+// TimingAnalyzer::analyze (same worst-fanin tie rule, same fanout delays), so
+// the results are bit-identical to a single-process analysis. Workers are
+// forked, so the graph is shared copy-on-write and each worker only allocates
+// timing arrays for its own partition and ghosts. The coordinator has loaded
+// the whole circuit before forking, so this spreads the propagation work but
+// does not bound memory by the partition size.
+class PartitionedAnalysis {
+public:
+    PartitionedAnalysis(const TimingGraph& graph, int partitionCount,
+                        double clockPeriod, double holdTime,
+                        double setupTime, double registerHoldTime);
+
+    // Fills arrival, earlyArrival, worstFanin, required and holdRequired for
+    // every node. Throws if a worker cannot be started or exits early.
+    void run(TimingStore& timing);
+
+    int getPartitionCount() const { return static_cast<int>(partitions.size()); }
+    long long getCutEdgeCount() const { return cutEdgeCount; }
+    // Ghost nodes summed over all partitions: the values exchanged per round
+    long long getBoundaryNodeCount() const;
+    int getRoundCount() const { return roundCount; }
+    // Node and edge visits summed over all workers and rounds
+    long long getNodesVisited() const { return nodesVisited; }
+    long long getEdgesVisited() const { return edgesVisited; }
+
+private:
+    struct Partition {
+        vector<NodeId> owned;       // Levelized nodes in level order
+        vector<NodeId> ghosts;      // Other partitions' nodes read here, ascending
+        vector<NodeId> exports;     // Owned nodes read elsewhere, ascending
+    };
+
+    // What one worker process keeps: local ids are the owned nodes followed
+    // by the ghosts
+    struct Worker {
+        int ownedCount = 0;
+        int drivenBegin = 0;                // First owned node above level 0
+        vector<NodeId> globalIds;
+        vector<double> late, early, required, hold;
+        vector<NodeId> worstFanin;          // Global ids, owned nodes only
+        vector<double> externalRequired, externalHold;
+        vector<char> outputFlags;
+
+        // Driven owned nodes, from drivenBegin: driver delay and fanins
+        vector<double> delays;
+        vector<int> faninStarts;
+        vector<int> fanins;
+        vector<double> arcs;                // Parallel to fanins; empty per gate without arcs
+        vector<char> arcFlags;
+
+        // Every local node: gates it drives here; target -1 is a register
+        // data input
+        vector<int> fanoutStarts;
+        vector<int> fanoutTargets;
+        vector<double> fanoutDelays;
+
+        vector<int> exportLocals;
+        long long nodes = 0;
+        long long edges = 0;
+    };
+
+    const TimingGraph& graph;
+    int requestedPartitions;
+    double clockPeriod;
+    double holdTime;
+    double setupTime;
+    double registerHoldTime;
+
+    vector<Partition> partitions;
+    long long cutEdgeCount;
+    int roundCount;
+    long long nodesVisited;
+    long long edgesVisited;
+
+    void plan();
+    Worker buildWorker(const Partition& partition, const vector<int>& partOf, int index) const;
+    void computeRound(Worker& worker) const;
+    void serveWorker(int index, const vector<int>& partOf, int input, int output) const;
+
+    static void writeAll(int descriptor, const void* data, size_t size);
+    static bool readAll(int descriptor, void* data, size_t size);
+};
+
+// ===== Implementation =======================================================
+
+long long GraphPartitioner::nodeWeight(const TimingGraph& graph, NodeId node) {
+    GateId driver = graph.getDriver(node);
+    if (driver == INVALID_ID || graph.isRegister(driver)) return 1;
+    return 1 + (graph.faninEnd(driver) - graph.faninBegin(driver));
+}
+
+vector<NodeId> GraphPartitioner::coneOrder(const TimingGraph& graph) {
+    // Iterative depth-first search over fanins from the endpoints; each node
+    // is emitted after all of its fanins
+    int nodeCount = graph.getNodeCount();
+    vector<NodeId> order;
+    order.reserve(graph.getTopologicalOrder().size());
+    vector<char> visited(nodeCount, 0);
+    vector<pair<NodeId, int>> stack;
+    auto visit = [&](NodeId root) {
+        if (visited[root] || graph.getLevel(root) < 0) return;
+        visited[root] = 1;
+        stack.push_back({root, 0});
+        while (!stack.empty()) {
+            NodeId node = stack.back().first;
+            int pin = stack.back().second++;
+            GateId driver = graph.getDriver(node);
+            bool timed = driver != INVALID_ID && graph.getLevel(node) > 0;
+            if (timed && graph.faninBegin(driver) + pin < graph.faninEnd(driver)) {
+                NodeId in = graph.faninBegin(driver)[pin];
+                if (!visited[in]) {
+                    visited[in] = 1;
+                    stack.push_back({in, 0});
+                }
+                continue;
+            }
+            order.push_back(node);
+            stack.pop_back();
+        }
+    };
+    for (NodeId endpoint : graph.getEndpoints()) visit(endpoint);
+    for (NodeId node : graph.getTopologicalOrder()) visit(node);
+    return order;
+}
+
+vector<int> GraphPartitioner::partition(const TimingGraph& graph, int partitionCount) {
+    int nodeCount = graph.getNodeCount();
+    // Nodes on combinational cycles are never timed; they go to the last
+    // partition
+    vector<int> partOf(nodeCount, max(1, partitionCount) - 1);
+    if (partitionCount <= 1) return partOf;
+
+    vector<NodeId> order = coneOrder(graph);
+    long long totalWeight = 0;
+    for (NodeId node : order) totalWeight += nodeWeight(graph, node);
+
+    // Contiguous chunks of equal weight
+    vector<long long> weights(partitionCount, 0);
+    long long filled = 0;
+    int part = 0;
+    for (NodeId node : order) {
+        while (part < partitionCount - 1 && filled >= totalWeight * (part + 1) / partitionCount) ++part;
+        partOf[node] = part;
+        weights[part] += nodeWeight(graph, node);
+        filled += nodeWeight(graph, node);
+    }
+
+    // Refinement: a node may join the previous partition when all of its
+    // fanins are there or earlier, or the next one when all of its fanouts
+    // are there or later, so every edge still runs forwards
+    long long average = totalWeight / partitionCount;
+    long long upper = static_cast<long long>(average * (1.0 + IMBALANCE)) + 1;
+    long long lower = static_cast<long long>(average * (1.0 - IMBALANCE));
+    for (int pass = 0; pass < REFINE_PASSES; ++pass) {
+        long long moved = 0;
+        for (NodeId node : order) {
+            int current = partOf[node];
+            int latestFanin = -1;
+            int earliestFanout = partitionCount;
+            int here = 0, before = 0, after = 0;
+            auto count = [&](int neighbor) {
+                here += neighbor == current;
+                before += neighbor == current - 1;
+                after += neighbor == current + 1;
+            };
+            GateId driver = graph.getDriver(node);
+            if (driver != INVALID_ID && graph.getLevel(node) > 0) {
+                for (const NodeId* in = graph.faninBegin(driver); in != graph.faninEnd(driver); ++in) {
+                    latestFanin = max(latestFanin, partOf[*in]);
+                    count(partOf[*in]);
+                }
+            }
+            for (const GateId* g = graph.fanoutBegin(node); g != graph.fanoutEnd(node); ++g) {
+                NodeId output = graph.getOutput(*g);
+                if (graph.getDriver(output) != *g || graph.isRegister(*g) || graph.getLevel(output) < 0) continue;
+                earliestFanout = min(earliestFanout, partOf[output]);
+                count(partOf[output]);
+            }
+
+            int target = current;
+            if (before > here && before >= after && latestFanin <= current - 1) {
+                target = current - 1;
+            } else if (after > here && earliestFanout >= current + 1 && current + 1 < partitionCount) {
+                target = current + 1;
+            }
+            long long weight = nodeWeight(graph, node);
+            if (target != current && weights[target] + weight <= upper && weights[current] - weight >= lower) {
+                partOf[node] = target;
+                weights[target] += weight;
+                weights[current] -= weight;
+                ++moved;
+            }
+        }
+        if (moved == 0) break;
+    }
+    return partOf;
+}
+
+long long GraphPartitioner::countCutEdges(const TimingGraph& graph, const vector<int>& partOf) {
+    long long cut = 0;
+    for (GateId gate = 0; gate < graph.getGateCount(); ++gate) {
+        NodeId output = graph.getOutput(gate);
+        if (output == INVALID_ID || graph.getDriver(output) != gate || graph.isRegister(gate)) continue;
+        if (graph.getLevel(output) < 0) continue;
+        for (const NodeId* in = graph.faninBegin(gate); in != graph.faninEnd(gate); ++in) {
+            if (partOf[*in] != partOf[output]) ++cut;
+        }
+    }
+    return cut;
+}
+
+PartitionedAnalysis::PartitionedAnalysis(const TimingGraph& graphValue, int partitionCount,
+                                         double clockPeriodValue, double holdTimeValue,
+                                         double setupTimeValue, double registerHoldTimeValue)
+    : graph(graphValue), requestedPartitions(max(1, partitionCount)),
+      clockPeriod(clockPeriodValue), holdTime(holdTimeValue),
+      setupTime(setupTimeValue), registerHoldTime(registerHoldTimeValue),
+      cutEdgeCount(0), roundCount(0), nodesVisited(0), edgesVisited(0) {
+}
+
+long long PartitionedAnalysis::getBoundaryNodeCount() const {
+    long long count = 0;
+    for (const Partition& partition : partitions) count += static_cast<long long>(partition.ghosts.size());
+    return count;
+}
+
+void PartitionedAnalysis::plan() {
+    // More partitions than timed nodes would leave some empty
+    int levelized = static_cast<int>(graph.getTopologicalOrder().size());
+    int count = max(1, min(requestedPartitions, levelized));
+    vector<int> partOf = GraphPartitioner::partition(graph, count);
+    cutEdgeCount = GraphPartitioner::countCutEdges(graph, partOf);
+
+    partitions.assign(count, Partition());
+    for (NodeId node : graph.getTopologicalOrder()) {
+        partitions[partOf[node]].owned.push_back(node);
+    }
+
+    // A ghost is an input of a gate whose output the partition owns
+    vector<int> lastSeen(graph.getNodeCount(), -1);
+    vector<char> exported(graph.getNodeCount(), 0);
+    for (int index = 0; index < count; ++index) {
+        Partition& partition = partitions[index];
+        for (NodeId node : partition.owned) {
+            GateId driver = graph.getDriver(node);
+            if (driver == INVALID_ID || graph.getLevel(node) == 0) continue;
+            for (const NodeId* in = graph.faninBegin(driver); in != graph.faninEnd(driver); ++in) {
+                if (partOf[*in] == index || lastSeen[*in] == index) continue;
+                lastSeen[*in] = index;
+                partition.ghosts.push_back(*in);
+                exported[*in] = 1;
+            }
+        }
+        sort(partition.ghosts.begin(), partition.ghosts.end());
+    }
+    for (NodeId node = 0; node < graph.getNodeCount(); ++node) {
+        if (exported[node]) partitions[partOf[node]].exports.push_back(node);
+    }
+}
+
+PartitionedAnalysis::Worker PartitionedAnalysis::buildWorker(const Partition& partition,
+                                                             const vector<int>& partOf,
+                                                             int index) const {
+    Worker worker;
+    worker.ownedCount = static_cast<int>(partition.owned.size());
+    worker.globalIds = partition.owned;
+    worker.globalIds.insert(worker.globalIds.end(), partition.ghosts.begin(), partition.ghosts.end());
+    int localCount = static_cast<int>(worker.globalIds.size());
+
+    vector<int> localOf(graph.getNodeCount(), -1);
+    for (int local = 0; local < localCount; ++local) localOf[worker.globalIds[local]] = local;
+
+    worker.late.assign(localCount, 0.0);
+    worker.early.assign(localCount, 0.0);
+    worker.required.assign(worker.ownedCount, numeric_limits<double>::infinity());
+    worker.hold.assign(worker.ownedCount, -numeric_limits<double>::infinity());
+    worker.worstFanin.assign(worker.ownedCount, INVALID_ID);
+    worker.externalRequired.assign(worker.ownedCount, numeric_limits<double>::infinity());
+    worker.externalHold.assign(worker.ownedCount, -numeric_limits<double>::infinity());
+    worker.outputFlags.resize(worker.ownedCount);
+
+    // Owned nodes are in level order, so level 0 comes first. Register
+    // outputs launch once at their clock-to-Q delay.
+    while (worker.drivenBegin < worker.ownedCount &&
+           graph.getLevel(partition.owned[worker.drivenBegin]) == 0) {
+        NodeId node = partition.owned[worker.drivenBegin];
+        GateId driver = graph.getDriver(node);
+        if (driver != INVALID_ID && graph.isRegister(driver)) {
+            worker.late[worker.drivenBegin] = graph.getDelay(driver);
+            worker.early[worker.drivenBegin] = graph.getDelay(driver);
+        }
+        ++worker.drivenBegin;
+    }
+    worker.faninStarts.push_back(0);
+    for (int local = worker.drivenBegin; local < worker.ownedCount; ++local) {
+        GateId driver = graph.getDriver(partition.owned[local]);
+        worker.delays.push_back(graph.getDelay(driver));
+        bool arcs = graph.hasArcDelays(driver);
+        worker.arcFlags.push_back(arcs ? 1 : 0);
+        const double* arc = arcs ? graph.arcDelaysBegin(driver) : nullptr;
+        for (const NodeId* in = graph.faninBegin(driver); in != graph.faninEnd(driver); ++in) {
+            worker.fanins.push_back(localOf[*in]);
+            worker.arcs.push_back(arcs ? *arc++ : 0.0);
+        }
+        worker.faninStarts.push_back(static_cast<int>(worker.fanins.size()));
+    }
+
+    // Fanouts timed here: gates whose output this partition owns, and
+    // register data inputs of owned nodes
+    worker.fanoutStarts.push_back(0);
+    for (int local = 0; local < localCount; ++local) {
+        NodeId node = worker.globalIds[local];
+        if (local < worker.ownedCount) worker.outputFlags[local] = graph.isOutput(node) ? 1 : 0;
+        for (const GateId* g = graph.fanoutBegin(node); g != graph.fanoutEnd(node); ++g) {
+            NodeId output = graph.getOutput(*g);
+            if (graph.getDriver(output) != *g) continue;
+            if (graph.isRegister(*g)) {
+                if (local >= worker.ownedCount) continue;
+                worker.fanoutTargets.push_back(-1);
+                worker.fanoutDelays.push_back(0.0);
+                continue;
+            }
+            if (partOf[output] != index) continue;
+            worker.fanoutTargets.push_back(localOf[output]);
+            worker.fanoutDelays.push_back(graph.getFanoutDelay(g));
+        }
+        worker.fanoutStarts.push_back(static_cast<int>(worker.fanoutTargets.size()));
+    }
+
+    for (NodeId node : partition.exports) worker.exportLocals.push_back(localOf[node]);
+    return worker;
+}
+
+void PartitionedAnalysis::computeRound(Worker& worker) const {
+    // Forward: the same selects as TimingAnalyzer::arriveNodes, so ties pick
+    // the same fanin
+    double* late = worker.late.data();
+    double* early = worker.early.data();
+    for (int local = worker.drivenBegin; local < worker.ownedCount; ++local) {
+        int gate = local - worker.drivenBegin;
+        const int* in = worker.fanins.data() + worker.faninStarts[gate];
+        const int* inEnd = worker.fanins.data() + worker.faninStarts[gate + 1];
+        worker.edges += inEnd - in;
+        int worst = *in;
+        double latest, earliest;
+        if (worker.arcFlags[gate]) {
+            const double* arc = worker.arcs.data() + worker.faninStarts[gate];
+            latest = late[*in] + *arc;
+            earliest = early[*in] + *arc;
+            for (++in, ++arc; in != inEnd; ++in, ++arc) {
+                if (late[*in] + *arc > latest) {
+                    latest = late[*in] + *arc;
+                    worst = *in;
+                }
+                earliest = min(earliest, early[*in] + *arc);
+            }
+        } else {
+            latest = late[*in];
+            earliest = early[*in];
+            for (++in; in != inEnd; ++in) {
+                double value = late[*in];
+                worst = value > latest ? *in : worst;
+                latest = max(latest, value);
+                earliest = min(earliest, early[*in]);
+            }
+        }
+        late[local] = latest + worker.delays[gate];
+        early[local] = earliest + worker.delays[gate];
+        worker.worstFanin[local] = worker.globalIds[worst];
+    }
+
+    // Backward over the owned nodes, then the contributions to the ghosts,
+    // which only read owned required times
+    double capture = clockPeriod - setupTime;
+    auto pull = [&](int local, double& required, double& holdRequired) {
+        for (int f = worker.fanoutStarts[local]; f < worker.fanoutStarts[local + 1]; ++f) {
+            int target = worker.fanoutTargets[f];
+            if (target < 0) {
+                required = min(required, capture);
+                holdRequired = max(holdRequired, registerHoldTime);
+                continue;
+            }
+            required = min(required, worker.required[target] - worker.fanoutDelays[f]);
+            holdRequired = max(holdRequired, worker.hold[target] - worker.fanoutDelays[f]);
+        }
+        worker.edges += worker.fanoutStarts[local + 1] - worker.fanoutStarts[local];
+    };
+    for (int local = worker.ownedCount - 1; local >= 0; --local) {
+        bool isOutput = worker.outputFlags[local] != 0;
+        double required = isOutput ? clockPeriod : numeric_limits<double>::infinity();
+        double holdRequired = isOutput ? holdTime : -numeric_limits<double>::infinity();
+        required = min(required, worker.externalRequired[local]);
+        holdRequired = max(holdRequired, worker.externalHold[local]);
+        pull(local, required, holdRequired);
+        worker.required[local] = required;
+        worker.hold[local] = holdRequired;
+    }
+    worker.nodes += 2 * worker.ownedCount - worker.drivenBegin;
+}
+
+#ifdef _WIN32
+
+void PartitionedAnalysis::serveWorker(int, const vector<int>&, int, int) const {
+}
+
+void PartitionedAnalysis::writeAll(int, const void*, size_t) {
+}
+
+bool PartitionedAnalysis::readAll(int, void*, size_t) {
+    return false;
+}
+
+void PartitionedAnalysis::run(TimingStore&) {
+    throw runtime_error("Partitioned analysis needs fork() and is not available on this platform");
+}
+
+#else
+
+void PartitionedAnalysis::writeAll(int descriptor, const void* data, size_t size) {
+    const char* bytes = static_cast<const char*>(data);
+    while (size > 0) {
+        ssize_t written = ::write(descriptor, bytes, size);
+        if (written < 0 && errno == EINTR) continue;
+        if (written <= 0) throw runtime_error("Cannot write to partition pipe");
+        bytes += written;
+        size -= static_cast<size_t>(written);
+    }
+}
+
+bool PartitionedAnalysis::readAll(int descriptor, void* data, size_t size) {
+    char* bytes = static_cast<char*>(data);
+    while (size > 0) {
+        ssize_t got = ::read(descriptor, bytes, size);
+        if (got < 0 && errno == EINTR) continue;
+        if (got <= 0) return false;
+        bytes += got;
+        size -= static_cast<size_t>(got);
+    }
+    return true;
+}
+
+void PartitionedAnalysis::serveWorker(int index, const vector<int>& partOf, int input, int output) const {
+    // Rounds: 'R' with the ghost arrivals and the external required times of
+    // the exports; 'F' asks for the owned results and ends the worker
+    const Partition& partition = partitions[index];
+    Worker worker = buildWorker(partition, partOf, index);
+    size_t ghosts = partition.ghosts.size();
+    size_t exports = partition.exports.size();
+    vector<double> message(2 * (ghosts + exports));
+    vector<double> previous;
+    vector<double> reply(message.size());
+    int roundsServed = 0;
+    char command = 0;
+    while (readAll(input, &command, 1) && command == 'R') {
+        if (!readAll(input, message.data(), 2 * (ghosts + exports) * sizeof(double))) return;
+        // Same inputs as last round: same results, nothing to send but those
+        if (roundsServed++ > 0 && message == previous) {
+            writeAll(output, reply.data(), reply.size() * sizeof(double));
+            continue;
+        }
+        previous = message;
+        const double* value = message.data();
+        for (size_t i = 0; i < ghosts; ++i) worker.late[worker.ownedCount + i] = *value++;
+        for (size_t i = 0; i < ghosts; ++i) worker.early[worker.ownedCount + i] = *value++;
+        for (size_t i = 0; i < exports; ++i) worker.externalRequired[worker.exportLocals[i]] = *value++;
+        for (size_t i = 0; i < exports; ++i) worker.externalHold[worker.exportLocals[i]] = *value++;
+
+        computeRound(worker);
+
+        double* next = reply.data();
+        for (size_t i = 0; i < exports; ++i) *next++ = worker.late[worker.exportLocals[i]];
+        for (size_t i = 0; i < exports; ++i) *next++ = worker.early[worker.exportLocals[i]];
+        for (size_t i = 0; i < ghosts; ++i) {
+            double required = numeric_limits<double>::infinity();
+            double holdRequired = -numeric_limits<double>::infinity();
+            int local = worker.ownedCount + static_cast<int>(i);
+            for (int f = worker.fanoutStarts[local]; f < worker.fanoutStarts[local + 1]; ++f) {
+                int target = worker.fanoutTargets[f];
+                required = min(required, worker.required[target] - worker.fanoutDelays[f]);
+                holdRequired = max(holdRequired, worker.hold[target] - worker.fanoutDelays[f]);
+            }
+            worker.edges += worker.fanoutStarts[local + 1] - worker.fanoutStarts[local];
+            next[i] = required;
+            next[ghosts + i] = holdRequired;
+        }
+        writeAll(output, reply.data(), reply.size() * sizeof(double));
+    }
+    if (command != 'F') return;
+
+    size_t owned = static_cast<size_t>(worker.ownedCount);
+    long long counters[2] = {worker.nodes, worker.edges};
+    writeAll(output, worker.late.data(), owned * sizeof(double));
+    writeAll(output, worker.early.data(), owned * sizeof(double));
+    writeAll(output, worker.required.data(), owned * sizeof(double));
+    writeAll(output, worker.hold.data(), owned * sizeof(double));
+    writeAll(output, worker.worstFanin.data(), owned * sizeof(NodeId));
+    writeAll(output, counters, sizeof(counters));
+}
+
+void PartitionedAnalysis::run(TimingStore& timing) {
+    int nodeCount = graph.getNodeCount();
+    timing.arrival.assign(nodeCount, 0.0);
+    timing.earlyArrival.assign(nodeCount, 0.0);
+    timing.worstFanin.assign(nodeCount, INVALID_ID);
+    timing.required.assign(nodeCount, numeric_limits<double>::infinity());
+    timing.holdRequired.assign(nodeCount, -numeric_limits<double>::infinity());
+    roundCount = 0;
+    nodesVisited = 0;
+    edgesVisited = 0;
+
+    plan();
+    int count = getPartitionCount();
+    vector<int> partOf(nodeCount, -1);
+    for (int index = 0; index < count; ++index) {
+        for (NodeId node : partitions[index].owned) partOf[node] = index;
+    }
+
+    // Writes to a worker that died must fail with EPIPE, not kill the
+    // coordinator; output buffered before the fork must not be repeated
+    void (*previousHandler)(int) = signal(SIGPIPE, SIG_IGN);
+    cout.flush();
+    cerr.flush();
+
+    vector<int> toWorker(count, -1);
+    vector<int> fromWorker(count, -1);
+    vector<pid_t> workers;
+    auto shutDown = [&]() {
+        for (int& descriptor : toWorker) {
+            if (descriptor >= 0) ::close(descriptor);
+            descriptor = -1;
+        }
+        for (int& descriptor : fromWorker) {
+            if (descriptor >= 0) ::close(descriptor);
+            descriptor = -1;
+        }
+        for (pid_t pid : workers) {
+            int status;
+            while (waitpid(pid, &status, 0) < 0 && errno == EINTR) {
+            }
+        }
+        workers.clear();
+        signal(SIGPIPE, previousHandler);
+    };
+
+    try {
+        for (int index = 0; index < count; ++index) {
+            int down[2], up[2];
+            if (pipe(down) != 0) throw runtime_error("Cannot create partition pipe");
+            if (pipe(up) != 0) {
+                ::close(down[0]);
+                ::close(down[1]);
+                throw runtime_error("Cannot create partition pipe");
+            }
+            pid_t pid = fork();
+            if (pid < 0) {
+                ::close(down[0]); ::close(down[1]); ::close(up[0]); ::close(up[1]);
+                throw runtime_error("Cannot start partition worker " + to_string(index));
+            }
+            if (pid == 0) {
+                // Worker: keep only its own ends of its own pipes
+                ::close(down[1]);
+                ::close(up[0]);
+                for (int other = 0; other < index; ++other) {
+                    ::close(toWorker[other]);
+                    ::close(fromWorker[other]);
+                }
+                int status = 0;
+                try {
+                    serveWorker(index, partOf, down[0], up[1]);
+                } catch (...) {
+                    status = 1;
+                }
+                _exit(status);
+            }
+            workers.push_back(pid);
+            ::close(down[0]);
+            ::close(up[1]);
+            toWorker[index] = down[1];
+            fromWorker[index] = up[0];
+        }
+
+        // Required times the other partitions contribute to each export, and
+        // what each partition last reported for its ghosts
+        vector<vector<double>> externalRequired(count), externalHold(count);
+        vector<vector<double>> contributions(count);
+        for (int index = 0; index < count; ++index) {
+            externalRequired[index].assign(partitions[index].exports.size(), numeric_limits<double>::infinity());
+            externalHold[index].assign(partitions[index].exports.size(), -numeric_limits<double>::infinity());
+            contributions[index].resize(2 * partitions[index].ghosts.size());
+        }
+        double* scratchRequired = timing.required.data();
+        double* scratchHold = timing.holdRequired.data();
+
+        vector<double> message;
+        bool changed = true;
+        while (changed) {
+            ++roundCount;
+            for (int index = 0; index < count; ++index) {
+                const Partition& partition = partitions[index];
+                message.clear();
+                for (NodeId node : partition.ghosts) message.push_back(timing.arrival[node]);
+                for (NodeId node : partition.ghosts) message.push_back(timing.earlyArrival[node]);
+                message.insert(message.end(), externalRequired[index].begin(), externalRequired[index].end());
+                message.insert(message.end(), externalHold[index].begin(), externalHold[index].end());
+                char command = 'R';
+                writeAll(toWorker[index], &command, 1);
+                writeAll(toWorker[index], message.data(), message.size() * sizeof(double));
+            }
+
+            changed = false;
+            for (int index = 0; index < count; ++index) {
+                const Partition& partition = partitions[index];
+                size_t exports = partition.exports.size();
+                message.resize(2 * exports);
+                if (!readAll(fromWorker[index], message.data(), message.size() * sizeof(double)) ||
+                    !readAll(fromWorker[index], contributions[index].data(),
+                             contributions[index].size() * sizeof(double))) {
+                    throw runtime_error("Partition worker " + to_string(index) + " exited");
+                }
+                for (size_t i = 0; i < exports; ++i) {
+                    NodeId node = partition.exports[i];
+                    if (timing.arrival[node] != message[i] || timing.earlyArrival[node] != message[exports + i]) {
+                        timing.arrival[node] = message[i];
+                        timing.earlyArrival[node] = message[exports + i];
+                        changed = true;
+                    }
+                }
+            }
+
+            // An export's external required time is the tightest over every
+            // partition that reads it
+            for (const Partition& partition : partitions) {
+                for (NodeId node : partition.exports) {
+                    scratchRequired[node] = numeric_limits<double>::infinity();
+                    scratchHold[node] = -numeric_limits<double>::infinity();
+                }
+            }
+            for (int index = 0; index < count; ++index) {
+                const vector<NodeId>& ghosts = partitions[index].ghosts;
+                for (size_t i = 0; i < ghosts.size(); ++i) {
+                    scratchRequired[ghosts[i]] = min(scratchRequired[ghosts[i]], contributions[index][i]);
+                    scratchHold[ghosts[i]] = max(scratchHold[ghosts[i]], contributions[index][ghosts.size() + i]);
+                }
+            }
+            for (int index = 0; index < count; ++index) {
+                const vector<NodeId>& exports = partitions[index].exports;
+                for (size_t i = 0; i < exports.size(); ++i) {
+                    if (externalRequired[index][i] != scratchRequired[exports[i]] ||
+                        externalHold[index][i] != scratchHold[exports[i]]) {
+                        externalRequired[index][i] = scratchRequired[exports[i]];
+                        externalHold[index][i] = scratchHold[exports[i]];
+                        changed = true;
+                    }
+                }
+            }
+        }
+
+        // Converged: collect every partition's own nodes
+        for (int index = 0; index < count; ++index) {
+            char command = 'F';
+            writeAll(toWorker[index], &command, 1);
+        }
+        vector<double> values;
+        vector<NodeId> fanins;
+        for (int index = 0; index < count; ++index) {
+            const vector<NodeId>& owned = partitions[index].owned;
+            values.resize(4 * owned.size());
+            fanins.resize(owned.size());
+            long long counters[2];
+            if (!readAll(fromWorker[index], values.data(), values.size() * sizeof(double)) ||
+                !readAll(fromWorker[index], fanins.data(), fanins.size() * sizeof(NodeId)) ||
+                !readAll(fromWorker[index], counters, sizeof(counters))) {
+                throw runtime_error("Partition worker " + to_string(index) + " exited");
+            }
+            size_t n = owned.size();
+            for (size_t i = 0; i < n; ++i) {
+                NodeId node = owned[i];
+                timing.arrival[node] = values[i];
+                timing.earlyArrival[node] = values[n + i];
+                timing.required[node] = values[2 * n + i];
+                timing.holdRequired[node] = values[3 * n + i];
+                timing.worstFanin[node] = fanins[i];
+            }
+            nodesVisited += counters[0];
+            edgesVisited += counters[1];
+        }
+    } catch (...) {
+        shutDown();
+        throw;
+    }
+    shutDown();
+}
+
+#endif
+
+#endif // PARTITIONED_ANALYSIS_H
@@ -0,0 +1,195 @@
+#ifndef PATH_SEARCH_H
+#define PATH_SEARCH_H
+
+#include <algorithm>
+#include <limits>
+#include <queue>
+#include <vector>
+#include "TimingGraph.h"
+using namespace std;
+
+struct PathRecord {
+    vector<NodeId> nodes;   // Startpoint first, endpoint last
+    double arrival;
+    double slack;
+};
+
+// K-worst-paths search over already propagated arrival times. Every path to
+// an endpoint is the worst path with a set of "deviations", places where it
+// takes a fanin other than the latest-arriving one. Each deviation costs the
+// arrival gap it gives up, so paths can be generated lazily from a priority
+// queue in slack order and the work grows with K instead of with the total
+// number of paths. The latest-arriving fanin of each node is the one recorded
+// during propagation, so tracing a path costs one lookup per stage.
+class PathSearch {
+private:
+    const TimingGraph& graph;
+    const vector<double>& arrival;
+    const vector<NodeId>& worstFanin;
+    double clockPeriod;
+    double setupTime;
+
+    // Work counters across all searches on this object
+    mutable long long expansionCount;
+    mutable long long tracedNodeCount;
+
+    struct Deviation {
+        int parent;             // Deviation further downstream, -1 for none
+        NodeId node;            // Node whose driver input is swapped
+        NodeId predecessor;     // Input taken instead of the worst one
+    };
+
+    struct Candidate {
+        double slack;
+        NodeId endpoint;
+        int deviation;          // Last (most upstream) deviation, -1 for none
+
+        bool operator>(const Candidate& other) const { return slack > other.slack; }
+    };
+
+    bool isStartpoint(NodeId node) const;
+    double requiredAt(NodeId endpoint) const;
+    int tracePath(const Candidate& candidate, const vector<Deviation>& deviations,
+                  vector<NodeId>& nodes) const;
+    vector<PathRecord> search(const vector<NodeId>& endpoints, int k) const;
+
+public:
+    // Paths are checked against the required time at their endpoint: the
+    // clock period at primary outputs, less the setup time at register data
+    // inputs. Paths start at undriven nodes and register outputs, the latter
+    // launched at the register's clock-to-Q.
+    PathSearch(const TimingGraph& graph,
+               const vector<double>& arrival,
+               const vector<NodeId>& worstFanin,
+               double clockPeriod,
+               double setupTime);
+
+    // K worst paths over all endpoints (see TimingGraph::getEndpoints), most
+    // critical first
+    vector<PathRecord> worstPaths(int k) const;
+    // K worst paths ending at one endpoint, most critical first
+    vector<PathRecord> worstPathsTo(NodeId endpoint, int k) const;
+
+    // Candidates pushed on the queue, and nodes walked while tracing paths
+    long long getExpansionCount() const { return expansionCount; }
+    long long getTracedNodeCount() const { return tracedNodeCount; }
+};
+
+// ===== Implementation =======================================================
+
+PathSearch::PathSearch(const TimingGraph& graphValue,
+                       const vector<double>& arrivalValues,
+                       const vector<NodeId>& worstFaninValues,
+                       double clockPeriodValue,
+                       double setupTimeValue)
+    : graph(graphValue), arrival(arrivalValues), worstFanin(worstFaninValues),
+      clockPeriod(clockPeriodValue), setupTime(setupTimeValue),
+      expansionCount(0), tracedNodeCount(0) {
+}
+
+bool PathSearch::isStartpoint(NodeId node) const {
+    // Nodes on a combinational cycle (level -1) also end the walk
+    GateId driver = graph.getDriver(node);
+    return driver == INVALID_ID || graph.getLevel(node) < 0 || graph.isRegister(driver);
+}
+
+double PathSearch::requiredAt(NodeId endpoint) const {
+    // Any other node asked for by worstPathsTo is held to the clock period
+    double required = graph.getEndpointRequired(endpoint, clockPeriod, setupTime);
+    return required == numeric_limits<double>::infinity() ? clockPeriod : required;
+}
+
+int PathSearch::tracePath(const Candidate& candidate, const vector<Deviation>& deviations,
+                          vector<NodeId>& nodes) const {
+    // Deviations are chained from upstream to downstream; walking from the
+    // endpoint needs them in the opposite order
+    vector<const Deviation*> chain;
+    for (int d = candidate.deviation; d != -1; d = deviations[d].parent) {
+        chain.push_back(&deviations[d]);
+    }
+
+    nodes.clear();
+    nodes.push_back(candidate.endpoint);
+    int branchStart = 0;
+    size_t next = chain.size();
+    NodeId current = candidate.endpoint;
+    while (!isStartpoint(current)) {
+        NodeId predecessor;
+        if (next > 0 && chain[next - 1]->node == current) {
+            predecessor = chain[--next]->predecessor;
+            branchStart = static_cast<int>(nodes.size());
+        } else {
+            predecessor = worstFanin[current];
+        }
+        nodes.push_back(predecessor);
+        current = predecessor;
+    }
+    return branchStart;
+}
+
+vector<PathRecord> PathSearch::search(const vector<NodeId>& endpoints, int k) const {
+    vector<PathRecord> paths;
+    if (k <= 0) return paths;
+
+    priority_queue<Candidate, vector<Candidate>, greater<Candidate>> candidates;
+    for (NodeId endpoint : endpoints) {
+        // An undriven net that is not a primary input starts no path
+        if (graph.getLevel(endpoint) < 0) continue;
+        if (graph.getDriver(endpoint) == INVALID_ID && !graph.isInput(endpoint)) continue;
+        candidates.push({requiredAt(endpoint) - arrival[endpoint], endpoint, -1});
+        ++expansionCount;
+    }
+
+    vector<Deviation> deviations;
+    vector<NodeId> nodes;
+    while (!candidates.empty() && static_cast<int>(paths.size()) < k) {
+        Candidate candidate = candidates.top();
+        candidates.pop();
+
+        int branchStart = tracePath(candidate, deviations, nodes);
+        tracedNodeCount += static_cast<long long>(nodes.size());
+
+        // Summing stage delays keeps the reported numbers free of the
+        // rounding accumulated in the queue keys
+        PathRecord path;
+        path.nodes.assign(nodes.rbegin(), nodes.rend());
+        path.arrival = 0.0;
+        for (size_t i = 0; i + 1 < nodes.size(); ++i) {
+            path.arrival += graph.getStageDelay(graph.getDriver(nodes[i]), nodes[i + 1]);
+        }
+        path.arrival += graph.getLaunchDelay(nodes.back());
+        path.slack = requiredAt(candidate.endpoint) - path.arrival;
+        paths.push_back(path);
+
+        // Children deviate strictly upstream of this path's last deviation,
+        // which makes every path reachable from exactly one parent
+        for (size_t i = branchStart; i + 1 < nodes.size(); ++i) {
+            NodeId node = nodes[i];
+            NodeId taken = nodes[i + 1];
+            GateId driver = graph.getDriver(node);
+            const NodeId* first = graph.faninBegin(driver);
+            for (const NodeId* in = first; in != graph.faninEnd(driver); ++in) {
+                if (*in == taken || find(first, in, *in) != in) continue;
+                deviations.push_back({candidate.deviation, node, *in});
+                double sidetrack = arrival[taken] - arrival[*in];
+                if (graph.hasArcDelays(driver)) {
+                    sidetrack += graph.getArcDelay(driver, taken) - graph.getArcDelay(driver, *in);
+                }
+                candidates.push({candidate.slack + sidetrack, candidate.endpoint,
+                                 static_cast<int>(deviations.size()) - 1});
+                ++expansionCount;
+            }
+        }
+    }
+    return paths;
+}
+
+vector<PathRecord> PathSearch::worstPaths(int k) const {
+    return search(graph.getEndpoints(), k);
+}
+
+vector<PathRecord> PathSearch::worstPathsTo(NodeId endpoint, int k) const {
+    return search(vector<NodeId>(1, endpoint), k);
+}
+
+#endif // PATH_SEARCH_H
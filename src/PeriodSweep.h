@@ -0,0 +1,136 @@
+#ifndef PERIOD_SWEEP_H
+#define PERIOD_SWEEP_H
+
+#include <algorithm>
+#include <cmath>
+#include <limits>
+#include <vector>
+#include "TimingGraph.h"
+
+using namespace std;
+
+// Setup timing at one clock period
+struct PeriodResult {
+    double period;
+    double worstSlack;          // Lowest endpoint slack, not clamped at 0
+    int failingEndpoints;       // Endpoints with negative slack
+    NodeId worstEndpoint;       // INVALID_ID without endpoints
+
+    bool passes() const { return failingEndpoints == 0; }
+};
+
+// Clock-period sweep over the arrival times of one analysis. Arrival times do
+// not depend on the clock period, and an endpoint requires either the period
+// (primary outputs), the period less the setup time (register data inputs)
+// or the smaller of the two, so its slack at any period follows from its
+// arrival alone. The endpoints are split by which of the three they require
+// and sorted by arrival once; each period then costs one binary search per
+// group, and its slacks are exactly the ones analyze() would give the
+// endpoints at that period. Hold slack does not depend on the period.
+class PeriodSweep {
+public:
+    // endpointArrivals holds the (latest) arrival of each endpoint; nodes on
+    // combinational loops are not timed and should be left out
+    PeriodSweep(const TimingGraph& graph, const vector<NodeId>& endpoints,
+                const vector<double>& endpointArrivals, double setupTime);
+
+    PeriodResult evaluate(double period) const;
+    vector<PeriodResult> sweep(const vector<double>& periods) const;
+    // Smallest period at which no endpoint fails (0 without endpoints)
+    PeriodResult minimumPeriod() const;
+
+private:
+    enum Requirement { PERIOD, PERIOD_LESS_SETUP, EARLIER_OF_BOTH, REQUIREMENT_COUNT };
+
+    struct EndpointArrival {
+        double arrival;
+        NodeId node;
+
+        bool operator<(const EndpointArrival& other) const { return arrival < other.arrival; }
+    };
+
+    double setupTime;
+    vector<EndpointArrival> groups[REQUIREMENT_COUNT];     // Ascending arrival
+
+    // Same arithmetic as TimingGraph::getEndpointRequired
+    double requiredAt(int requirement, double period) const;
+};
+
+// ===== Implementation =======================================================
+
+PeriodSweep::PeriodSweep(const TimingGraph& graph, const vector<NodeId>& endpoints,
+                         const vector<double>& endpointArrivals, double setupTimeValue)
+    : setupTime(setupTimeValue) {
+    for (size_t i = 0; i < endpoints.size(); ++i) {
+        NodeId endpoint = endpoints[i];
+        bool output = graph.isOutput(endpoint);
+        bool registerInput = graph.isRegisterInput(endpoint);
+        int requirement = !registerInput ? PERIOD : (output ? EARLIER_OF_BOTH : PERIOD_LESS_SETUP);
+        groups[requirement].push_back({endpointArrivals[i], endpoint});
+    }
+    for (auto& group : groups) {
+        sort(group.begin(), group.end());
+    }
+}
+
+double PeriodSweep::requiredAt(int requirement, double period) const {
+    switch (requirement) {
+        case PERIOD: return period;
+        case PERIOD_LESS_SETUP: return period - setupTime;
+        default: return min(period, period - setupTime);
+    }
+}
+
+PeriodResult PeriodSweep::evaluate(double period) const {
+    PeriodResult result = {period, numeric_limits<double>::infinity(), 0, INVALID_ID};
+    for (int requirement = 0; requirement < REQUIREMENT_COUNT; ++requirement) {
+        const vector<EndpointArrival>& group = groups[requirement];
+        if (group.empty()) continue;
+        // Slack is negative exactly where the arrival exceeds the requirement
+        double required = requiredAt(requirement, period);
+        EndpointArrival bound = {required, INVALID_ID};
+        result.failingEndpoints += static_cast<int>(group.end() - upper_bound(group.begin(), group.end(), bound));
+        double slack = required - group.back().arrival;
+        if (slack < result.worstSlack) {
+            result.worstSlack = slack;
+            result.worstEndpoint = group.back().node;
+        }
+    }
+    return result;
+}
+
+vector<PeriodResult> PeriodSweep::sweep(const vector<double>& periods) const {
+    vector<PeriodResult> results;
+    results.reserve(periods.size());
+    for (double period : periods) {
+        results.push_back(evaluate(period));
+    }
+    return results;
+}
+
+PeriodResult PeriodSweep::minimumPeriod() const {
+    // Each group passes from its latest arrival plus what it requires less
+    // than the period; rounding in the subtraction can move that bound by a
+    // few units in the last place, so it is searched out one step at a time
+    double period = 0.0;
+    for (int requirement = 0; requirement < REQUIREMENT_COUNT; ++requirement) {
+        const vector<EndpointArrival>& group = groups[requirement];
+        if (group.empty()) continue;
+        double latest = group.back().arrival;
+        double bound = latest;
+        if (requirement == PERIOD_LESS_SETUP) bound += setupTime;
+        if (requirement == EARLIER_OF_BOTH) bound += max(setupTime, 0.0);
+        while (requiredAt(requirement, bound) < latest) {
+            bound = nextafter(bound, numeric_limits<double>::infinity());
+        }
+        double lower = nextafter(bound, -numeric_limits<double>::infinity());
+        while (requiredAt(requirement, lower) >= latest) {
+            bound = lower;
+            lower = nextafter(bound, -numeric_limits<double>::infinity());
+        }
+        period = max(period, bound);
+    }
+    return evaluate(period);
+}
+
+#endif // PERIOD_SWEEP_H
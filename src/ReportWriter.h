@@ -0,0 +1,496 @@
+#ifndef REPORT_WRITER_H
+#define REPORT_WRITER_H
+
+#include <charconv>
+#include <condition_variable>
+#include <cstdint>
+#include <cstring>
+#include <fstream>
+#include <limits>
+#include <mutex>
+#include <stdexcept>
+#include <string>
+#include <thread>
+#include <vector>
+#include "CornerTiming.h"
+
+using namespace std;
+
+enum class ReportFormat { TEXT, CSV, JSON_LINES, BINARY };
+
+// What a report contains. Filters make the cost of a report proportional to
+// what it lists: nodes with slack >= slackBelow are skipped, and with
+// topEndpoints > 0 only the worst primary outputs are listed, worst first.
+// Critical paths are filtered by the same slack bound.
+struct ReportOptions {
+    ReportFormat format = ReportFormat::TEXT;
+    double slackBelow = numeric_limits<double>::infinity();
+    int topEndpoints = 0;
+
+    bool isFiltered() const {
+        return slackBelow != numeric_limits<double>::infinity() || topEndpoints > 0;
+    }
+
+    static bool parseFormat(const string& name, ReportFormat& format);
+    static const char* getFormatName(ReportFormat format);
+    // csv, jsonl and bin extensions pick their format; anything else is text
+    static ReportFormat formatForFile(const string& filename);
+};
+
+// Worst endpoint of one register-bounded stage (see TimingGraph)
+struct StageResult {
+    int nodeCount;
+    string worstEndpoint;   // Empty when the stage has no endpoint
+    double worstSlack;
+    double worstHoldSlack;
+};
+
+struct ReportSummary {
+    double clockPeriod;
+    double totalDelay;
+    double worstSlack;
+    double worstHoldSlack;
+    bool violation;
+    size_t pathCount;
+    size_t criticalPathCount;
+    size_t nodesReported;
+    size_t nodeCount;
+    bool filtered;          // Text reports only mention the row count when filtered
+    vector<CornerResult> corners;   // Empty for single-corner runs
+    double mergedWorstSlack;
+    double mergedWorstHoldSlack;
+    vector<StageResult> stages;     // Empty without registers
+};
+
+struct ReportNodeRow {
+    double arrival;
+    double required;
+    double slack;
+    double slew;
+    double capacitance;
+    int fanout;
+};
+
+// Streams a timing report in one of the ReportFormats. Records are formatted
+// into a large in-memory buffer; full buffers are handed to a background
+// thread that writes them while formatting continues, so the file is never
+// flushed line by line. Call order: writeSummary, writeNode..., writePath...,
+// close. close() (or an error from the writer thread) throws runtime_error.
+//
+// Text matches the original report layout (3 decimals). CSV lists the node
+// table only. JSON lines emit one object per summary, corner, node and path, with
+// infinite values as null. Binary is a stream of tagged little-endian
+// records:
+//   header   "STAR" uint32 version
+//   'S'      clockPeriod totalDelay worstSlack (double) violation (uint8)
+//            pathCount criticalPathCount nodesReported nodeCount (uint64)
+//   'H'      worstHoldSlack (double); right after 'S'
+//   'C'      name, worstSlack totalDelay worstHoldSlack (double); one per
+//            corner after 'S'
+//   'G'      endpoint name, nodeCount (uint64), worstSlack worstHoldSlack
+//            (double); one per stage after the corners
+//   'N'      name, arrival required slack slew capacitance (double), fanout (int32)
+//   'P'      slack totalDelay (double), uint32 count, count names
+//   'E'      end of report
+// where a name is a uint32 length followed by its bytes.
+class ReportWriter {
+private:
+    static const size_t BUFFER_SIZE = 1 << 22;
+    static const uint32_t BINARY_VERSION = 4;
+
+    ReportFormat format;
+    string filename;
+    ofstream file;
+    size_t pathsWritten;
+    bool open;
+
+    // Double buffering: the producer fills active while the writer thread
+    // drains pending
+    string active;
+    string pending;
+    bool pendingFull;
+    bool closing;
+    bool writeFailed;
+    mutex lock;
+    condition_variable changed;
+    thread writerThread;
+
+    void writerLoop();
+    void handOff();
+    void reserveSpace() { if (active.size() >= BUFFER_SIZE) handOff(); }
+
+    void put(const char* text) { active += text; }
+    void put(const string& text) { active += text; }
+    void put(char c) { active += c; }
+    void putInteger(long long value);
+    void putFixed(double value);            // Text: 3 decimals, like setprecision(3)
+    void putShortest(double value);         // CSV/JSON: shortest round-trip form
+    void putJsonNumber(double value);
+    void putJsonString(const string& text);
+    template <class T> void putRaw(T value);
+    void putRawName(const string& name);
+
+public:
+    ReportWriter(const string& filename, ReportFormat format);
+    ~ReportWriter();
+
+    ReportWriter(const ReportWriter&) = delete;
+    ReportWriter& operator=(const ReportWriter&) = delete;
+
+    void writeSummary(const ReportSummary& summary);
+    void writeNode(const string& name, const ReportNodeRow& row);
+    void writePath(double slack, double totalDelay, const vector<string>& nodes);
+    void close();
+};
+
+// ===== Implementation =======================================================
+
+bool ReportOptions::parseFormat(const string& name, ReportFormat& format) {
+    static const ReportFormat formats[] = {ReportFormat::TEXT, ReportFormat::CSV,
+                                           ReportFormat::JSON_LINES, ReportFormat::BINARY};
+    for (ReportFormat candidate : formats) {
+        if (name == getFormatName(candidate)) {
+            format = candidate;
+            return true;
+        }
+    }
+    return false;
+}
+
+const char* ReportOptions::getFormatName(ReportFormat format) {
+    switch (format) {
+        case ReportFormat::TEXT: return "text";
+        case ReportFormat::CSV: return "csv";
+        case ReportFormat::JSON_LINES: return "jsonl";
+        case ReportFormat::BINARY: return "binary";
+    }
+    return "text";
+}
+
+ReportFormat ReportOptions::formatForFile(const string& filename) {
+    size_t slash = filename.find_last_of("/\\");
+    size_t dot = filename.find_last_of('.');
+    if (dot == string::npos || (slash != string::npos && dot < slash)) return ReportFormat::TEXT;
+    string extension = filename.substr(dot + 1);
+    if (extension == "csv") return ReportFormat::CSV;
+    if (extension == "jsonl") return ReportFormat::JSON_LINES;
+    if (extension == "bin") return ReportFormat::BINARY;
+    return ReportFormat::TEXT;
+}
+
+ReportWriter::ReportWriter(const string& filename, ReportFormat format)
+    : format(format), filename(filename), pathsWritten(0), open(true),
+      pendingFull(false), closing(false), writeFailed(false) {
+    file.open(filename, format == ReportFormat::BINARY ? ios::out | ios::binary : ios::out);
+    if (!file.is_open()) {
+        throw runtime_error("Cannot create report file: " + filename);
+    }
+    active.reserve(BUFFER_SIZE + 4096);
+    pending.reserve(BUFFER_SIZE + 4096);
+    writerThread = thread(&ReportWriter::writerLoop, this);
+
+    if (format == ReportFormat::BINARY) {
+        put("STAR");
+        putRaw<uint32_t>(BINARY_VERSION);
+    } else if (format == ReportFormat::CSV) {
+        put("node,arrival_ns,required_ns,slack_ns,slew_ns,capacitance_ff,fanout\n");
+    }
+}
+
+ReportWriter::~ReportWriter() {
+    if (open) {
+        try {
+            close();
+        } catch (...) {
+            // Destructors must not throw; close() explicitly to see errors
+        }
+    }
+}
+
+void ReportWriter::writerLoop() {
+    unique_lock<mutex> guard(lock);
+    while (true) {
+        changed.wait(guard, [this] { return pendingFull || closing; });
+        if (!pendingFull) break;
+        guard.unlock();
+        file.write(pending.data(), static_cast<streamsize>(pending.size()));
+        bool ok = static_cast<bool>(file);
+        pending.clear();
+        guard.lock();
+        if (!ok) writeFailed = true;
+        pendingFull = false;
+        changed.notify_all();
+    }
+}
+
+void ReportWriter::handOff() {
+    unique_lock<mutex> guard(lock);
+    changed.wait(guard, [this] { return !pendingFull; });
+    if (writeFailed) {
+        throw runtime_error("Error writing report file: " + filename);
+    }
+    active.swap(pending);
+    pendingFull = true;
+    changed.notify_all();
+}
+
+void ReportWriter::close() {
+    if (!open) return;
+    open = false;
+    if (format == ReportFormat::BINARY) put('E');
+    {
+        unique_lock<mutex> guard(lock);
+        changed.wait(guard, [this] { return !pendingFull; });
+        if (!active.empty()) {
+            active.swap(pending);
+            pendingFull = true;
+        }
+        closing = true;
+        changed.notify_all();
+    }
+    writerThread.join();
+    file.close();
+    if (writeFailed || file.fail()) {
+        throw runtime_error("Error writing report file: " + filename);
+    }
+}
+
+void ReportWriter::putInteger(long long value) {
+    char digits[24];
+    auto result = to_chars(digits, digits + sizeof(digits), value);
+    active.append(digits, result.ptr);
+}
+
+void ReportWriter::putFixed(double value) {
+    // Correctly rounded, like the printf that iostreams use for fixed output
+    char digits[400];
+    auto result = to_chars(digits, digits + sizeof(digits), value, chars_format::fixed, 3);
+    active.append(digits, result.ptr);
+}
+
+void ReportWriter::putShortest(double value) {
+    char digits[32];
+    auto result = to_chars(digits, digits + sizeof(digits), value);
+    active.append(digits, result.ptr);
+}
+
+void ReportWriter::putJsonNumber(double value) {
+    if (value != value || value == numeric_limits<double>::infinity() ||
+        value == -numeric_limits<double>::infinity()) {
+        put("null");
+    } else {
+        putShortest(value);
+    }
+}
+
+void ReportWriter::putJsonString(const string& text) {
+    put('"');
+    for (char c : text) {
+        if (c == '"' || c == '\\') put('\\');
+        put(c);
+    }
+    put('"');
+}
+
+template <class T>
+void ReportWriter::putRaw(T value) {
+    // Every supported target is little-endian
+    char bytes[sizeof(T)];
+    memcpy(bytes, &value, sizeof(T));
+    active.append(bytes, sizeof(T));
+}
+
+void ReportWriter::putRawName(const string& name) {
+    putRaw<uint32_t>(static_cast<uint32_t>(name.size()));
+    active.append(name);
+}
+
+void ReportWriter::writeSummary(const ReportSummary& summary) {
+    switch (format) {
+        case ReportFormat::TEXT:
+            put("===========================================\n");
+            put("        STATIC TIMING ANALYSIS REPORT\n");
+            put("===========================================\n\n");
+            put("SUMMARY:\n--------\n");
+            put("Clock Period: "); putFixed(summary.clockPeriod); put(" ns\n");
+            put("Total Delay: "); putFixed(summary.totalDelay); put(" ns\n");
+            put("Worst Slack: "); putFixed(summary.worstSlack); put(" ns\n");
+            put("Worst Hold Slack: "); putFixed(summary.worstHoldSlack); put(" ns\n");
+            put("Timing Violation: "); put(summary.violation ? "YES" : "NO"); put('\n');
+            put("Number of Paths: "); putInteger(static_cast<long long>(summary.pathCount)); put('\n');
+            put("Critical Paths: "); putInteger(static_cast<long long>(summary.criticalPathCount)); put('\n');
+            for (const CornerResult& corner : summary.corners) {
+                put("Corner "); put(corner.name);
+                put(": Worst Slack "); putFixed(corner.worstSlack);
+                put(" ns, Worst Hold Slack "); putFixed(corner.worstHoldSlack);
+                put(" ns, Total Delay "); putFixed(corner.totalDelay); put(" ns\n");
+            }
+            if (!summary.corners.empty()) {
+                put("Merged Worst Slack: "); putFixed(summary.mergedWorstSlack); put(" ns\n");
+                put("Merged Worst Hold Slack: "); putFixed(summary.mergedWorstHoldSlack); put(" ns\n");
+            }
+            for (size_t stage = 0; stage < summary.stages.size(); ++stage) {
+                const StageResult& result = summary.stages[stage];
+                put("Stage "); putInteger(static_cast<long long>(stage));
+                put(": Worst Slack "); putFixed(result.worstSlack);
+                put(" ns, Worst Hold Slack "); putFixed(result.worstHoldSlack);
+                put(" ns at "); put(result.worstEndpoint.empty() ? "-" : result.worstEndpoint);
+                put(", "); putInteger(result.nodeCount); put(" nodes\n");
+                reserveSpace();
+            }
+            if (summary.filtered) {
+                put("Nodes Reported: "); putInteger(static_cast<long long>(summary.nodesReported));
+                put(" of "); putInteger(static_cast<long long>(summary.nodeCount)); put('\n');
+            }
+            put("\nNODE TIMING INFORMATION:\n-----------------------\n");
+            break;
+        case ReportFormat::CSV:
+            break;
+        case ReportFormat::JSON_LINES:
+            put("{\"type\":\"summary\",\"clock_period\":"); putJsonNumber(summary.clockPeriod);
+            put(",\"total_delay\":"); putJsonNumber(summary.totalDelay);
+            put(",\"worst_slack\":"); putJsonNumber(summary.worstSlack);
+            put(",\"worst_hold_slack\":"); putJsonNumber(summary.worstHoldSlack);
+            put(",\"violation\":"); put(summary.violation ? "true" : "false");
+            put(",\"paths\":"); putInteger(static_cast<long long>(summary.pathCount));
+            put(",\"critical_paths\":"); putInteger(static_cast<long long>(summary.criticalPathCount));
+            put(",\"nodes_reported\":"); putInteger(static_cast<long long>(summary.nodesReported));
+            put(",\"nodes\":"); putInteger(static_cast<long long>(summary.nodeCount));
+            if (!summary.corners.empty()) {
+                put(",\"merged_worst_slack\":"); putJsonNumber(summary.mergedWorstSlack);
+                put(",\"merged_worst_hold_slack\":"); putJsonNumber(summary.mergedWorstHoldSlack);
+            }
+            put("}\n");
+            for (const CornerResult& corner : summary.corners) {
+                put("{\"type\":\"corner\",\"name\":"); putJsonString(corner.name);
+                put(",\"worst_slack\":"); putJsonNumber(corner.worstSlack);
+                put(",\"worst_hold_slack\":"); putJsonNumber(corner.worstHoldSlack);
+                put(",\"total_delay\":"); putJsonNumber(corner.totalDelay);
+                put("}\n");
+            }
+            for (size_t stage = 0; stage < summary.stages.size(); ++stage) {
+                const StageResult& result = summary.stages[stage];
+                put("{\"type\":\"stage\",\"index\":"); putInteger(static_cast<long long>(stage));
+                put(",\"nodes\":"); putInteger(result.nodeCount);
+                put(",\"worst_endpoint\":"); putJsonString(result.worstEndpoint);
+                put(",\"worst_slack\":"); putJsonNumber(result.worstSlack);
+                put(",\"worst_hold_slack\":"); putJsonNumber(result.worstHoldSlack);
+                put("}\n");
+                reserveSpace();
+            }
+            break;
+        case ReportFormat::BINARY:
+            put('S');
+            putRaw<double>(summary.clockPeriod);
+            putRaw<double>(summary.totalDelay);
+            putRaw<double>(summary.worstSlack);
+            putRaw<uint8_t>(summary.violation ? 1 : 0);
+            putRaw<uint64_t>(summary.pathCount);
+            putRaw<uint64_t>(summary.criticalPathCount);
+            putRaw<uint64_t>(summary.nodesReported);
+            putRaw<uint64_t>(summary.nodeCount);
+            put('H');
+            putRaw<double>(summary.worstHoldSlack);
+            for (const CornerResult& corner : summary.corners) {
+                put('C');
+                putRawName(corner.name);
+                putRaw<double>(corner.worstSlack);
+                putRaw<double>(corner.totalDelay);
+                putRaw<double>(corner.worstHoldSlack);
+            }
+            for (const StageResult& result : summary.stages) {
+                put('G');
+                putRawName(result.worstEndpoint);
+                putRaw<uint64_t>(static_cast<uint64_t>(result.nodeCount));
+                putRaw<double>(result.worstSlack);
+                putRaw<double>(result.worstHoldSlack);
+                reserveSpace();
+            }
+            break;
+    }
+    reserveSpace();
+}
+
+void ReportWriter::writeNode(const string& name, const ReportNodeRow& row) {
+    switch (format) {
+        case ReportFormat::TEXT:
+            put("Node: "); put(name);
+            put("\n  Arrival Time: "); putFixed(row.arrival);
+            put(" ns\n  Required Time: "); putFixed(row.required);
+            put(" ns\n  Slack: "); putFixed(row.slack);
+            put(" ns\n  Slew: "); putFixed(row.slew);
+            put(" ns\n  Capacitance: "); putFixed(row.capacitance);
+            put(" fF\n  Fanout: "); putInteger(row.fanout);
+            put("\n\n");
+            break;
+        case ReportFormat::CSV:
+            put(name); put(',');
+            putShortest(row.arrival); put(',');
+            putShortest(row.required); put(',');
+            putShortest(row.slack); put(',');
+            putShortest(row.slew); put(',');
+            putShortest(row.capacitance); put(',');
+            putInteger(row.fanout); put('\n');
+            break;
+        case ReportFormat::JSON_LINES:
+            put("{\"type\":\"node\",\"name\":"); putJsonString(name);
+            put(",\"arrival\":"); putJsonNumber(row.arrival);
+            put(",\"required\":"); putJsonNumber(row.required);
+            put(",\"slack\":"); putJsonNumber(row.slack);
+            put(",\"slew\":"); putJsonNumber(row.slew);
+            put(",\"capacitance\":"); putJsonNumber(row.capacitance);
+            put(",\"fanout\":"); putInteger(row.fanout);
+            put("}\n");
+            break;
+        case ReportFormat::BINARY:
+            put('N');
+            putRawName(name);
+            putRaw<double>(row.arrival);
+            putRaw<double>(row.required);
+            putRaw<double>(row.slack);
+            putRaw<double>(row.slew);
+            putRaw<double>(row.capacitance);
+            putRaw<int32_t>(row.fanout);
+            break;
+    }
+    reserveSpace();
+}
+
+void ReportWriter::writePath(double slack, double totalDelay, const vector<string>& nodes) {
+    ++pathsWritten;
+    switch (format) {
+        case ReportFormat::TEXT:
+            if (pathsWritten == 1) put("CRITICAL PATHS:\n---------------\n");
+            put("Path "); putInteger(static_cast<long long>(pathsWritten));
+            put(" (Slack: "); putFixed(slack); put(" ns):\n");
+            for (size_t j = 0; j < nodes.size(); ++j) {
+                put("  "); put(nodes[j]);
+                if (j < nodes.size() - 1) put(" -> ");
+            }
+            put("\n  Total Delay: "); putFixed(totalDelay); put(" ns\n\n");
+            break;
+        case ReportFormat::CSV:
+            break;
+        case ReportFormat::JSON_LINES:
+            put("{\"type\":\"path\",\"rank\":"); putInteger(static_cast<long long>(pathsWritten));
+            put(",\"slack\":"); putJsonNumber(slack);
+            put(",\"delay\":"); putJsonNumber(totalDelay);
+            put(",\"nodes\":[");
+            for (size_t j = 0; j < nodes.size(); ++j) {
+                if (j > 0) put(',');
+                putJsonString(nodes[j]);
+            }
+            put("]}\n");
+            break;
+        case ReportFormat::BINARY:
+            put('P');
+            putRaw<double>(slack);
+            putRaw<double>(totalDelay);
+            putRaw<uint32_t>(static_cast<uint32_t>(nodes.size()));
+            for (const string& node : nodes) putRawName(node);
+            break;
+    }
+    reserveSpace();
+}
+
+#endif // REPORT_WRITER_H
@@ -0,0 +1,74 @@
+#ifndef SIMD_DOUBLE_H
+#define SIMD_DOUBLE_H
+
+#include <algorithm>
+using namespace std;
+
+// Thin wrapper over the widest double-precision vectors the build targets:
+// AVX (4 lanes) when compiled with -mavx or later, SSE2 (2 lanes) on any
+// x86-64 build, and plain doubles otherwise. Kernels loop in steps of
+// SIMD_WIDTH and finish the remainder with scalar code. Every operation is a
+// single IEEE add/sub/mul/min, so results match the scalar loops bit for bit.
+#if defined(__AVX__)
+#include <immintrin.h>
+
+using SimdDouble = __m256d;
+const int SIMD_WIDTH = 4;
+
+inline SimdDouble simdLoad(const double* p) { return _mm256_loadu_pd(p); }
+inline void simdStore(double* p, SimdDouble v) { _mm256_storeu_pd(p, v); }
+inline SimdDouble simdBroadcast(double value) { return _mm256_set1_pd(value); }
+inline SimdDouble simdLoadInts(const int* p) {
+    return _mm256_cvtepi32_pd(_mm_loadu_si128(reinterpret_cast<const __m128i*>(p)));
+}
+inline SimdDouble simdAdd(SimdDouble a, SimdDouble b) { return _mm256_add_pd(a, b); }
+inline SimdDouble simdSub(SimdDouble a, SimdDouble b) { return _mm256_sub_pd(a, b); }
+inline SimdDouble simdMul(SimdDouble a, SimdDouble b) { return _mm256_mul_pd(a, b); }
+inline SimdDouble simdMin(SimdDouble a, SimdDouble b) { return _mm256_min_pd(a, b); }
+inline SimdDouble simdMax(SimdDouble a, SimdDouble b) { return _mm256_max_pd(a, b); }
+
+#elif defined(__SSE2__) || defined(_M_X64)
+#include <emmintrin.h>
+
+using SimdDouble = __m128d;
+const int SIMD_WIDTH = 2;
+
+inline SimdDouble simdLoad(const double* p) { return _mm_loadu_pd(p); }
+inline void simdStore(double* p, SimdDouble v) { _mm_storeu_pd(p, v); }
+inline SimdDouble simdBroadcast(double value) { return _mm_set1_pd(value); }
+inline SimdDouble simdLoadInts(const int* p) {
+    return _mm_cvtepi32_pd(_mm_loadl_epi64(reinterpret_cast<const __m128i*>(p)));
+}
+inline SimdDouble simdAdd(SimdDouble a, SimdDouble b) { return _mm_add_pd(a, b); }
+inline SimdDouble simdSub(SimdDouble a, SimdDouble b) { return _mm_sub_pd(a, b); }
+inline SimdDouble simdMul(SimdDouble a, SimdDouble b) { return _mm_mul_pd(a, b); }
+inline SimdDouble simdMin(SimdDouble a, SimdDouble b) { return _mm_min_pd(a, b); }
+inline SimdDouble simdMax(SimdDouble a, SimdDouble b) { return _mm_max_pd(a, b); }
+
+#else
+
+using SimdDouble = double;
+const int SIMD_WIDTH = 1;
+
+inline SimdDouble simdLoad(const double* p) { return *p; }
+inline void simdStore(double* p, SimdDouble v) { *p = v; }
+inline SimdDouble simdBroadcast(double value) { return value; }
+inline SimdDouble simdLoadInts(const int* p) { return static_cast<double>(*p); }
+inline SimdDouble simdAdd(SimdDouble a, SimdDouble b) { return a + b; }
+inline SimdDouble simdSub(SimdDouble a, SimdDouble b) { return a - b; }
+inline SimdDouble simdMul(SimdDouble a, SimdDouble b) { return a * b; }
+inline SimdDouble simdMin(SimdDouble a, SimdDouble b) { return min(a, b); }
+inline SimdDouble simdMax(SimdDouble a, SimdDouble b) { return max(a, b); }
+
+#endif
+
+// Smallest lane of a vector
+inline double simdReduceMin(SimdDouble v) {
+    alignas(32) double lanes[SIMD_WIDTH];
+    simdStore(lanes, v);
+    double result = lanes[0];
+    for (int i = 1; i < SIMD_WIDTH; ++i) result = min(result, lanes[i]);
+    return result;
+}
+
+#endif // SIMD_DOUBLE_H
@@ -0,0 +1,213 @@
+#ifndef STRING_INTERNER_H
+#define STRING_INTERNER_H
+
+#include <algorithm>
+#include <cstdint>
+#include <memory>
+#include <mutex>
+#include <stdexcept>
+#include <string>
+#include <string_view>
+#include <vector>
+
+using namespace std;
+
+// Dense handle for an interned string; equal strings share one Symbol
+using Symbol = uint32_t;
+const Symbol NO_SYMBOL = UINT32_MAX;
+
+// Process-wide string table. Every distinct net, gate and type name is stored
+// once and referred to by Symbol, which also lets containers map names to
+// their own IDs with a SymbolMap (below) instead of a string hash map. Strings live in fixed-size chunks that never move, so text() is
+// lock-free and its references stay valid for the life of the process;
+// intern() and find() serialize on a mutex.
+//
+// Interned strings are never released: a long-running process that loads
+// many unrelated designs keeps the union of their names.
+class StringInterner {
+private:
+    // 2^14 chunks of 2^14 strings: room for 2^28 distinct names
+    static const int CHUNK_BITS = 14;
+    static const Symbol CHUNK_SIZE = Symbol(1) << CHUNK_BITS;
+    static const size_t MAX_CHUNKS = size_t(1) << 14;
+
+    // Open-addressing table: upper hash bits in the high word, Symbol + 1 in
+    // the low word (0 marks an empty slot)
+    vector<uint64_t> slots;
+    unique_ptr<unique_ptr<string[]>[]> chunks;
+    Symbol count;
+    mutable mutex lock;
+
+    static uint64_t hashText(string_view text);
+    Symbol findLocked(string_view text, uint64_t hash, size_t& slot) const;
+    void grow();
+
+public:
+    StringInterner();
+    StringInterner(const StringInterner&) = delete;
+    StringInterner& operator=(const StringInterner&) = delete;
+
+    static StringInterner& global();
+
+    Symbol intern(string_view text);
+    Symbol find(string_view text) const;                    // NO_SYMBOL if unknown
+    const string& text(Symbol symbol) const {
+        return chunks[symbol >> CHUNK_BITS][symbol & (CHUNK_SIZE - 1)];
+    }
+    size_t size() const;
+};
+
+// Map from Symbol to a container's own ID or object, for one circuit or
+// graph. Symbols are numbered across the whole process, so a table indexed
+// by Symbol would be as large as every name ever interned; this one is
+// open-addressed and sized by its own entries. Values equal to `missing`
+// mark absent names, so an entry is removed by storing `missing`.
+template <typename T>
+class SymbolMap {
+private:
+    vector<Symbol> keys;        // NO_SYMBOL marks an empty slot
+    vector<T> values;
+    size_t count;
+    T missing;
+
+    size_t slotOf(Symbol symbol) const {
+        // Fibonacci hashing; Symbols are dense, so their low bits alone would
+        // cluster the probes
+        return static_cast<size_t>((symbol * 0x9E3779B97F4A7C15ULL) >> 32) & (keys.size() - 1);
+    }
+    void rehash(size_t capacity);
+
+public:
+    explicit SymbolMap(T missingValue) : count(0), missing(missingValue) {}
+
+    T find(Symbol symbol) const;
+    T& operator[](Symbol symbol);           // Inserts `missing` for a new name
+    void reserve(size_t entries);
+    size_t size() const { return count; }
+    void clear() { keys.clear(); values.clear(); count = 0; }
+};
+
+// ===== Implementation =======================================================
+
+StringInterner::StringInterner()
+    : slots(1024, 0), chunks(new unique_ptr<string[]>[MAX_CHUNKS]), count(0) {
+}
+
+StringInterner& StringInterner::global() {
+    static StringInterner interner;
+    return interner;
+}
+
+uint64_t StringInterner::hashText(string_view text) {
+    // FNV-1a, as in NetlistParser; names are short
+    uint64_t hash = 14695981039346656037ULL;
+    for (char c : text) {
+        hash = (hash ^ static_cast<unsigned char>(c)) * 1099511628211ULL;
+    }
+    return hash;
+}
+
+Symbol StringInterner::findLocked(string_view text, uint64_t hash, size_t& slot) const {
+    uint32_t tag = static_cast<uint32_t>(hash >> 32);
+    size_t mask = slots.size() - 1;
+    for (slot = hash & mask; slots[slot] != 0; slot = (slot + 1) & mask) {
+        if (static_cast<uint32_t>(slots[slot] >> 32) != tag) continue;
+        Symbol symbol = static_cast<Symbol>(slots[slot]) - 1;
+        if (this->text(symbol) == text) return symbol;
+    }
+    return NO_SYMBOL;
+}
+
+void StringInterner::grow() {
+    vector<uint64_t> old;
+    old.swap(slots);
+    slots.assign(old.size() * 2, 0);
+    size_t mask = slots.size() - 1;
+    for (uint64_t entry : old) {
+        if (entry == 0) continue;
+        size_t slot = hashText(text(static_cast<Symbol>(entry) - 1)) & mask;
+        while (slots[slot] != 0) slot = (slot + 1) & mask;
+        slots[slot] = entry;
+    }
+}
+
+Symbol StringInterner::intern(string_view text) {
+    lock_guard<mutex> guard(lock);
+    uint64_t hash = hashText(text);
+    size_t slot;
+    Symbol symbol = findLocked(text, hash, slot);
+    if (symbol != NO_SYMBOL) return symbol;
+
+    symbol = count;
+    if ((symbol >> CHUNK_BITS) >= MAX_CHUNKS) {
+        throw runtime_error("String interner is full");
+    }
+    unique_ptr<string[]>& chunk = chunks[symbol >> CHUNK_BITS];
+    if (!chunk) chunk.reset(new string[CHUNK_SIZE]);
+    chunk[symbol & (CHUNK_SIZE - 1)].assign(text.data(), text.size());
+    ++count;
+
+    slots[slot] = (static_cast<uint64_t>(hash >> 32) << 32) | (static_cast<uint64_t>(symbol) + 1);
+    if (static_cast<size_t>(count) * 2 > slots.size()) grow();
+    return symbol;
+}
+
+Symbol StringInterner::find(string_view text) const {
+    lock_guard<mutex> guard(lock);
+    size_t slot;
+    return findLocked(text, hashText(text), slot);
+}
+
+size_t StringInterner::size() const {
+    lock_guard<mutex> guard(lock);
+    return count;
+}
+
+template <typename T>
+T SymbolMap<T>::find(Symbol symbol) const {
+    if (keys.empty() || symbol == NO_SYMBOL) return missing;
+    size_t mask = keys.size() - 1;
+    for (size_t slot = slotOf(symbol); keys[slot] != NO_SYMBOL; slot = (slot + 1) & mask) {
+        if (keys[slot] == symbol) return values[slot];
+    }
+    return missing;
+}
+
+template <typename T>
+T& SymbolMap<T>::operator[](Symbol symbol) {
+    if ((count + 1) * 2 > keys.size()) rehash(max<size_t>(64, keys.size() * 2));
+    size_t mask = keys.size() - 1;
+    size_t slot = slotOf(symbol);
+    for (; keys[slot] != NO_SYMBOL; slot = (slot + 1) & mask) {
+        if (keys[slot] == symbol) return values[slot];
+    }
+    keys[slot] = symbol;
+    values[slot] = missing;
+    ++count;
+    return values[slot];
+}
+
+template <typename T>
+void SymbolMap<T>::reserve(size_t entries) {
+    size_t capacity = 64;
+    while (capacity < entries * 2) capacity *= 2;
+    if (capacity > keys.size()) rehash(capacity);
+}
+
+template <typename T>
+void SymbolMap<T>::rehash(size_t capacity) {
+    vector<Symbol> oldKeys(capacity, NO_SYMBOL);
+    vector<T> oldValues(capacity, missing);
+    oldKeys.swap(keys);
+    oldValues.swap(values);
+    size_t mask = capacity - 1;
+    for (size_t i = 0; i < oldKeys.size(); ++i) {
+        if (oldKeys[i] == NO_SYMBOL) continue;
+        size_t slot = slotOf(oldKeys[i]);
+        while (keys[slot] != NO_SYMBOL) slot = (slot + 1) & mask;
+        keys[slot] = oldKeys[i];
+        values[slot] = oldValues[i];
+    }
+}
+
+#endif // STRING_INTERNER_H
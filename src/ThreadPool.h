@@ -0,0 +1,171 @@
+#ifndef THREAD_POOL_H
+#define THREAD_POOL_H
+
+#include <atomic>
+#include <condition_variable>
+#include <deque>
+#include <functional>
+#include <memory>
+#include <mutex>
+#include <thread>
+#include <vector>
+using namespace std;
+
+// Small work-stealing pool for data-parallel loops. parallelFor splits a range
+// into chunks that are dealt round-robin onto per-thread deques; each thread
+// drains its own deque from the back and steals from the front of the others
+// once it runs dry. The calling thread takes part in the work.
+class ThreadPool {
+private:
+    using RangeBody = function<void(int, int)>;
+
+    struct Task {
+        int begin;
+        int end;
+        const RangeBody* body;
+    };
+
+    struct WorkQueue {
+        mutex lock;
+        deque<Task> tasks;
+    };
+
+    vector<unique_ptr<WorkQueue>> queues;   // Index 0 belongs to the caller
+    vector<thread> workers;
+
+    mutex stateMutex;
+    condition_variable workAvailable;
+    condition_variable workDone;
+    atomic<int> remainingTasks;
+    unsigned long long generation;
+    bool stopping;
+
+    bool popLocal(int self, Task& task);
+    bool steal(int self, Task& task);
+    void runTasks(int self);
+    void workerLoop(int self);
+
+public:
+    explicit ThreadPool(int threadCount);
+    ~ThreadPool();
+
+    ThreadPool(const ThreadPool&) = delete;
+    ThreadPool& operator=(const ThreadPool&) = delete;
+
+    int getThreadCount() const { return static_cast<int>(queues.size()); }
+
+    // Calls body(begin, end) over [0, count) in chunks of about grainSize
+    // items and returns once every chunk has finished
+    void parallelFor(int count, int grainSize, const RangeBody& body);
+
+    static int defaultThreadCount();
+};
+
+// ===== Implementation =======================================================
+
+ThreadPool::ThreadPool(int threadCount)
+    : remainingTasks(0), generation(0), stopping(false) {
+    if (threadCount < 1) threadCount = 1;
+    for (int i = 0; i < threadCount; ++i) {
+        queues.push_back(make_unique<WorkQueue>());
+    }
+    for (int i = 1; i < threadCount; ++i) {
+        workers.emplace_back(&ThreadPool::workerLoop, this, i);
+    }
+}
+
+ThreadPool::~ThreadPool() {
+    {
+        lock_guard<mutex> guard(stateMutex);
+        stopping = true;
+    }
+    workAvailable.notify_all();
+    for (auto& worker : workers) {
+        worker.join();
+    }
+}
+
+int ThreadPool::defaultThreadCount() {
+    unsigned int cores = thread::hardware_concurrency();
+    return cores > 0 ? static_cast<int>(cores) : 1;
+}
+
+bool ThreadPool::popLocal(int self, Task& task) {
+    WorkQueue& queue = *queues[self];
+    lock_guard<mutex> guard(queue.lock);
+    if (queue.tasks.empty()) return false;
+    task = queue.tasks.back();
+    queue.tasks.pop_back();
+    return true;
+}
+
+bool ThreadPool::steal(int self, Task& task) {
+    int count = getThreadCount();
+    for (int offset = 1; offset < count; ++offset) {
+        WorkQueue& victim = *queues[(self + offset) % count];
+        lock_guard<mutex> guard(victim.lock);
+        if (victim.tasks.empty()) continue;
+        task = victim.tasks.front();
+        victim.tasks.pop_front();
+        return true;
+    }
+    return false;
+}
+
+void ThreadPool::runTasks(int self) {
+    Task task;
+    while (popLocal(self, task) || steal(self, task)) {
+        (*task.body)(task.begin, task.end);
+        if (remainingTasks.fetch_sub(1) == 1) {
+            lock_guard<mutex> guard(stateMutex);
+            workDone.notify_all();
+        }
+    }
+}
+
+void ThreadPool::workerLoop(int self) {
+    unsigned long long seen = 0;
+    while (true) {
+        {
+            unique_lock<mutex> guard(stateMutex);
+            workAvailable.wait(guard, [&] { return stopping || generation != seen; });
+            if (stopping) return;
+            seen = generation;
+        }
+        runTasks(self);
+    }
+}
+
+void ThreadPool::parallelFor(int count, int grainSize, const RangeBody& body) {
+    if (count <= 0) return;
+    if (grainSize < 1) grainSize = 1;
+    int threads = getThreadCount();
+    if (threads == 1 || count <= grainSize) {
+        body(0, count);
+        return;
+    }
+
+    // Never cut fewer chunks than threads, so every thread has something to do
+    int chunkSize = min(grainSize, (count + threads - 1) / threads);
+    int chunkCount = (count + chunkSize - 1) / chunkSize;
+    remainingTasks.store(chunkCount);
+    for (int chunk = 0; chunk < chunkCount; ++chunk) {
+        int begin = chunk * chunkSize;
+        Task task = {begin, min(count, begin + chunkSize), &body};
+        WorkQueue& queue = *queues[chunk % threads];
+        lock_guard<mutex> guard(queue.lock);
+        queue.tasks.push_back(task);
+    }
+    {
+        lock_guard<mutex> guard(stateMutex);
+        ++generation;
+    }
+    workAvailable.notify_all();
+
+    runTasks(0);
+
+    unique_lock<mutex> guard(stateMutex);
+    workDone.wait(guard, [&] { return remainingTasks.load() == 0; });
+}
+
+#endif // THREAD_POOL_H
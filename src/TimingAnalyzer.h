@@ -2,14 +2,25 @@
 #define TIMING_ANALYZER_H
 
 #include "Circuit.h"
+#include "ThreadPool.h"
+#include "PathSearch.h"
+#include "AnalysisMetrics.h"
+#include "ReportWriter.h"
+#include "MonteCarlo.h"
+#include "PartitionedAnalysis.h"
+#include "PeriodSweep.h"
+#include "TimingQuery.h"
 #include <vector>
 #include <string>
 #include <map>
 #include <queue>
+#include <memory>
 using namespace std;
 
 struct TimingPath {
     vector<string> nodes;
+    vector<double> stageDelays;     // Delay of the gate driving each node; at the startpoint
+                                    // the clock-to-Q of a register, else 0
     double totalDelay;
     double slack;
     bool isCritical;
@@ -18,15 +29,44 @@ struct TimingPath {
 class TimingAnalyzer {
 private:
     Circuit& circuit;
+    TimingStore& timing;    // Analysis results, owned by the circuit, indexed by NodeId
     vector<TimingPath> allPaths;
     vector<TimingPath> criticalPaths;
     double worstSlack;
+    double worstHoldSlack;
     double totalDelay;
     
-    // Analysis results
-    map<string, double> arrivalTimes;
-    map<string, double> requiredTimes;
-    map<string, double> slackTimes;
+    // Level-parallel propagation
+    int threadCount;
+    unique_ptr<ThreadPool> threadPool;
+    
+    // Worker processes for arrival/required times (1 = in this process)
+    int partitionCount;
+    
+    // Path search limits
+    int maxPaths;
+    int pathsPerEndpoint;
+    
+    // Incremental update scratch
+    vector<char> queuedFlags;
+    vector<NodeId> touchedNodes;
+    
+    // Multi-corner results (empty unless the circuit has corners)
+    CornerTimingStore cornerTiming;
+    vector<CornerResult> cornerResults;
+    
+    // Per-stage results (empty unless the circuit has registers)
+    vector<StageResult> stageResults;
+    
+    // Report format and filters
+    ReportOptions reportOptions;
+    
+    // Per-phase timings and work counters
+    AnalysisMetrics metrics;
+    
+    // On-demand queries before analyze(); table delays are bound on the first
+    TimingQuery timingQuery;
+    bool queryDelaysBound;
     
 public:
     TimingAnalyzer(Circuit& circuit);
@@ -37,24 +77,115 @@ public:
     void calculateArrivalTimes();
     void calculateRequiredTimes();
     void calculateSlackTimes();
+    void calculateStageResults();
+    void findWorstPaths();
     void findCriticalPaths();
     void calculateTotalDelay();
     
+    // Multi-corner analysis: analyze() runs these instead of the single
+    // corner arrival/required passes when the circuit has delay corners.
+    // Corner 0 is copied into the node timing, so paths and reports see it.
+    void calculateCornerArrivalTimes();
+    void calculateCornerRequiredTimes();
+    void calculateCornerSlacks();
+    
+    // Partitioned analysis: analyze() runs this instead of the arrival and
+    // required passes when more than one partition is set (and the circuit
+    // has no corners). Each partition is timed in its own worker process
+    // (see PartitionedAnalysis.h); the results match the single-process ones.
+    void calculatePartitionedTimes();
+    
+    // Table delay model: analyze() binds gate delays from the library's
+    // tables before propagating (see Circuit::calculateDelays), which also
+    // gives every node its slew and load in place of the estimates below
+    void calculateGateDelays();
+    
     // Additional timing analysis
     void calculateSlewTimes();
     void calculateCapacitance();
     void calculateFanoutCounts();
     
-    // Report generation
+    // Report generation. Besides the report itself, writes the metrics as
+    // <report>.metrics.json and <report>.metrics.csv next to it.
     void generateReport(const string& filename);
+    void setReportOptions(const ReportOptions& options) { reportOptions = options; }
+    
+    // Statistical timing: samples gate delays from the library sigmas (see
+    // MonteCarlo.h) on the pool. Results go to the console and, per endpoint,
+    // to <report>.montecarlo.csv.
+    MonteCarloResult runMonteCarlo(int samples, uint64_t seed);
+    void printMonteCarloSummary(const MonteCarloResult& result) const;
+    void writeMonteCarloReport(const MonteCarloResult& result, const string& reportFilename) const;
+    const ReportOptions& getReportOptions() const { return reportOptions; }
+    
+    // Clock-period sweep (see PeriodSweep.h): setup slack at other clock
+    // periods from the current arrival times, at a cost per period that grows
+    // with the log of the endpoint count instead of another analyze(). With
+    // delay corners each endpoint takes its latest arrival over the corners;
+    // after an edit only the primary corner counts until the next analyze().
+    PeriodSweep makePeriodSweep() const;
+    vector<PeriodResult> sweepClockPeriods(const vector<double>& periods) const;
+    PeriodResult findMinimumPeriod() const;
+    void printPeriodSweep(const vector<PeriodResult>& results) const;
     void printSummary();
     void printDetailedReport();
     
+    // On-demand timing (see TimingQuery.h): arrival, required time and slack
+    // of one node without analyze(), timing only the node's fanin and fanout
+    // cones and keeping them for later queries. Edits through this analyzer
+    // drop what was kept. Once analyze() has run, its results are returned.
+    NodeTiming queryTiming(const string& node);
+    double querySlack(const string& node) { return queryTiming(node).slack; }
+    const TimingQuery& getTimingQuery() const { return timingQuery; }
+    
+    // Incremental (ECO) updates: each edit is applied to the circuit and only
+    // the affected fanout/fanin cones are re-timed. Paths, critical paths and
+    // the total delay are refreshed separately by updatePaths(). Only the
+    // primary corner is re-timed: an edit drops the corner timing and corner
+    // results, so getCornerResults() is empty and getMergedWorstSlack() and
+    // isTimingViolation() see the primary corner until the next analyze().
+    void setGateDelay(const string& gateName, double delay);
+    void setGateType(const string& gateName, const string& type);
+    void addGate(const string& type, const string& name,
+                 const vector<string>& inputs, const string& output);
+    void removeGate(const string& gateName);
+    void reconnectGateInput(const string& gateName, int pin, const string& nodeName);
+    void updatePaths();
+    
+    // Parallelism (1 = serial propagation)
+    void setThreadCount(int threads);
+    int getThreadCount() const { return threadCount; }
+    void setPartitionCount(int partitions) { partitionCount = max(1, partitions); }
+    int getPartitionCount() const { return partitionCount; }
+    
+    // Path search: analyze() keeps the maxPaths worst paths overall, or the
+    // pathsPerEndpoint worst paths of every endpoint when that is non-zero
+    void setPathLimits(int maxPaths, int pathsPerEndpoint = 0);
+    vector<TimingPath> getWorstPaths(int k);
+    vector<TimingPath> getWorstPathsTo(const string& endpoint, int k);
+    // Latest-arriving path into any node, traced back through the fanins
+    // recorded during propagation in time proportional to its depth; its
+    // slack is the node's own slack
+    TimingPath worstPathTo(const string& node);
+    
     // Getters
     const vector<TimingPath>& getAllPaths() const { return allPaths; }
     const vector<TimingPath>& getCriticalPaths() const { return criticalPaths; }
     double getWorstSlack() const { return worstSlack; }
+    // Earliest arrival against the netlist's HOLD_TIME at the outputs
+    double getWorstHoldSlack() const { return worstHoldSlack; }
     double getTotalDelay() const { return totalDelay; }
+    const vector<CornerResult>& getCornerResults() const { return cornerResults; }
+    // One entry per register-bounded stage, in TimingGraph stage order
+    const vector<StageResult>& getStageResults() const { return stageResults; }
+    const CornerTimingStore& getCornerTiming() const { return cornerTiming; }
+    double getMergedWorstSlack() const;
+    double getMergedWorstHoldSlack() const;
+    
+    // Instrumentation: analyze() and generateReport() each add their phases;
+    // callers may add their own (e.g. loading) and clear() between runs
+    AnalysisMetrics& getMetrics() { return metrics; }
+    const AnalysisMetrics& getMetrics() const { return metrics; }
     
     // Utility functions
     void resetAnalysis();
@@ -62,13 +193,49 @@ public:
     void printTimingPath(const TimingPath& path) const;
     
 private:
+    // What the endpoints require: the clock period and HOLD_TIME at primary
+    // outputs, the clock period less the setup time and the register hold
+    // time at register data inputs
+    struct EndpointConstraints {
+        double clockPeriod;
+        double holdTime;
+        double setupTime;
+        double registerHoldTime;
+    };
+    
     // Helper functions
-    void findAllPaths();
-    void findPathsRecursive(const string& currentNode, 
-                           vector<string>& currentPath,
-                           map<string, bool>& visited);
-    double calculatePathDelay(const vector<string>& path) const;
+    TimingPath makeTimingPath(const TimingGraph& graph, const PathRecord& record) const;
+    static double latestArcArrival(const TimingGraph& graph, GateId gate,
+                                   const double* arrival, NodeId& worst);
+    static double earliestArcArrival(const TimingGraph& graph, GateId gate, const double* earlyArrival);
+    EndpointConstraints getEndpointConstraints() const;
+    void launchRegisters(const TimingGraph& graph);
+    void arriveNodes(const TimingGraph& graph, const NodeId* nodes, int begin, int end);
+    void requireNodes(const TimingGraph& graph, const NodeId* nodes, int begin, int end,
+                      const EndpointConstraints& constraints);
+    void propagateArrivalLevel(const TimingGraph& graph, int level);
+    void propagateRequiredLevel(const TimingGraph& graph, int level, const EndpointConstraints& constraints);
+    bool useStageTasks(const TimingGraph& graph) const;
+    void propagateStages(const TimingGraph& graph, bool arrivals);
+    void propagateCornerArrivalLevel(const TimingGraph& graph, int level);
+    void propagateCornerRequiredLevel(const TimingGraph& graph, int level);
     void updateWorstSlack();
+    void writeReport(const string& filename);
+    static string sidecarBase(const string& reportFilename);
+    vector<NodeId> selectReportNodes() const;
+    
+    // Incremental propagation
+    bool hasTiming() const { return !timing.slack.empty(); }
+    void resetQueries();
+    void resizeTiming(const TimingGraph& graph);
+    void recalculateDelays(const TimingGraph& graph, const vector<NodeId>& loadChanged,
+                           vector<NodeId>& forwardSeeds, vector<NodeId>& backwardSeeds);
+    void retime(const TimingGraph& graph,
+                const vector<NodeId>& forwardSeeds,
+                const vector<NodeId>& backwardSeeds);
+    void retimeArrivals(const TimingGraph& graph, const vector<NodeId>& seeds);
+    void retimeRequired(const TimingGraph& graph, const vector<NodeId>& seeds);
+    void refreshTouchedNodes(const TimingGraph& graph, const vector<NodeId>& loadChanged);
     void sortPathsBySlack();
 };
 
@@ -0,0 +1,772 @@
+#ifndef TIMING_GRAPH_H
+#define TIMING_GRAPH_H
+
+#include <algorithm>
+#include <limits>
+#include <string>
+#include <string_view>
+#include <unordered_set>
+#include <utility>
+#include <vector>
+#include "GateType.h"
+#include "StringInterner.h"
+using namespace std;
+
+using NodeId = int;
+using GateId = int;
+const int INVALID_ID = -1;
+
+// Structural problems found while ordering the graph. Loops are the
+// strongly connected components that close a combinational cycle (several
+// nodes, or one gate reading its own output); their nodes, and every node
+// they feed, have no level and are never timed.
+struct GraphValidation {
+    vector<vector<NodeId>> loops;       // Nodes of each loop, ascending
+    vector<NodeId> behindLoops;         // Untimed nodes outside any loop
+    vector<NodeId> multiplyDriven;      // Written by more than one gate; the last one wins
+    vector<NodeId> undriven;            // Read or a primary output, but no driver or input
+    vector<NodeId> dangling;            // Driven, but neither read nor a primary output
+
+    bool hasLoops() const { return !loops.empty(); }
+    bool isClean() const {
+        return loops.empty() && multiplyDriven.empty() && undriven.empty() && dangling.empty();
+    }
+};
+
+// Compiled, integer-indexed view of a Circuit. Nodes and gates get dense IDs,
+// connectivity is stored as CSR arrays and names are only kept in side tables
+// that are used when reading input or writing reports.
+class TimingGraph {
+private:
+    // Name <-> ID side tables. Names are interned for the whole process, so
+    // the reverse tables are hashed by Symbol and only grow with this graph;
+    // they hold INVALID_ID for names of removed objects.
+    vector<Symbol> nodeNames;
+    SymbolMap<NodeId> nodeIndex{INVALID_ID};
+    vector<Symbol> gateNames;
+    SymbolMap<GateId> gateIndex{INVALID_ID};
+
+    // Per-node data
+    vector<char> inputFlags;
+    vector<char> outputFlags;
+    vector<GateId> nodeDrivers;        // Gate that drives each node
+    vector<int> fanoutStarts;          // CSR: node -> gates it drives; each
+    vector<int> fanoutEnds;            // segment can be moved to the tail of
+    vector<int> fanoutLimits;          // fanoutGates when an edit outgrows it
+    vector<GateId> fanoutGates;
+    vector<double> fanoutArcs;         // Arc delay of each fanout pin, kept
+                                       // alongside fanoutGates with arcDelays
+
+    // Per-gate data
+    vector<GateType> gateTypes;
+    vector<NodeId> gateOutputs;
+    vector<int> faninOffsets;          // CSR: gate -> input nodes
+    vector<NodeId> faninNodes;
+    vector<double> gateDelays;
+    vector<double> arcDelays;          // Parallel to faninNodes; only allocated
+                                       // once a MACRO gate is added
+    vector<char> removedFlags;
+    vector<GateId> registerGates;      // Live DFF gates
+
+    vector<NodeId> primaryInputs;
+    vector<NodeId> primaryOutputs;
+    vector<NodeId> topoOrder;          // Nodes grouped by level
+    vector<int> nodeLevels;            // Longest gate count from an undriven node
+    vector<int> levelOffsets;          // CSR: level -> slice of topoOrder
+    vector<NodeId> stageNodes;         // Level order grouped by stage; empty
+                                       // when there are no registers
+    vector<int> stageOffsets;          // CSR: stage -> slice of stageNodes
+    GraphValidation validation;
+
+    bool finalized;
+    bool levelOrderStale;
+
+    void buildFanouts();
+    void buildTopologicalOrder();
+    void findLoops(const vector<int>& pending);
+    void checkNets();
+    void buildLevels();
+    void buildStages();
+    void appendFanout(NodeId node, GateId gate, double arc);
+    void eraseFanout(NodeId node, GateId gate, double arc);
+    double pinArc(GateId gate, int pin) const { return arcDelays.empty() ? 0.0 : arcDelays[faninOffsets[gate] + pin]; }
+    void raiseLevels(NodeId node);
+
+public:
+    TimingGraph() { clear(); }
+
+    // Construction
+    void clear();
+    void reserve(int nodeCount, int gateCount, int edgeCount);
+    NodeId addNode(string_view name, bool isInput = false, bool isOutput = false);
+    NodeId addNode(Symbol name, bool isInput = false, bool isOutput = false);
+    GateId addGate(string_view name, GateType type,
+                   const vector<NodeId>& inputs, NodeId output);
+    // inputDelays gives a MACRO gate one delay per input pin
+    GateId addGate(Symbol name, GateType type,
+                   const vector<NodeId>& inputs, NodeId output,
+                   const double* inputDelays = nullptr);
+    void finalize();
+    // Sets every gate's delay from a table indexed by GateType
+    void bindDelays(const vector<double>& typeDelays);
+
+    // Incremental edits after finalize(). They keep fanout lists and node
+    // levels valid; the level-grouped order is rebuilt by relevelize().
+    void setDelay(GateId gate, double delay) { gateDelays[gate] = delay; }
+    void setGateType(GateId gate, GateType type) { gateTypes[gate] = type; }
+    void removeGate(GateId gate);
+    void reconnectInput(GateId gate, int pin, NodeId node);
+    bool wouldCreateCycle(const vector<NodeId>& inputs, NodeId output) const;
+    bool isLevelOrderStale() const { return levelOrderStale; }
+    void relevelize();
+
+    // Sizes
+    int getNodeCount() const { return static_cast<int>(nodeNames.size()); }
+    int getGateCount() const { return static_cast<int>(gateNames.size()); }
+    int getEdgeCount() const { return static_cast<int>(faninNodes.size()); }
+
+    // Name lookups (I/O boundary only)
+    NodeId findNode(string_view name) const;
+    GateId findGate(string_view name) const;
+    const string& getNodeName(NodeId node) const { return StringInterner::global().text(nodeNames[node]); }
+    const string& getGateName(GateId gate) const { return StringInterner::global().text(gateNames[gate]); }
+    const string& getGateTypeName(GateId gate) const { return ::getGateTypeName(gateTypes[gate]); }
+
+    // Node accessors
+    bool isInput(NodeId node) const { return inputFlags[node] != 0; }
+    bool isOutput(NodeId node) const { return outputFlags[node] != 0; }
+    GateId getDriver(NodeId node) const { return nodeDrivers[node]; }
+    const GateId* fanoutBegin(NodeId node) const { return fanoutGates.data() + fanoutStarts[node]; }
+    const GateId* fanoutEnd(NodeId node) const { return fanoutGates.data() + fanoutEnds[node]; }
+    int getFanoutCount(NodeId node) const { return fanoutEnds[node] - fanoutStarts[node]; }
+
+    // Gate accessors
+    GateType getGateType(GateId gate) const { return gateTypes[gate]; }
+    NodeId getOutput(GateId gate) const { return gateOutputs[gate]; }
+    const NodeId* faninBegin(GateId gate) const { return faninNodes.data() + faninOffsets[gate]; }
+    const NodeId* faninEnd(GateId gate) const { return faninNodes.data() + faninOffsets[gate + 1]; }
+    int getFaninCount(GateId gate) const { return faninOffsets[gate + 1] - faninOffsets[gate]; }
+    double getDelay(GateId gate) const { return gateDelays[gate]; }
+    bool isRemoved(GateId gate) const { return removedFlags[gate] != 0; }
+    NodeId getInput(GateId gate, int pin) const { return faninNodes[faninOffsets[gate] + pin]; }
+
+    // Timing arcs. A MACRO gate (an instance output of an extracted model)
+    // adds a delay per input pin on top of its gate delay; every other gate
+    // delays all inputs alike. getArcDelay is the extra delay from one input,
+    // taking the worst pin if the input is connected twice, and 0 for other
+    // gates; getStageDelay adds the gate delay. getFanoutDelay is the same
+    // stage delay for one fanoutBegin(node)..fanoutEnd(node) entry without
+    // searching the gate's pins.
+    bool hasArcDelays() const { return !arcDelays.empty(); }
+    bool hasArcDelays(GateId gate) const { return !arcDelays.empty() && gateTypes[gate] == GateType::MACRO; }
+    const double* arcDelaysBegin(GateId gate) const { return arcDelays.data() + faninOffsets[gate]; }
+    double getArcDelay(GateId gate, NodeId input) const;
+    double getStageDelay(GateId gate, NodeId input) const {
+        return hasArcDelays(gate) ? gateDelays[gate] + getArcDelay(gate, input) : gateDelays[gate];
+    }
+    double getFanoutArc(const GateId* fanout) const {
+        return fanoutArcs.empty() ? 0.0 : fanoutArcs[fanout - fanoutGates.data()];
+    }
+    double getFanoutDelay(const GateId* fanout) const { return gateDelays[*fanout] + getFanoutArc(fanout); }
+
+    const vector<NodeId>& getPrimaryInputs() const { return primaryInputs; }
+    const vector<NodeId>& getPrimaryOutputs() const { return primaryOutputs; }
+    const vector<NodeId>& getTopologicalOrder() const { return topoOrder; }
+    // Loops and net problems, from the same pass that builds the order
+    const GraphValidation& getValidation() const { return validation; }
+
+    // Registers cut the graph: a DFF's output starts paths, launched at its
+    // clock-to-Q delay, and its data input ends them with a setup check. No
+    // level, cycle or propagation follows the D -> Q edge, so feedback
+    // through registers is not a combinational loop.
+    bool isRegister(GateId gate) const { return gateTypes[gate] == GateType::DFF; }
+    bool hasRegisters() const { return !registerGates.empty(); }
+    const vector<GateId>& getRegisters() const { return registerGates; }
+    bool isRegisterInput(NodeId node) const;
+    double getLaunchDelay(NodeId node) const {
+        GateId driver = nodeDrivers[node];
+        return driver != INVALID_ID && isRegister(driver) ? gateDelays[driver] : 0.0;
+    }
+    // Primary outputs, then register data inputs that are not outputs
+    vector<NodeId> getEndpoints() const;
+    // Latest arrival an endpoint's setup check accepts
+    double getEndpointRequired(NodeId endpoint, double clockPeriod, double setupTime) const;
+
+    // Levelization: nodes on a level only depend on nodes of lower levels, so
+    // every level can be processed in parallel. Level 0 holds undriven nodes
+    // and register outputs.
+    int getLevelCount() const { return static_cast<int>(levelOffsets.size()) - 1; }
+    int getLevel(NodeId node) const { return nodeLevels[node]; }
+    const NodeId* levelBegin(int level) const { return topoOrder.data() + levelOffsets[level]; }
+    const NodeId* levelEnd(int level) const { return topoOrder.data() + levelOffsets[level + 1]; }
+    int getLevelSize(int level) const { return levelOffsets[level + 1] - levelOffsets[level]; }
+
+    // Stages: the pieces left once the graph is cut at its registers, i.e.
+    // the register-to-register (and input/output) logic. Each stage lists its
+    // nodes of level 1 and up in level order; sources (level 0) are in none,
+    // since they may feed several. No arrival or required time computed in
+    // one stage is read by another, so stages can be propagated as
+    // independent tasks. Without registers all of levels 1 and up are one
+    // stage.
+    int getStageCount() const { return static_cast<int>(stageOffsets.size()) - 1; }
+    const NodeId* stageBegin(int stage) const { return stageData() + stageOffsets[stage]; }
+    const NodeId* stageEnd(int stage) const { return stageData() + stageOffsets[stage + 1]; }
+    int getStageSize(int stage) const { return stageOffsets[stage + 1] - stageOffsets[stage]; }
+
+private:
+    // Without registers the single stage is the tail of the level order
+    const NodeId* stageData() const {
+        return stageNodes.empty() ? topoOrder.data() + topoOrder.size() - stageOffsets.back() : stageNodes.data();
+    }
+};
+
+// ===== Implementation =======================================================
+
+void TimingGraph::clear() {
+    nodeNames.clear();
+    nodeIndex.clear();
+    gateNames.clear();
+    gateIndex.clear();
+    inputFlags.clear();
+    outputFlags.clear();
+    nodeDrivers.clear();
+    fanoutStarts.clear();
+    fanoutEnds.clear();
+    fanoutLimits.clear();
+    fanoutGates.clear();
+    fanoutArcs.clear();
+    gateTypes.clear();
+    gateOutputs.clear();
+    faninOffsets.assign(1, 0);
+    faninNodes.clear();
+    gateDelays.clear();
+    arcDelays.clear();
+    removedFlags.clear();
+    registerGates.clear();
+    primaryInputs.clear();
+    primaryOutputs.clear();
+    topoOrder.clear();
+    nodeLevels.clear();
+    levelOffsets.assign(1, 0);
+    stageNodes.clear();
+    stageOffsets.assign(1, 0);
+    validation = GraphValidation();
+    finalized = false;
+    levelOrderStale = false;
+}
+
+void TimingGraph::reserve(int nodeCount, int gateCount, int edgeCount) {
+    // Bulk loaders know the final sizes; this saves regrowing the tables
+    nodeNames.reserve(nodeCount);
+    nodeIndex.reserve(nodeCount);
+    gateIndex.reserve(gateCount);
+    inputFlags.reserve(nodeCount);
+    outputFlags.reserve(nodeCount);
+    nodeDrivers.reserve(nodeCount);
+    gateNames.reserve(gateCount);
+    gateTypes.reserve(gateCount);
+    gateOutputs.reserve(gateCount);
+    faninOffsets.reserve(gateCount + 1);
+    gateDelays.reserve(gateCount);
+    removedFlags.reserve(gateCount);
+    faninNodes.reserve(edgeCount);
+}
+
+NodeId TimingGraph::addNode(string_view name, bool isInput, bool isOutput) {
+    return addNode(StringInterner::global().intern(name), isInput, isOutput);
+}
+
+NodeId TimingGraph::addNode(Symbol name, bool isInput, bool isOutput) {
+    NodeId& entry = nodeIndex[name];
+    if (entry != INVALID_ID) return entry;
+
+    NodeId id = getNodeCount();
+    entry = id;
+    nodeNames.push_back(name);
+    inputFlags.push_back(isInput ? 1 : 0);
+    outputFlags.push_back(isOutput ? 1 : 0);
+    nodeDrivers.push_back(INVALID_ID);
+    if (isInput) primaryInputs.push_back(id);
+    if (isOutput) primaryOutputs.push_back(id);
+
+    if (finalized) {
+        int tail = static_cast<int>(fanoutGates.size());
+        fanoutStarts.push_back(tail);
+        fanoutEnds.push_back(tail);
+        fanoutLimits.push_back(tail);
+        nodeLevels.push_back(0);
+        levelOrderStale = true;
+    }
+    return id;
+}
+
+GateId TimingGraph::addGate(string_view name, GateType type,
+                            const vector<NodeId>& inputs, NodeId output) {
+    return addGate(StringInterner::global().intern(name), type, inputs, output);
+}
+
+GateId TimingGraph::addGate(Symbol name, GateType type,
+                            const vector<NodeId>& inputs, NodeId output,
+                            const double* inputDelays) {
+    GateId id = getGateCount();
+    gateIndex[name] = id;
+    gateNames.push_back(name);
+    gateTypes.push_back(type);
+    gateOutputs.push_back(output);
+    if (inputDelays && arcDelays.empty()) {
+        arcDelays.assign(faninNodes.size(), 0.0);
+        fanoutArcs.assign(fanoutGates.size(), 0.0);
+    }
+    faninNodes.insert(faninNodes.end(), inputs.begin(), inputs.end());
+    faninOffsets.push_back(static_cast<int>(faninNodes.size()));
+    if (inputDelays) {
+        arcDelays.insert(arcDelays.end(), inputDelays, inputDelays + inputs.size());
+    } else if (!arcDelays.empty()) {
+        arcDelays.resize(faninNodes.size(), 0.0);
+    }
+    gateDelays.push_back(0.0);
+    removedFlags.push_back(0);
+    if (isRegister(id)) registerGates.push_back(id);
+
+    // Like Node::setFanin, the last gate written to a node wins
+    nodeDrivers[output] = id;
+
+    if (finalized) {
+        for (size_t pin = 0; pin < inputs.size(); ++pin) {
+            appendFanout(inputs[pin], id, inputDelays ? inputDelays[pin] : 0.0);
+        }
+        raiseLevels(output);
+        levelOrderStale = true;
+    }
+    return id;
+}
+
+void TimingGraph::finalize() {
+    buildFanouts();
+    buildTopologicalOrder();
+    buildLevels();
+    buildStages();
+    finalized = true;
+    levelOrderStale = false;
+}
+
+void TimingGraph::relevelize() {
+    buildTopologicalOrder();
+    buildLevels();
+    buildStages();
+    levelOrderStale = false;
+}
+
+void TimingGraph::buildFanouts() {
+    int nodeCount = getNodeCount();
+    vector<int> offsets(nodeCount + 1, 0);
+    for (GateId gate = 0; gate < getGateCount(); ++gate) {
+        if (removedFlags[gate]) continue;
+        for (const NodeId* in = faninBegin(gate); in != faninEnd(gate); ++in) {
+            offsets[*in + 1]++;
+        }
+    }
+    for (int i = 0; i < nodeCount; ++i) {
+        offsets[i + 1] += offsets[i];
+    }
+
+    fanoutGates.assign(offsets[nodeCount], INVALID_ID);
+    fanoutStarts.assign(offsets.begin(), offsets.end() - 1);
+    fanoutEnds = fanoutStarts;
+    for (GateId gate = 0; gate < getGateCount(); ++gate) {
+        if (removedFlags[gate]) continue;
+        for (const NodeId* in = faninBegin(gate); in != faninEnd(gate); ++in) {
+            fanoutGates[fanoutEnds[*in]++] = gate;
+        }
+    }
+    fanoutLimits = fanoutEnds;
+
+    if (arcDelays.empty()) return;
+    fanoutArcs.assign(fanoutGates.size(), 0.0);
+    vector<int> cursor(fanoutStarts);
+    for (GateId gate = 0; gate < getGateCount(); ++gate) {
+        if (removedFlags[gate]) continue;
+        const double* arc = arcDelaysBegin(gate);
+        for (const NodeId* in = faninBegin(gate); in != faninEnd(gate); ++in, ++arc) {
+            fanoutArcs[cursor[*in]++] = *arc;
+        }
+    }
+}
+
+void TimingGraph::appendFanout(NodeId node, GateId gate, double arc) {
+    if (fanoutEnds[node] == fanoutLimits[node]) {
+        // Move the segment to the tail with room to grow; the old slots are
+        // simply abandoned until the next finalize()
+        int count = getFanoutCount(node);
+        int start = static_cast<int>(fanoutGates.size());
+        int capacity = max(4, count * 2);
+        fanoutGates.resize(start + capacity, INVALID_ID);
+        copy(fanoutGates.begin() + fanoutStarts[node],
+             fanoutGates.begin() + fanoutEnds[node],
+             fanoutGates.begin() + start);
+        if (!arcDelays.empty()) {
+            fanoutArcs.resize(start + capacity, 0.0);
+            copy(fanoutArcs.begin() + fanoutStarts[node],
+                 fanoutArcs.begin() + fanoutEnds[node],
+                 fanoutArcs.begin() + start);
+        }
+        fanoutStarts[node] = start;
+        fanoutEnds[node] = start + count;
+        fanoutLimits[node] = start + capacity;
+    }
+    if (!arcDelays.empty()) fanoutArcs[fanoutEnds[node]] = arc;
+    fanoutGates[fanoutEnds[node]++] = gate;
+}
+
+void TimingGraph::eraseFanout(NodeId node, GateId gate, double arc) {
+    // With timing arcs the arc picks out the pin when a gate uses a node twice
+    bool arcs = !arcDelays.empty();
+    for (int i = fanoutStarts[node]; i < fanoutEnds[node]; ++i) {
+        if (fanoutGates[i] == gate && (!arcs || fanoutArcs[i] == arc)) {
+            fanoutGates[i] = fanoutGates[--fanoutEnds[node]];
+            if (arcs) fanoutArcs[i] = fanoutArcs[fanoutEnds[node]];
+            return;
+        }
+    }
+}
+
+void TimingGraph::raiseLevels(NodeId node) {
+    // Restore level(node) > level(fanin) downstream of an edit; levels never
+    // need to drop for that to hold, so removals leave them alone
+    vector<NodeId> pending(1, node);
+    while (!pending.empty()) {
+        NodeId current = pending.back();
+        pending.pop_back();
+        GateId driver = nodeDrivers[current];
+        if (driver == INVALID_ID || isRegister(driver)) continue;
+
+        int level = 0;
+        for (const NodeId* in = faninBegin(driver); in != faninEnd(driver); ++in) {
+            level = max(level, nodeLevels[*in] + 1);
+        }
+        if (level <= nodeLevels[current]) continue;
+        nodeLevels[current] = level;
+
+        for (const GateId* g = fanoutBegin(current); g != fanoutEnd(current); ++g) {
+            if (nodeDrivers[gateOutputs[*g]] == *g) pending.push_back(gateOutputs[*g]);
+        }
+    }
+}
+
+void TimingGraph::removeGate(GateId gate) {
+    for (int pin = 0; pin < getFaninCount(gate); ++pin) {
+        eraseFanout(getInput(gate, pin), gate, pinArc(gate, pin));
+    }
+    NodeId output = gateOutputs[gate];
+    if (nodeDrivers[output] == gate) nodeDrivers[output] = INVALID_ID;
+
+    if (gateIndex.find(gateNames[gate]) == gate) gateIndex[gateNames[gate]] = INVALID_ID;
+    if (isRegister(gate)) {
+        registerGates.erase(find(registerGates.begin(), registerGates.end(), gate));
+    }
+    removedFlags[gate] = 1;
+    levelOrderStale = true;
+}
+
+void TimingGraph::reconnectInput(GateId gate, int pin, NodeId node) {
+    NodeId& slot = faninNodes[faninOffsets[gate] + pin];
+    eraseFanout(slot, gate, pinArc(gate, pin));
+    slot = node;
+    appendFanout(node, gate, pinArc(gate, pin));
+
+    NodeId output = gateOutputs[gate];
+    if (nodeDrivers[output] == gate) raiseLevels(output);
+    levelOrderStale = true;
+}
+
+bool TimingGraph::wouldCreateCycle(const vector<NodeId>& inputs, NodeId output) const {
+    // A loop closes if the output already reaches one of the inputs. Anything
+    // that reaches an input sits on a lower level, which bounds the search.
+    int maxLevel = -1;
+    for (NodeId input : inputs) {
+        if (input == output) return true;
+        maxLevel = max(maxLevel, nodeLevels[input]);
+    }
+    if (output >= static_cast<int>(nodeLevels.size()) || nodeLevels[output] >= maxLevel) {
+        return false;
+    }
+
+    vector<NodeId> pending(1, output);
+    unordered_set<NodeId> visited;
+    while (!pending.empty()) {
+        NodeId current = pending.back();
+        pending.pop_back();
+        for (const GateId* g = fanoutBegin(current); g != fanoutEnd(current); ++g) {
+            NodeId next = gateOutputs[*g];
+            if (nodeDrivers[next] != *g || isRegister(*g) || nodeLevels[next] > maxLevel) continue;
+            if (find(inputs.begin(), inputs.end(), next) != inputs.end()) return true;
+            if (visited.insert(next).second) pending.push_back(next);
+        }
+    }
+    return false;
+}
+
+void TimingGraph::buildTopologicalOrder() {
+    // Kahn's algorithm over nodes; a node is ready once every fanin of its
+    // driving gate is ready. Nodes on a cycle never become ready, and register
+    // outputs are ready from the start.
+    int nodeCount = getNodeCount();
+    vector<int> pending(nodeCount, 0);
+    for (NodeId node = 0; node < nodeCount; ++node) {
+        GateId driver = nodeDrivers[node];
+        if (driver != INVALID_ID && !isRegister(driver)) pending[node] = getFaninCount(driver);
+    }
+
+    topoOrder.clear();
+    topoOrder.reserve(nodeCount);
+    for (NodeId node = 0; node < nodeCount; ++node) {
+        if (pending[node] == 0) topoOrder.push_back(node);
+    }
+
+    for (size_t head = 0; head < topoOrder.size(); ++head) {
+        NodeId node = topoOrder[head];
+        for (const GateId* g = fanoutBegin(node); g != fanoutEnd(node); ++g) {
+            NodeId output = gateOutputs[*g];
+            if (nodeDrivers[output] != *g || isRegister(*g)) continue;
+            if (--pending[output] == 0) topoOrder.push_back(output);
+        }
+    }
+
+    // Whatever never became ready is on a loop or behind one
+    findLoops(pending);
+    checkNets();
+}
+
+void TimingGraph::findLoops(const vector<int>& pending) {
+    validation.loops.clear();
+    validation.behindLoops.clear();
+    if (topoOrder.size() == nodeDrivers.size()) return;
+
+    // Tarjan's algorithm, iteratively, over the nodes Kahn's algorithm left
+    // behind; every edge between them is a combinational fanout
+    int nodeCount = getNodeCount();
+    vector<int> index(nodeCount, -1);
+    vector<int> lowLink(nodeCount, 0);
+    vector<char> onStack(nodeCount, 0);
+    vector<NodeId> members;
+    vector<pair<NodeId, int>> calls;    // Node and its next fanout position
+    int counter = 0;
+    auto next = [&](NodeId node, int& position) {
+        // Next unordered combinational fanout of a node, or INVALID_ID
+        while (fanoutStarts[node] + position < fanoutEnds[node]) {
+            GateId gate = fanoutGates[fanoutStarts[node] + position++];
+            NodeId output = gateOutputs[gate];
+            if (nodeDrivers[output] == gate && !isRegister(gate) && pending[output] > 0) return output;
+        }
+        return INVALID_ID;
+    };
+    for (NodeId root = 0; root < nodeCount; ++root) {
+        if (pending[root] == 0 || index[root] >= 0) continue;
+        index[root] = lowLink[root] = counter++;
+        members.push_back(root);
+        onStack[root] = 1;
+        calls.push_back({root, 0});
+        while (!calls.empty()) {
+            NodeId node = calls.back().first;
+            NodeId successor = next(node, calls.back().second);
+            if (successor != INVALID_ID) {
+                if (index[successor] < 0) {
+                    index[successor] = lowLink[successor] = counter++;
+                    members.push_back(successor);
+                    onStack[successor] = 1;
+                    calls.push_back({successor, 0});
+                } else if (onStack[successor]) {
+                    lowLink[node] = min(lowLink[node], index[successor]);
+                }
+                continue;
+            }
+            calls.pop_back();
+            if (!calls.empty()) {
+                NodeId caller = calls.back().first;
+                lowLink[caller] = min(lowLink[caller], lowLink[node]);
+            }
+            if (lowLink[node] != index[node]) continue;
+
+            // Node is the root of a component; a single node only loops if
+            // its driver reads it
+            vector<NodeId> component;
+            NodeId member;
+            do {
+                member = members.back();
+                members.pop_back();
+                onStack[member] = 0;
+                component.push_back(member);
+            } while (member != node);
+            GateId driver = nodeDrivers[node];
+            bool selfLoop = component.size() == 1 &&
+                            find(faninBegin(driver), faninEnd(driver), node) != faninEnd(driver);
+            if (component.size() > 1 || selfLoop) {
+                sort(component.begin(), component.end());
+                validation.loops.push_back(move(component));
+            } else {
+                validation.behindLoops.push_back(node);
+            }
+        }
+    }
+    sort(validation.loops.begin(), validation.loops.end());
+    sort(validation.behindLoops.begin(), validation.behindLoops.end());
+}
+
+void TimingGraph::checkNets() {
+    validation.multiplyDriven.clear();
+    validation.undriven.clear();
+    validation.dangling.clear();
+    int nodeCount = getNodeCount();
+    vector<int> drivers(nodeCount, 0);
+    for (GateId gate = 0; gate < getGateCount(); ++gate) {
+        if (!removedFlags[gate]) drivers[gateOutputs[gate]]++;
+    }
+    for (NodeId node = 0; node < nodeCount; ++node) {
+        bool read = getFanoutCount(node) > 0 || isOutput(node);
+        if (drivers[node] > 1) validation.multiplyDriven.push_back(node);
+        if (nodeDrivers[node] == INVALID_ID) {
+            if (read && !isInput(node)) validation.undriven.push_back(node);
+        } else if (!read) {
+            validation.dangling.push_back(node);
+        }
+    }
+}
+
+void TimingGraph::buildLevels() {
+    // Nodes on a combinational cycle are left out of the order and keep -1
+    nodeLevels.assign(getNodeCount(), -1);
+    int levelCount = 0;
+    for (NodeId node : topoOrder) {
+        int level = 0;
+        GateId driver = nodeDrivers[node];
+        if (driver != INVALID_ID && !isRegister(driver)) {
+            for (const NodeId* in = faninBegin(driver); in != faninEnd(driver); ++in) {
+                level = max(level, nodeLevels[*in] + 1);
+            }
+        }
+        nodeLevels[node] = level;
+        levelCount = max(levelCount, level + 1);
+    }
+
+    // Counting sort of the topological order by level
+    levelOffsets.assign(levelCount + 1, 0);
+    for (NodeId node : topoOrder) {
+        levelOffsets[nodeLevels[node] + 1]++;
+    }
+    for (int level = 0; level < levelCount; ++level) {
+        levelOffsets[level + 1] += levelOffsets[level];
+    }
+    vector<int> cursor(levelOffsets.begin(), levelOffsets.end() - 1);
+    vector<NodeId> levelized(topoOrder.size());
+    for (NodeId node : topoOrder) {
+        levelized[cursor[nodeLevels[node]]++] = node;
+    }
+    topoOrder.swap(levelized);
+}
+
+void TimingGraph::buildStages() {
+    stageNodes.clear();
+    stageOffsets.assign(1, 0);
+    int sourceCount = getLevelCount() > 1 ? levelOffsets[1] : static_cast<int>(topoOrder.size());
+    if (registerGates.empty()) {
+        stageOffsets.push_back(static_cast<int>(topoOrder.size()) - sourceCount);
+        return;
+    }
+
+    // Union-find over the combinational edges between computed nodes. Edges
+    // into registers are never followed and sources are left out, so a
+    // shared input or register output does not merge the stages it feeds.
+    vector<NodeId> parent(getNodeCount());
+    for (NodeId node = 0; node < getNodeCount(); ++node) parent[node] = node;
+    auto root = [&](NodeId node) {
+        while (parent[node] != node) {
+            parent[node] = parent[parent[node]];
+            node = parent[node];
+        }
+        return node;
+    };
+    for (size_t i = sourceCount; i < topoOrder.size(); ++i) {
+        NodeId node = topoOrder[i];
+        GateId driver = nodeDrivers[node];
+        for (const NodeId* in = faninBegin(driver); in != faninEnd(driver); ++in) {
+            if (nodeLevels[*in] == 0) continue;
+            NodeId a = root(node), b = root(*in);
+            if (a != b) parent[max(a, b)] = min(a, b);
+        }
+    }
+
+    // Stages are numbered in order of their first node; a stable bucket sort
+    // of the level order keeps each stage's nodes in level order
+    vector<int> stageOf(getNodeCount(), -1);
+    vector<int> sizes;
+    for (size_t i = sourceCount; i < topoOrder.size(); ++i) {
+        NodeId r = root(topoOrder[i]);
+        if (stageOf[r] < 0) {
+            stageOf[r] = static_cast<int>(sizes.size());
+            sizes.push_back(0);
+        }
+        sizes[stageOf[r]]++;
+    }
+    stageOffsets.resize(sizes.size() + 1);
+    for (size_t stage = 0; stage < sizes.size(); ++stage) {
+        stageOffsets[stage + 1] = stageOffsets[stage] + sizes[stage];
+    }
+    vector<int> cursor(stageOffsets.begin(), stageOffsets.end() - 1);
+    stageNodes.resize(topoOrder.size() - sourceCount);
+    for (size_t i = sourceCount; i < topoOrder.size(); ++i) {
+        stageNodes[cursor[stageOf[root(topoOrder[i])]]++] = topoOrder[i];
+    }
+}
+
+bool TimingGraph::isRegisterInput(NodeId node) const {
+    for (const GateId* g = fanoutBegin(node); g != fanoutEnd(node); ++g) {
+        if (isRegister(*g) && nodeDrivers[gateOutputs[*g]] == *g) return true;
+    }
+    return false;
+}
+
+vector<NodeId> TimingGraph::getEndpoints() const {
+    vector<NodeId> endpoints(primaryOutputs);
+    if (registerGates.empty()) return endpoints;
+
+    vector<char> listed(getNodeCount(), 0);
+    for (NodeId output : primaryOutputs) listed[output] = 1;
+    for (GateId reg : registerGates) {
+        NodeId input = getInput(reg, 0);
+        if (nodeDrivers[gateOutputs[reg]] != reg || listed[input]) continue;
+        listed[input] = 1;
+        endpoints.push_back(input);
+    }
+    return endpoints;
+}
+
+double TimingGraph::getEndpointRequired(NodeId endpoint, double clockPeriod, double setupTime) const {
+    double required = isOutput(endpoint) ? clockPeriod : numeric_limits<double>::infinity();
+    return isRegisterInput(endpoint) ? min(required, clockPeriod - setupTime) : required;
+}
+
+void TimingGraph::bindDelays(const vector<double>& typeDelays) {
+    for (GateId gate = 0; gate < getGateCount(); ++gate) {
+        gateDelays[gate] = typeDelays[static_cast<int>(gateTypes[gate])];
+    }
+}
+
+double TimingGraph::getArcDelay(GateId gate, NodeId input) const {
+    if (!hasArcDelays(gate)) return 0.0;
+    const double* arc = arcDelaysBegin(gate);
+    double worst = -numeric_limits<double>::infinity();
+    for (const NodeId* in = faninBegin(gate); in != faninEnd(gate); ++in, ++arc) {
+        if (*in == input) worst = max(worst, *arc);
+    }
+    return worst;
+}
+
+NodeId TimingGraph::findNode(string_view name) const {
+    return nodeIndex.find(StringInterner::global().find(name));
+}
+
+GateId TimingGraph::findGate(string_view name) const {
+    return gateIndex.find(StringInterner::global().find(name));
+}
+
+#endif // TIMING_GRAPH_H
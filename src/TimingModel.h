@@ -0,0 +1,239 @@
+#ifndef TIMING_MODEL_H
+#define TIMING_MODEL_H
+
+#include <algorithm>
+#include <charconv>
+#include <fstream>
+#include <limits>
+#include <sstream>
+#include <stdexcept>
+#include <string>
+#include <vector>
+#include "SimdDouble.h"
+#include "TimingGraph.h"
+
+using namespace std;
+
+// Longest delay from one model input to one model output
+struct TimingArc {
+    int input;          // Index into getInputs()
+    int output;         // Index into getOutputs()
+    double delay;
+};
+
+// Extracted timing model of a combinational block: its ports and the worst
+// delay of every input -> output pair that is connected at all. A block is
+// analyzed once, and each instance of it in a larger design then costs one
+// MACRO gate per output with one arc per connected input, whatever the size
+// of the block. Models are plain text:
+//
+//   # Timing model of adder_circuit.txt with gate_delays.txt
+//   MODEL adder_circuit
+//   INPUT A0 A1 B0 B1 CIN
+//   OUTPUT S0 S1 COUT
+//   ARC A0 S0 0.25
+//
+// and a netlist instantiates one with its outputs first, like a GATE line:
+//
+//   MODEL adder models/adder.model
+//   INSTANCE adder U7 S0 S1 COUT A0 A1 B0 B1 CIN
+class TimingModel {
+private:
+    string name;
+    vector<string> inputs;
+    vector<string> outputs;
+    vector<TimingArc> arcs;         // Grouped by output, inputs ascending
+    vector<int> outputArcStarts;    // CSR: output -> slice of arcs
+
+    // Inputs timed together, one SIMD lane each
+    static const int EXTRACT_LANES = 8;
+
+    void indexArcs();
+
+public:
+    // Worst arcs through an analyzed graph whose delays are bound; the block's
+    // primary inputs and outputs become the model's ports
+    static TimingModel extract(const TimingGraph& graph, const string& name);
+    static TimingModel load(const string& filename);
+    void save(const string& filename, const string& comment) const;
+
+    const string& getName() const { return name; }
+    const vector<string>& getInputs() const { return inputs; }
+    const vector<string>& getOutputs() const { return outputs; }
+    const vector<TimingArc>& getArcs() const { return arcs; }
+    const TimingArc* arcsBegin(int output) const { return arcs.data() + outputArcStarts[output]; }
+    const TimingArc* arcsEnd(int output) const { return arcs.data() + outputArcStarts[output + 1]; }
+    int getPinCount() const { return static_cast<int>(outputs.size() + inputs.size()); }
+};
+
+// ===== Implementation =======================================================
+
+void TimingModel::indexArcs() {
+    sort(arcs.begin(), arcs.end(), [](const TimingArc& a, const TimingArc& b) {
+        return a.output != b.output ? a.output < b.output : a.input < b.input;
+    });
+    outputArcStarts.assign(outputs.size() + 1, 0);
+    for (const TimingArc& arc : arcs) {
+        outputArcStarts[arc.output + 1]++;
+    }
+    for (size_t i = 0; i < outputs.size(); ++i) {
+        outputArcStarts[i + 1] += outputArcStarts[i];
+    }
+}
+
+TimingModel TimingModel::extract(const TimingGraph& graph, const string& modelName) {
+    // Models describe combinational blocks; a register's setup check has no
+    // input-to-output arc
+    if (graph.hasRegisters()) {
+        throw runtime_error("Cannot extract a timing model of " + modelName + ": it contains registers");
+    }
+    TimingModel model;
+    model.name = modelName;
+
+    // Ports in netlist order; a name listed twice is one port
+    vector<NodeId> inputIds, outputIds;
+    vector<char> listed(graph.getNodeCount(), 0);
+    for (NodeId id : graph.getPrimaryInputs()) {
+        if (listed[id] & 1) continue;
+        listed[id] |= 1;
+        inputIds.push_back(id);
+        model.inputs.push_back(graph.getNodeName(id));
+    }
+    for (NodeId id : graph.getPrimaryOutputs()) {
+        if (listed[id] & 2) continue;
+        if (graph.getLevel(id) < 0) {
+            throw runtime_error("Output " + graph.getNodeName(id) + " is on a combinational loop");
+        }
+        listed[id] |= 2;
+        outputIds.push_back(id);
+        model.outputs.push_back(graph.getNodeName(id));
+    }
+
+    // Arrival times from a group of inputs at once, one lane per input;
+    // -inf marks nodes the lane's input does not reach
+    static_assert(EXTRACT_LANES % SIMD_WIDTH == 0, "lanes are whole SIMD vectors");
+    const double unreached = -numeric_limits<double>::infinity();
+    vector<double> arrival(static_cast<size_t>(graph.getNodeCount()) * EXTRACT_LANES);
+    auto lanesOf = [&](NodeId node) { return arrival.data() + static_cast<size_t>(node) * EXTRACT_LANES; };
+
+    for (size_t first = 0; first < inputIds.size(); first += EXTRACT_LANES) {
+        int laneCount = static_cast<int>(min<size_t>(EXTRACT_LANES, inputIds.size() - first));
+        fill(arrival.begin(), arrival.end(), unreached);
+        for (int lane = 0; lane < laneCount; ++lane) {
+            lanesOf(inputIds[first + lane])[lane] = 0.0;
+        }
+
+        for (int level = 1; level < graph.getLevelCount(); ++level) {
+            for (const NodeId* node = graph.levelBegin(level); node != graph.levelEnd(level); ++node) {
+                GateId driver = graph.getDriver(*node);
+                const NodeId* in = graph.faninBegin(driver);
+                const NodeId* inEnd = graph.faninEnd(driver);
+                double* out = lanesOf(*node);
+                if (graph.hasArcDelays(driver)) {
+                    const double* arc = graph.arcDelaysBegin(driver);
+                    for (int lane = 0; lane < EXTRACT_LANES; ++lane) {
+                        double latest = unreached;
+                        for (int pin = 0; in + pin != inEnd; ++pin) {
+                            latest = max(latest, lanesOf(in[pin])[lane] + arc[pin]);
+                        }
+                        out[lane] = latest + graph.getDelay(driver);
+                    }
+                    continue;
+                }
+                SimdDouble delay = simdBroadcast(graph.getDelay(driver));
+                for (int lane = 0; lane < EXTRACT_LANES; lane += SIMD_WIDTH) {
+                    SimdDouble latest = simdLoad(lanesOf(*in) + lane);
+                    for (const NodeId* pin = in + 1; pin != inEnd; ++pin) {
+                        latest = simdMax(latest, simdLoad(lanesOf(*pin) + lane));
+                    }
+                    simdStore(out + lane, simdAdd(latest, delay));
+                }
+            }
+        }
+
+        for (size_t output = 0; output < outputIds.size(); ++output) {
+            const double* lanes = lanesOf(outputIds[output]);
+            for (int lane = 0; lane < laneCount; ++lane) {
+                if (lanes[lane] == unreached) continue;
+                model.arcs.push_back({static_cast<int>(first + lane), static_cast<int>(output), lanes[lane]});
+            }
+        }
+    }
+
+    model.indexArcs();
+    return model;
+}
+
+TimingModel TimingModel::load(const string& filename) {
+    ifstream file(filename);
+    if (!file.is_open()) {
+        throw runtime_error("Cannot open timing model: " + filename);
+    }
+
+    TimingModel model;
+    auto portIndex = [&](const vector<string>& ports, const string& port, const string& kind) {
+        auto it = find(ports.begin(), ports.end(), port);
+        if (it == ports.end()) {
+            throw runtime_error("Timing model " + filename + ": unknown " + kind + " " + port);
+        }
+        return static_cast<int>(it - ports.begin());
+    };
+
+    string line;
+    while (getline(file, line)) {
+        if (line.empty() || line[0] == '#') continue;
+        istringstream iss(line);
+        string command, token;
+        iss >> command;
+        if (command == "MODEL") {
+            iss >> model.name;
+        } else if (command == "INPUT") {
+            while (iss >> token) model.inputs.push_back(token);
+        } else if (command == "OUTPUT") {
+            while (iss >> token) model.outputs.push_back(token);
+        } else if (command == "ARC") {
+            string input, output;
+            TimingArc arc;
+            if (!(iss >> input >> output >> arc.delay)) {
+                throw runtime_error("Timing model " + filename + ": bad arc: " + line);
+            }
+            arc.input = portIndex(model.inputs, input, "input");
+            arc.output = portIndex(model.outputs, output, "output");
+            model.arcs.push_back(arc);
+        }
+    }
+    if (model.name.empty()) {
+        throw runtime_error("Timing model " + filename + " has no MODEL line");
+    }
+
+    model.indexArcs();
+    return model;
+}
+
+void TimingModel::save(const string& filename, const string& comment) const {
+    ofstream file(filename);
+    if (!file.is_open()) {
+        throw runtime_error("Cannot write timing model: " + filename);
+    }
+
+    file << "# " << comment << "\n";
+    file << "MODEL " << name << "\n";
+    file << "INPUT";
+    for (const string& input : inputs) file << ' ' << input;
+    file << "\nOUTPUT";
+    for (const string& output : outputs) file << ' ' << output;
+    file << "\n";
+
+    // Shortest text that reads back to the same double
+    char digits[32];
+    for (const TimingArc& arc : arcs) {
+        auto result = to_chars(digits, digits + sizeof(digits), arc.delay);
+        file << "ARC " << inputs[arc.input] << ' ' << outputs[arc.output] << ' '
+             << string_view(digits, result.ptr - digits) << "\n";
+    }
+    if (!file) {
+        throw runtime_error("Cannot write timing model: " + filename);
+    }
+}
+
+#endif // TIMING_MODEL_H
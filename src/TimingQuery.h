@@ -0,0 +1,239 @@
+#ifndef TIMING_QUERY_H
+#define TIMING_QUERY_H
+
+#include <algorithm>
+#include <limits>
+#include <utility>
+#include <vector>
+#include "TimingGraph.h"
+
+using namespace std;
+
+// Timing of one node, as analyze() would store it
+struct NodeTiming {
+    double arrival;
+    double required;
+    double slack;
+    double earlyArrival;
+    double holdRequired;
+    double holdSlack;
+};
+
+// On-demand timing of single nodes. A node's arrival time depends only on
+// its transitive fanin cone and its required time only on its fanout cone,
+// so a query times just those two cones, depth first, and stops wherever an
+// earlier query already got to. Everything timed is memoized, so a session
+// of queries around one endpoint costs about as much as its cones, however
+// large the netlist is. The arithmetic is the one of arriveNodes and
+// requireNodes in TimingAnalyzer, fanin for fanin, so the results are the
+// same bits analyze() gives; nodes on combinational loops (level -1) are not
+// timed there and get the same arrival of 0 and unconstrained required times.
+//
+// The memo holds NodeIds of one graph: clear() it after any edit or rebuild.
+// Required times are dropped by themselves when the constraints change.
+class TimingQuery {
+public:
+    TimingQuery();
+
+    NodeTiming query(const TimingGraph& graph, NodeId node, double clockPeriod,
+                     double holdTime, double setupTime, double registerHoldTime);
+    void clear();
+
+    // Nodes with a memoized arrival / required time
+    int getArrivalCount() const { return static_cast<int>(arrivedNodes.size()); }
+    int getRequiredCount() const { return static_cast<int>(requiredNodes.size()); }
+
+private:
+    vector<double> arrival;
+    vector<double> earlyArrival;
+    vector<double> required;
+    vector<double> holdRequired;
+    vector<char> arrivedFlags;
+    vector<char> requiredFlags;
+    vector<NodeId> arrivedNodes;        // Flagged nodes, so clear() costs what was timed
+    vector<NodeId> requiredNodes;
+
+    // Constraints the memoized required times were computed for
+    double clockPeriod;
+    double holdTime;
+    double setupTime;
+    double registerHoldTime;
+
+    // Depth-first scratch: a node and whether its cone has been pushed
+    vector<pair<NodeId, bool>> stack;
+
+    void resize(const TimingGraph& graph);
+    void clearRequired();
+    void arrive(const TimingGraph& graph, NodeId node);
+    void require(const TimingGraph& graph, NodeId node);
+    void arriveNode(const TimingGraph& graph, NodeId node);
+    void requireNode(const TimingGraph& graph, NodeId node);
+};
+
+// ===== Implementation =======================================================
+
+TimingQuery::TimingQuery()
+    : clockPeriod(0.0), holdTime(0.0), setupTime(0.0), registerHoldTime(0.0) {
+}
+
+NodeTiming TimingQuery::query(const TimingGraph& graph, NodeId node, double period,
+                              double hold, double setup, double registerHold) {
+    resize(graph);
+    if (period != clockPeriod || hold != holdTime || setup != setupTime ||
+        registerHold != registerHoldTime) {
+        clearRequired();
+        clockPeriod = period;
+        holdTime = hold;
+        setupTime = setup;
+        registerHoldTime = registerHold;
+    }
+    arrive(graph, node);
+    require(graph, node);
+    return {arrival[node], required[node], required[node] - arrival[node],
+            earlyArrival[node], holdRequired[node], earlyArrival[node] - holdRequired[node]};
+}
+
+void TimingQuery::clear() {
+    for (NodeId node : arrivedNodes) arrivedFlags[node] = 0;
+    arrivedNodes.clear();
+    clearRequired();
+}
+
+void TimingQuery::clearRequired() {
+    for (NodeId node : requiredNodes) requiredFlags[node] = 0;
+    requiredNodes.clear();
+}
+
+void TimingQuery::resize(const TimingGraph& graph) {
+    // Edits only ever add nodes; the new ones start out untimed
+    size_t nodeCount = graph.getNodeCount();
+    if (arrivedFlags.size() >= nodeCount) return;
+    arrival.resize(nodeCount);
+    earlyArrival.resize(nodeCount);
+    required.resize(nodeCount);
+    holdRequired.resize(nodeCount);
+    arrivedFlags.resize(nodeCount, 0);
+    requiredFlags.resize(nodeCount, 0);
+}
+
+void TimingQuery::arrive(const TimingGraph& graph, NodeId root) {
+    // Post-order walk of the fanin cone: a node is timed once all its fanins
+    // are. A node pushed twice (reconvergent fanout) is timed by whichever
+    // copy is expanded first and skipped at the other.
+    stack.clear();
+    stack.push_back({root, false});
+    while (!stack.empty()) {
+        NodeId node = stack.back().first;
+        if (arrivedFlags[node]) {
+            stack.pop_back();
+            continue;
+        }
+        if (stack.back().second) {
+            stack.pop_back();
+            arriveNode(graph, node);
+            continue;
+        }
+        stack.back().second = true;
+        GateId driver = graph.getDriver(node);
+        if (graph.getLevel(node) <= 0 || driver == INVALID_ID || graph.isRegister(driver)) continue;
+        for (const NodeId* in = graph.faninBegin(driver); in != graph.faninEnd(driver); ++in) {
+            if (!arrivedFlags[*in]) stack.push_back({*in, false});
+        }
+    }
+}
+
+void TimingQuery::arriveNode(const TimingGraph& graph, NodeId node) {
+    // Sources and nodes on loops arrive at 0, register outputs at their
+    // clock-to-Q delay
+    double late = 0.0;
+    double early = 0.0;
+    GateId driver = graph.getDriver(node);
+    if (graph.getLevel(node) >= 0 && driver != INVALID_ID) {
+        if (graph.isRegister(driver)) {
+            late = graph.getDelay(driver);
+            early = graph.getDelay(driver);
+        } else if (graph.getLevel(node) > 0) {
+            const NodeId* in = graph.faninBegin(driver);
+            const NodeId* inEnd = graph.faninEnd(driver);
+            double latest, earliest;
+            if (graph.hasArcDelays(driver)) {
+                const double* arc = graph.arcDelaysBegin(driver);
+                latest = arrival[*in] + *arc;
+                earliest = earlyArrival[*in] + *arc;
+                for (++in, ++arc; in != inEnd; ++in, ++arc) {
+                    latest = max(latest, arrival[*in] + *arc);
+                    earliest = min(earliest, earlyArrival[*in] + *arc);
+                }
+            } else {
+                latest = arrival[*in];
+                earliest = earlyArrival[*in];
+                for (++in; in != inEnd; ++in) {
+                    latest = max(latest, arrival[*in]);
+                    earliest = min(earliest, earlyArrival[*in]);
+                }
+            }
+            late = latest + graph.getDelay(driver);
+            early = earliest + graph.getDelay(driver);
+        }
+    }
+    arrival[node] = late;
+    earlyArrival[node] = early;
+    arrivedFlags[node] = 1;
+    arrivedNodes.push_back(node);
+}
+
+void TimingQuery::require(const TimingGraph& graph, NodeId root) {
+    // Post-order walk of the fanout cone, up to the endpoints
+    stack.clear();
+    stack.push_back({root, false});
+    while (!stack.empty()) {
+        NodeId node = stack.back().first;
+        if (requiredFlags[node]) {
+            stack.pop_back();
+            continue;
+        }
+        if (stack.back().second) {
+            stack.pop_back();
+            requireNode(graph, node);
+            continue;
+        }
+        stack.back().second = true;
+        if (graph.getLevel(node) < 0) continue;
+        for (const GateId* g = graph.fanoutBegin(node); g != graph.fanoutEnd(node); ++g) {
+            NodeId output = graph.getOutput(*g);
+            if (graph.getDriver(output) != *g || graph.isRegister(*g)) continue;
+            if (!requiredFlags[output]) stack.push_back({output, false});
+        }
+    }
+}
+
+void TimingQuery::requireNode(const TimingGraph& graph, NodeId node) {
+    double setup = numeric_limits<double>::infinity();
+    double hold = -numeric_limits<double>::infinity();
+    if (graph.getLevel(node) >= 0) {
+        if (graph.isOutput(node)) {
+            setup = clockPeriod;
+            hold = holdTime;
+        }
+        double capture = clockPeriod - setupTime;
+        for (const GateId* g = graph.fanoutBegin(node); g != graph.fanoutEnd(node); ++g) {
+            NodeId output = graph.getOutput(*g);
+            if (graph.getDriver(output) != *g) continue;
+            if (graph.isRegister(*g)) {
+                // A register data input ends the path
+                setup = min(setup, capture);
+                hold = max(hold, registerHoldTime);
+                continue;
+            }
+            double delay = graph.getFanoutDelay(g);
+            setup = min(setup, required[output] - delay);
+            hold = max(hold, holdRequired[output] - delay);
+        }
+    }
+    required[node] = setup;
+    holdRequired[node] = hold;
+    requiredFlags[node] = 1;
+    requiredNodes.push_back(node);
+}
+
+#endif // TIMING_QUERY_H
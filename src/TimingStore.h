@@ -0,0 +1,136 @@
+#ifndef TIMING_STORE_H
+#define TIMING_STORE_H
+
+#include <cstddef>
+#include <vector>
+#include "SimdDouble.h"
+#include "TimingGraph.h"
+
+using namespace std;
+
+// Analysis results as one contiguous array per quantity, indexed by NodeId.
+// The Circuit owns the store, the TimingAnalyzer fills it and every Node
+// reads its own entries, so each value exists exactly once. The timing model
+// has a single transition; a Node's rise and fall getters read the same entry.
+//
+// worstFanin records, for every driven node, the input of its driver that
+// set its arrival time (the first latest-arriving one), so the worst path
+// into any node is a walk back through that array. Startpoints, and nodes
+// on a combinational cycle, hold INVALID_ID.
+//
+// Early (min) timing for hold checks is kept beside the late (max) timing
+// and filled by the same passes: earlyArrival is the earliest arrival,
+// holdRequired the latest arrival a hold check still accepts (-inf where
+// no check is reached), and holdSlack = earlyArrival - holdRequired.
+struct TimingStore {
+    vector<double> arrival;
+    vector<double> earlyArrival;
+    vector<NodeId> worstFanin;
+    vector<double> required;
+    vector<double> holdRequired;
+    vector<double> slack;
+    vector<double> holdSlack;
+    vector<double> slew;
+    vector<double> capacitance;
+    vector<int> fanoutCount;
+
+    void clear();
+
+    // Vectorized sweeps over nodes [begin, end); outputs must already be sized
+    void computeSlack(size_t begin, size_t end);                    // required - arrival
+    void computeHoldSlack(size_t begin, size_t end);                // earlyArrival - holdRequired
+    void computeSlew(double arrivalFraction);                       // arrival * fraction
+    void computeCapacitance(double base, double perFanout);         // base + fanout * perFanout
+    double minSlack(double initial) const { return minOf(slack, initial); }
+    double minHoldSlack(double initial) const { return minOf(holdSlack, initial); }
+
+private:
+    static void subtract(const vector<double>& a, const vector<double>& b, vector<double>& out,
+                         size_t begin, size_t end);
+    static double minOf(const vector<double>& values, double initial);
+};
+
+// ===== Implementation =======================================================
+
+void TimingStore::clear() {
+    arrival.clear();
+    earlyArrival.clear();
+    worstFanin.clear();
+    required.clear();
+    holdRequired.clear();
+    slack.clear();
+    holdSlack.clear();
+    slew.clear();
+    capacitance.clear();
+    fanoutCount.clear();
+}
+
+void TimingStore::computeSlack(size_t begin, size_t end) {
+    subtract(required, arrival, slack, begin, end);
+}
+
+void TimingStore::computeHoldSlack(size_t begin, size_t end) {
+    subtract(earlyArrival, holdRequired, holdSlack, begin, end);
+}
+
+void TimingStore::subtract(const vector<double>& a, const vector<double>& b, vector<double>& result,
+                           size_t begin, size_t end) {
+    const double* left = a.data();
+    const double* right = b.data();
+    double* out = result.data();
+    size_t i = begin;
+    for (; i + SIMD_WIDTH <= end; i += SIMD_WIDTH) {
+        simdStore(out + i, simdSub(simdLoad(left + i), simdLoad(right + i)));
+    }
+    for (; i < end; ++i) {
+        out[i] = left[i] - right[i];
+    }
+}
+
+void TimingStore::computeSlew(double arrivalFraction) {
+    size_t count = arrival.size();
+    slew.resize(count);
+    const double* arr = arrival.data();
+    double* out = slew.data();
+    SimdDouble fraction = simdBroadcast(arrivalFraction);
+    size_t i = 0;
+    for (; i + SIMD_WIDTH <= count; i += SIMD_WIDTH) {
+        simdStore(out + i, simdMul(simdLoad(arr + i), fraction));
+    }
+    for (; i < count; ++i) {
+        out[i] = arr[i] * arrivalFraction;
+    }
+}
+
+void TimingStore::computeCapacitance(double base, double perFanout) {
+    size_t count = fanoutCount.size();
+    capacitance.resize(count);
+    const int* fanout = fanoutCount.data();
+    double* out = capacitance.data();
+    SimdDouble baseVector = simdBroadcast(base);
+    SimdDouble perFanoutVector = simdBroadcast(perFanout);
+    size_t i = 0;
+    for (; i + SIMD_WIDTH <= count; i += SIMD_WIDTH) {
+        simdStore(out + i, simdAdd(baseVector, simdMul(simdLoadInts(fanout + i), perFanoutVector)));
+    }
+    for (; i < count; ++i) {
+        out[i] = base + fanout[i] * perFanout;
+    }
+}
+
+double TimingStore::minOf(const vector<double>& valueArray, double initial) {
+    const double* values = valueArray.data();
+    size_t count = valueArray.size();
+    SimdDouble lowest = simdBroadcast(initial);
+    size_t i = 0;
+    for (; i + SIMD_WIDTH <= count; i += SIMD_WIDTH) {
+        lowest = simdMin(lowest, simdLoad(values + i));
+    }
+    double result = simdReduceMin(lowest);
+    for (; i < count; ++i) {
+        result = min(result, values[i]);
+    }
+    return result;
+}
+
+#endif // TIMING_STORE_H
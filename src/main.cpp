@@ -8,11 +8,19 @@
 #include <algorithm>
 #include <iomanip>
 #include <memory>
+#include <limits>
+#include <bitset>
 
 #include "Node.h"
 #include "Gate.h"
 #include "Circuit.h"
 #include "TimingAnalyzer.h"
+#include "NetlistParser.h"
+#include "CircuitSnapshot.h"
+#include "LogicSimulator.h"
+#include "NetlistGenerator.h"
+#include "TimingModel.h"
+#include "AnalysisServer.h"
 
 using namespace std;
 
@@ -20,47 +28,33 @@ using namespace std;
 // NODE IMPLEMENTATION
 // ============================================================================
 
-Node::Node(const string& name, bool isInput, bool isOutput) 
+Node::Node(Symbol name, bool isInput, bool isOutput) 
     : name(name), isPrimaryInput(isInput), isPrimaryOutput(isOutput),
-      arrivalTimeRise(0.0), arrivalTimeFall(0.0),
-      requiredTimeRise(0.0), requiredTimeFall(0.0),
-      slackRise(0.0), slackFall(0.0),
-      slewRise(0.0), slewFall(0.0),
-      capacitance(0.0), fanoutCount(0) {
+      fanin(nullptr), timing(nullptr), id(INVALID_ID) {
 }
 
 double Node::getMaxArrivalTime() const {
-    return max(arrivalTimeRise, arrivalTimeFall);
+    return max(getArrivalTimeRise(), getArrivalTimeFall());
 }
 
 double Node::getMinRequiredTime() const {
-    return min(requiredTimeRise, requiredTimeFall);
+    return min(getRequiredTimeRise(), getRequiredTimeFall());
 }
 
 double Node::getWorstSlack() const {
-    return min(slackRise, slackFall);
-}
-
-void Node::resetTiming() {
-    arrivalTimeRise = 0.0;
-    arrivalTimeFall = 0.0;
-    requiredTimeRise = 0.0;
-    requiredTimeFall = 0.0;
-    slackRise = 0.0;
-    slackFall = 0.0;
-    slewRise = 0.0;
-    slewFall = 0.0;
+    return min(getSlackRise(), getSlackFall());
 }
 
 void Node::printTiming() const {
     cout << fixed << setprecision(3);
     cout << "Node: " << name << endl;
-    cout << "  Arrival Time (Rise/Fall): " << arrivalTimeRise << " / " << arrivalTimeFall << " ns" << endl;
-    cout << "  Required Time (Rise/Fall): " << requiredTimeRise << " / " << requiredTimeFall << " ns" << endl;
-    cout << "  Slack (Rise/Fall): " << slackRise << " / " << slackFall << " ns" << endl;
-    cout << "  Slew (Rise/Fall): " << slewRise << " / " << slewFall << " ns" << endl;
-    cout << "  Capacitance: " << capacitance << " fF" << endl;
-    cout << "  Fanout Count: " << fanoutCount << endl;
+    cout << "  Arrival Time (Rise/Fall): " << getArrivalTimeRise() << " / " << getArrivalTimeFall() << " ns" << endl;
+    cout << "  Required Time (Rise/Fall): " << getRequiredTimeRise() << " / " << getRequiredTimeFall() << " ns" << endl;
+    cout << "  Slack (Rise/Fall): " << getSlackRise() << " / " << getSlackFall() << " ns" << endl;
+    cout << "  Early Arrival / Hold Slack: " << getEarlyArrivalTime() << " / " << getHoldSlack() << " ns" << endl;
+    cout << "  Slew (Rise/Fall): " << getSlewRise() << " / " << getSlewFall() << " ns" << endl;
+    cout << "  Capacitance: " << getCapacitance() << " fF" << endl;
+    cout << "  Fanout Count: " << getFanoutCount() << endl;
     cout << "  Worst Slack: " << getWorstSlack() << " ns" << endl;
 }
 
@@ -68,70 +62,269 @@ void Node::printTiming() const {
 // CIRCUIT IMPLEMENTATION
 // ============================================================================
 
-Circuit::Circuit() : clockPeriod(1.0) {
+Circuit::Circuit()
+    : sortedNodesStale(false), typeDelays(GATE_TYPE_COUNT, 0.0), typeSigmas(GATE_TYPE_COUNT, 0.0),
+      clockPeriod(1.0), holdTime(0.0), graphDirty(true) {
     
 }
 
 void Circuit::loadCircuit(const string& filename) {
-    ifstream file(filename);
-    if (!file.is_open()) {
+    NetlistParser parser;
+    if (!parser.parse(filename)) {
         throw runtime_error("Cannot open circuit file: " + filename);
     }
-
-    string line;
-    while (getline(file, line)) {
-        
-        if (line.empty() || line[0] == '#') continue;
+    netlistSource = filename;
+    
+    if (parser.hasClockPeriod()) {
+        clockPeriod = parser.getClockPeriod();
+    }
+    if (parser.hasHoldTime()) {
+        holdTime = parser.getHoldTime();
+    }
+    bool freshCircuit = nodes.empty() && gates.empty();
+    
+    // One Node object per interned name; an existing node keeps its flags
+    StringInterner& interner = StringInterner::global();
+    vector<Node*> nodeObjects(parser.getNodeCount());
+    nodeIndex.reserve(nodeIndex.size() + parser.getNodeCount());
+    for (NodeId id = 0; id < parser.getNodeCount(); ++id) {
+        nodeObjects[id] = findOrCreateNode(interner.intern(parser.getNodeName(id)),
+                                           parser.isInput(id), parser.isOutput(id));
+    }
+    for (NodeId id : parser.getPrimaryInputs()) {
+        primaryInputs.push_back(nodeObjects[id]->getName());
+    }
+    for (NodeId id : parser.getPrimaryOutputs()) {
+        primaryOutputs.push_back(nodeObjects[id]->getName());
+    }
+    
+    // Gates are created through the factory so unknown types and bad input
+    // counts are reported exactly as before; rejected gates are skipped
+    vector<const NetlistGate*> acceptedGates;
+    vector<Node*> inputNodes;
+    gates.reserve(gates.size() + parser.getGates().size());
+    for (const auto& record : parser.getGates()) {
+        inputNodes.clear();
+        for (const NodeId* in = parser.inputsBegin(record); in != parser.inputsEnd(record); ++in) {
+            inputNodes.push_back(nodeObjects[*in]);
+        }
         
-        istringstream iss(line);
-        string command;
-        iss >> command;
+        Gate* gate = GateFactory::createGate(arena, record.type, interner.intern(record.name),
+                                             inputNodes.data(), static_cast<int>(inputNodes.size()),
+                                             nodeObjects[record.output]);
+        if (!gate) continue;
         
-        if (command == "CLOCK_PERIOD") {
-            iss >> clockPeriod;
-        }
-        else if (command == "INPUT") {
-            string inputName;
-            while (iss >> inputName) {
-                addNode(inputName, true, false);
-                primaryInputs.push_back(inputName);
-            }
+        gate->setDelay(getGateDelay(gate->getGateType()));
+        gates.push_back(gate);
+        nodeObjects[record.output]->setFanin(gate);
+        acceptedGates.push_back(&record);
+    }
+    size_t plainGateCount = gates.size();
+    instantiateModels(parser, nodeObjects, filename);
+    
+    if (!freshCircuit) {
+        if (!validateCircuit()) {
+            throw runtime_error("Invalid circuit configuration");
+        }
+        buildGraph();
+        printValidationWarnings(cerr);
+        return;
+    }
+    
+    // Every name a fresh netlist references was interned by the parser, so
+    // there is nothing for validateCircuit to find and the graph can take
+    // the parser's IDs as they are
+    graph.clear();
+    graph.reserve(parser.getNodeCount(), static_cast<int>(acceptedGates.size()),
+                  parser.getEdgeCount());
+    nodesById.clear();
+    timing.clear();
+    nodesById.reserve(nodeObjects.size());
+    for (Node* node : nodeObjects) {
+        graph.addNode(node->getNameSymbol(), node->isInput(), node->isOutput());
+        registerNode(node);
+    }
+    
+ 
+    vector<NodeId> inputIds;
+    for (size_t i = 0; i < acceptedGates.size(); ++i) {
+        const NetlistGate* record = acceptedGates[i];
+        inputIds.assign(parser.inputsBegin(*record), parser.inputsEnd(*record));
+        graph.addGate(gates[i]->getNameSymbol(), gates[i]->getGateType(), inputIds, record->output);
+    }
+    for (size_t i = plainGateCount; i < gates.size(); ++i) {
+        inputIds.clear();
+        for (Node* const* input = gates[i]->inputsBegin(); input != gates[i]->inputsEnd(); ++input) {
+            inputIds.push_back((*input)->getId());
+        }
+        graph.addGate(gates[i]->getNameSymbol(), GateType::MACRO, inputIds,
+                      gates[i]->getOutputNode()->getId(), gates[i]->getArcDelays());
+    }
+    
+    graph.finalize();
+    graph.bindDelays(typeDelays);
+    graphDirty = false;
+    printValidationWarnings(cerr);
+}
+
+void Circuit::instantiateModels(const NetlistParser& parser, const vector<Node*>& nodeObjects,
+                                const string& netlistFile) {
+    if (parser.getInstances().empty()) return;
+    
+    // Model files are found relative to the netlist that names them
+    string directory;
+    size_t slash = netlistFile.find_last_of("/\\");
+    if (slash != string::npos) directory = netlistFile.substr(0, slash + 1);
+    
+    // Instances of a model share one arc delay array per model output
+    struct LoadedModel {
+        TimingModel model;
+        vector<const double*> outputDelays;
+    };
+    map<string_view, LoadedModel> models;
+    for (const auto& record : parser.getModels()) {
+        string path(record.path);
+        if (!directory.empty() && !path.empty() && path[0] != '/' && path[0] != '\\' &&
+            path.find(':') == string::npos) {
+            path = directory + path;
         }
-        else if (command == "OUTPUT") {
-            string outputName;
-            while (iss >> outputName) {
-                addNode(outputName, false, true);
-                primaryOutputs.push_back(outputName);
+        LoadedModel& loaded = models[record.name];
+        loaded.model = TimingModel::load(path);
+        for (size_t output = 0; output < loaded.model.getOutputs().size(); ++output) {
+            const TimingArc* first = loaded.model.arcsBegin(static_cast<int>(output));
+            const TimingArc* last = loaded.model.arcsEnd(static_cast<int>(output));
+            double* delays = arena.allocateArray<double>(max<size_t>(1, last - first));
+            for (const TimingArc* arc = first; arc != last; ++arc) {
+                delays[arc - first] = arc->delay;
             }
+            loaded.outputDelays.push_back(delays);
         }
-        else if (command == "GATE") {
-            string gateType, gateName, outputName;
-            vector<string> inputs;
-            
-            iss >> gateType >> gateName >> outputName;
+    }
+    
+    StringInterner& interner = StringInterner::global();
+    vector<Node*> inputNodes;
+    for (const auto& instance : parser.getInstances()) {
+        auto it = models.find(instance.model);
+        if (it == models.end()) {
+            throw runtime_error("Instance " + string(instance.name) + " uses unknown model " +
+                                string(instance.model));
+        }
+        const TimingModel& model = it->second.model;
+        if (instance.pinCount != model.getPinCount()) {
+            cerr << "Invalid pin count for instance " << instance.name << " of model "
+                 << instance.model << endl;
+            continue;
+        }
+        
+        // Pins list the model's outputs first, then its inputs
+        const NodeId* pins = parser.pinsBegin(instance);
+        int outputCount = static_cast<int>(model.getOutputs().size());
+        for (int output = 0; output < outputCount; ++output) {
+            const TimingArc* first = model.arcsBegin(output);
+            const TimingArc* last = model.arcsEnd(output);
+            if (first == last) continue;    // Unconnected output stays undriven
             
-            string input;
-            while (iss >> input) {
-                inputs.push_back(input);
+            inputNodes.clear();
+            for (const TimingArc* arc = first; arc != last; ++arc) {
+                inputNodes.push_back(nodeObjects[pins[outputCount + arc->input]]);
             }
+            Node** inputList = arena.allocateArray<Node*>(inputNodes.size());
+            copy(inputNodes.begin(), inputNodes.end(), inputList);
             
-            addGate(gateType, gateName, inputs, outputName);
+            Symbol name = interner.intern(string(instance.name) + "/" + model.getOutputs()[output]);
+            Node* outputNode = nodeObjects[pins[output]];
+            Gate* gate = arena.create<Gate>(GateType::MACRO, name, inputList,
+                                            static_cast<int>(inputNodes.size()), outputNode,
+                                            getGateDelay(GateType::MACRO));
+            gate->setArcDelays(it->second.outputDelays[output]);
+            gates.push_back(gate);
+            outputNode->setFanin(gate);
         }
     }
-    
-    file.close();
-    
-    if (!validateCircuit()) {
-        throw runtime_error("Invalid circuit configuration");
-    }
 }
 
 void Circuit::loadDelays(const string& filename) {
+    map<string, double> sigmas;
+    DelayTableLibrary tables;
+    map<string, double> library = readDelayLibrary(filename, &sigmas, &tables);
+    tables.validate(filename);
+    delayTables = tables;
+    for (const auto& entry : library) {
+        gateDelays[entry.first] = entry.second;
+    }
+    for (const auto& entry : sigmas) {
+        gateSigmas[entry.first] = entry.second;
+    }
+    delaySource = filename;
+    bindDelays();
+    // Nothing memoized from the previous tables may survive
+    delayCalculator.setLibrary(&delayTables, getGateDelay("INPUT_SLEW"), getGateDelay("OUTPUT_LOAD"));
+}
+
+void Circuit::loadCorners(const vector<string>& filenames) {
+    if (filenames.empty()) {
+        throw runtime_error("No delay corners given");
+    }
+    loadDelays(filenames[0]);
+    corners.clear();
+    for (const string& filename : filenames) {
+        size_t slash = filename.find_last_of("/\\");
+        string name = slash == string::npos ? filename : filename.substr(slash + 1);
+        size_t dot = name.find_last_of('.');
+        if (dot != string::npos && dot > 0) name = name.substr(0, dot);
+        DelayCorner corner;
+        corner.name = name;
+        corner.source = filename;
+        if (corners.empty()) {
+            corner.typeDelays = typeDelays;
+            corner.tables = delayTables;
+            corner.setupTime = getSetupTime();
+            corner.registerHoldTime = getRegisterHoldTime();
+            corner.inputSlew = getGateDelay("INPUT_SLEW");
+            corner.outputLoad = getGateDelay("OUTPUT_LOAD");
+        } else {
+            map<string, double> library = readDelayLibrary(filename, nullptr, &corner.tables);
+            corner.tables.validate(filename);
+            auto value = [&library](const char* key) {
+                auto it = library.find(key);
+                return it != library.end() ? it->second : 0.0;
+            };
+            corner.typeDelays = resolvePerType(library);
+            corner.setupTime = value("SETUP_TIME");
+            corner.registerHoldTime = value("HOLD_TIME");
+            corner.inputSlew = value("INPUT_SLEW");
+            corner.outputLoad = value("OUTPUT_LOAD");
+        }
+        corners.push_back(move(corner));
+    }
+}
+
+void Circuit::calculateCornerDelays(int corner, vector<double>& delays) const {
+    const TimingGraph& compiled = graph;
+    const DelayCorner& library = corners[corner];
+    delays.resize(compiled.getGateCount());
+    for (GateId id = 0; id < compiled.getGateCount(); ++id) {
+        delays[id] = library.typeDelays[static_cast<int>(compiled.getGateType(id))];
+    }
+    if (!library.tables.hasTables()) return;
+    
+    // A calculator of its own, so the primary library's memo is left alone
+    DelayCalculator calculator;
+    calculator.setLibrary(&library.tables, library.inputSlew, library.outputLoad);
+    vector<double> loads, slews;
+    calculator.calculate(compiled, loads, slews, delays, nullptr);
+}
+
+// Lines are "<type> <delay> [sigma]"; sigmas, when given, receives the
+// optional standard deviations and tables the table lines (see DelayTable.h)
+map<string, double> Circuit::readDelayLibrary(const string& filename, map<string, double>* sigmas,
+                                              DelayTableLibrary* tables) {
     ifstream file(filename);
     if (!file.is_open()) {
         throw runtime_error("Cannot open delay file: " + filename);
     }
 
+    map<string, double> library;
     string line;
     while (getline(file, line)) {
         if (line.empty() || line[0] == '#') continue;
@@ -140,44 +333,407 @@ void Circuit::loadDelays(const string& filename) {
         string gateType;
         double delay;
         
-        if (iss >> gateType >> delay) {
-            gateDelays[gateType] = delay;
+        if (!(iss >> gateType)) continue;
+        if (DelayTableLibrary::isTableKeyword(gateType)) {
+            if (!tables) continue;
+            try {
+                tables->parseLine(gateType, iss);
+            } catch (const runtime_error& e) {
+                throw runtime_error(filename + ": " + e.what());
+            }
+        } else if (iss >> delay) {
+            library[gateType] = delay;
+            double sigma;
+            if (sigmas && iss >> sigma) {
+                (*sigmas)[gateType] = sigma;
+            }
+        }
+    }
+    return library;
+}
+
+vector<double> Circuit::resolvePerType(const map<string, double>& library) {
+    vector<double> delays(GATE_TYPE_COUNT, 0.0);
+    for (int type = 0; type < GATE_TYPE_COUNT - 1; ++type) {
+        auto it = library.find(GATE_TYPE_TRAITS[type].name);
+        if (it != library.end()) delays[type] = it->second;
+    }
+    return delays;
+}
+
+void Circuit::bindDelays() {
+    // Resolve the library once per gate type, then into every gate, so the
+    // timing passes never look a delay up by name
+    typeDelays = resolvePerType(gateDelays);
+    typeSigmas = resolvePerType(gateSigmas);
+    
+    for (const auto& gate : gates) {
+        if (gate) gate->setDelay(getGateDelay(gate->getGateType()));
+    }
+    delayOverrides.clear();
+    if (!graphDirty) {
+        graph.bindDelays(typeDelays);
+    }
+}
+
+bool Circuit::saveSnapshot(const string& filename) {
+    uint64_t netlistFingerprint, delayFingerprint;
+    if (!CircuitSnapshot::fingerprintFile(netlistSource, netlistFingerprint) ||
+        !CircuitSnapshot::fingerprintFile(delaySource, delayFingerprint)) {
+        return false;
+    }
+    
+    // Snapshots hold one delay per gate, no timing model arcs and no tables
+    const TimingGraph& compiled = getGraph();
+    if (compiled.hasArcDelays() || delayTables.hasTables()) return false;
+    vector<NodeId> inputIds, outputIds;
+    for (const auto& input : primaryInputs) {
+        inputIds.push_back(compiled.findNode(input));
+    }
+    for (const auto& output : primaryOutputs) {
+        outputIds.push_back(compiled.findNode(output));
+    }
+    return CircuitSnapshot::write(filename, compiled, clockPeriod, holdTime, gateDelays, gateSigmas,
+                                  inputIds, outputIds, netlistFingerprint, delayFingerprint);
+}
+
+bool Circuit::loadSnapshot(const string& filename, const string& netlistFile, const string& delayFile) {
+    if (!nodes.empty() || !gates.empty()) return false;
+    
+    CircuitSnapshot snapshot;
+    uint64_t netlistFingerprint, delayFingerprint;
+    if (!snapshot.open(filename) ||
+        !CircuitSnapshot::fingerprintFile(netlistFile, netlistFingerprint) ||
+        !CircuitSnapshot::fingerprintFile(delayFile, delayFingerprint) ||
+        snapshot.getNetlistFingerprint() != netlistFingerprint ||
+        snapshot.getDelayFingerprint() != delayFingerprint) {
+        return false;
+    }
+    
+    // A snapshot naming a gate the factory no longer accepts is treated as
+    // stale; check them all before touching the circuit
+    for (GateId id = 0; id < snapshot.getGateCount(); ++id) {
+        int inputCount = static_cast<int>(snapshot.faninEnd(id) - snapshot.faninBegin(id));
+        if (!GateFactory::isValidGate(snapshot.getGateType(id), string(snapshot.getGateName(id)),
+                                      inputCount)) {
+            return false;
+        }
+    }
+    
+    clockPeriod = snapshot.getClockPeriod();
+    holdTime = snapshot.getHoldTime();
+    for (int entry = 0; entry < snapshot.getLibrarySize(); ++entry) {
+        string type(snapshot.getLibraryType(entry));
+        gateDelays[type] = snapshot.getLibraryDelay(entry);
+        if (snapshot.getLibrarySigma(entry) != 0.0) {
+            gateSigmas[type] = snapshot.getLibrarySigma(entry);
         }
     }
+    bindDelays();
+    
+    graph.clear();
+    graph.reserve(snapshot.getNodeCount(), snapshot.getGateCount(), snapshot.getEdgeCount());
+    nodesById.clear();
+    timing.clear();
+    nodesById.reserve(snapshot.getNodeCount());
+    StringInterner& interner = StringInterner::global();
+    vector<Node*> nodeObjects(snapshot.getNodeCount());
+    nodeIndex.reserve(snapshot.getNodeCount());
+    for (NodeId id = 0; id < snapshot.getNodeCount(); ++id) {
+        Node* node = findOrCreateNode(interner.intern(snapshot.getNodeName(id)),
+                                      snapshot.isInput(id), snapshot.isOutput(id));
+        graph.addNode(node->getNameSymbol(), node->isInput(), node->isOutput());
+        registerNode(node);
+        nodeObjects[id] = node;
+    }
+    for (const NodeId* in = snapshot.circuitInputsBegin(); in != snapshot.circuitInputsEnd(); ++in) {
+        primaryInputs.push_back(nodesById[*in]->getName());
+    }
+    for (const NodeId* out = snapshot.circuitOutputsBegin(); out != snapshot.circuitOutputsEnd(); ++out) {
+        primaryOutputs.push_back(nodesById[*out]->getName());
+    }
+    
+    vector<NodeId> inputIds;
+    vector<Node*> inputNodes;
+    gates.reserve(snapshot.getGateCount());
+    for (GateId id = 0; id < snapshot.getGateCount(); ++id) {
+        inputIds.assign(snapshot.faninBegin(id), snapshot.faninEnd(id));
+        inputNodes.clear();
+        for (NodeId input : inputIds) {
+            inputNodes.push_back(nodeObjects[input]);
+        }
+        Gate* gate = GateFactory::createGate(arena, snapshot.getGateType(id),
+                                             interner.intern(snapshot.getGateName(id)),
+                                             inputNodes.data(), static_cast<int>(inputNodes.size()),
+                                             nodeObjects[snapshot.getOutput(id)]);
+        nodeObjects[snapshot.getOutput(id)]->setFanin(gate);
+        gates.push_back(gate);
+        graph.addGate(gate->getNameSymbol(), gate->getGateType(), inputIds, snapshot.getOutput(id));
+    }
     
-    file.close();
+    graph.finalize();
+    for (GateId id = 0; id < snapshot.getGateCount(); ++id) {
+        gates[id]->setDelay(snapshot.getDelay(id));
+        graph.setDelay(id, snapshot.getDelay(id));
+    }
+    graphDirty = false;
+    netlistSource = netlistFile;
+    delaySource = delayFile;
+    printValidationWarnings(cerr);
+    return true;
+}
+
+void Circuit::loadCached(const string& netlistFile, const string& delayFile, const string& snapshotFile) {
+    if (loadSnapshot(snapshotFile, netlistFile, delayFile)) return;
+    
+    loadCircuit(netlistFile);
+    loadDelays(delayFile);
+    if (!saveSnapshot(snapshotFile)) {
+        cerr << "Warning: could not write snapshot " << snapshotFile << endl;
+    }
+}
+
+void Circuit::registerNode(Node* node) {
+    node->bindTiming(&timing, static_cast<NodeId>(nodesById.size()));
+    nodesById.push_back(node);
+}
+
+Node* Circuit::findOrCreateNode(Symbol name, bool isInput, bool isOutput) {
+    Node*& slot = nodeIndex[name];
+    if (slot) return slot;
+    
+    Node* node = arena.create<Node>(name, isInput, isOutput);
+    slot = node;
+    nodes.push_back(node);
+    sortedNodesStale = true;
+    if (!graphDirty) {
+        graph.addNode(name, isInput, isOutput);
+        registerNode(node);
+    }
+    return node;
 }
 
 void Circuit::addNode(const string& name, bool isInput, bool isOutput) {
-    if (nodes.find(name) == nodes.end()) {
-        nodes[name] = make_shared<Node>(name, isInput, isOutput);
+    findOrCreateNode(StringInterner::global().intern(name), isInput, isOutput);
+}
+
+const vector<Node*>& Circuit::getNodes() const {
+    if (sortedNodesStale || sortedNodes.size() != nodes.size()) {
+        // Resolve each name once instead of on every comparison
+        vector<pair<const string*, Node*>> named;
+        named.reserve(nodes.size());
+        for (Node* node : nodes) {
+            named.emplace_back(&node->getName(), node);
+        }
+        sort(named.begin(), named.end(), [](const pair<const string*, Node*>& a,
+                                            const pair<const string*, Node*>& b) {
+            return *a.first < *b.first;
+        });
+        sortedNodes.clear();
+        sortedNodes.reserve(named.size());
+        for (const auto& entry : named) {
+            sortedNodes.push_back(entry.second);
+        }
+        sortedNodesStale = false;
     }
+    return sortedNodes;
 }
 
 void Circuit::addGate(const string& type, const string& name, 
                      const vector<string>& inputs, const string& output) {
+    // Edits to a compiled graph must keep it acyclic; new nodes cannot close a
+    // loop, and neither can a register
+    if (!graphDirty && parseGateType(type) != GateType::DFF) {
+        vector<NodeId> inputIds;
+        for (const auto& input : inputs) {
+            NodeId id = graph.findNode(input);
+            if (id != INVALID_ID) inputIds.push_back(id);
+        }
+        NodeId outputId = graph.findNode(output);
+        if (outputId != INVALID_ID && graph.wouldCreateCycle(inputIds, outputId)) {
+            throw runtime_error("Gate " + name + " would create a combinational loop");
+        }
+    }
+    
     // Ensure all nodes exist
+    StringInterner& interner = StringInterner::global();
+    vector<Node*> inputNodes;
     for (const auto& input : inputs) {
-        addNode(input);
+        inputNodes.push_back(findOrCreateNode(interner.intern(input), false, false));
     }
-    addNode(output);
+    Node* outputNode = findOrCreateNode(interner.intern(output), false, false);
     
     // Create gate
-    auto gate = GateFactory::createGate(type, name, inputs, output);
+    Gate* gate = GateFactory::createGate(arena, type, interner.intern(name), inputNodes.data(),
+                                         static_cast<int>(inputNodes.size()), outputNode);
     if (gate) {
+        gate->setDelay(getGateDelay(gate->getGateType()));
         gates.push_back(gate);
+        outputNode->setFanin(gate);
         
-        // Connect nodes
-        for (const auto& input : inputs) {
-            nodes[input]->addFanout(gate);
+        if (!graphDirty) {
+            vector<NodeId> inputIds;
+            for (Node* input : inputNodes) {
+                inputIds.push_back(input->getId());
+            }
+            GateId id = graph.addGate(gate->getNameSymbol(), gate->getGateType(), inputIds,
+                                      outputNode->getId());
+            graph.setDelay(id, gate->getDelay());
+        }
+    }
+}
+
+Gate* Circuit::getGate(const string& gateName) {
+    if (graphDirty) {
+        buildGraph();
+    }
+    GateId id = graph.findGate(gateName);
+    if (id == INVALID_ID) {
+        throw runtime_error("Unknown gate: " + gateName);
+    }
+    return gates[id];
+}
+
+void Circuit::setGateDelay(const string& gateName, double delay) {
+    Gate* gate = getGate(gateName);
+    GateId id = graph.findGate(gateName);
+    gate->setDelay(delay);
+    graph.setDelay(id, delay);
+    // Recorded so the table calculator does not bind the gate again
+    if (delayOverrides.size() <= static_cast<size_t>(id)) delayOverrides.resize(gates.size(), 0);
+    delayOverrides[id] = 1;
+}
+
+void Circuit::calculateDelays() {
+    const TimingGraph& compiled = getGraph();
+    vector<double> delays(compiled.getGateCount());
+    for (GateId id = 0; id < compiled.getGateCount(); ++id) {
+        delays[id] = compiled.getDelay(id);
+    }
+    delayCalculator.calculate(compiled, timing.capacitance, timing.slew, delays, &delayOverrides);
+    for (GateId id = 0; id < compiled.getGateCount(); ++id) {
+        if (delays[id] == compiled.getDelay(id)) continue;
+        gates[id]->setDelay(delays[id]);
+        graph.setDelay(id, delays[id]);
+    }
+}
+
+void Circuit::updateDelays(const vector<NodeId>& loadChanged, const vector<NodeId>& driverChanged,
+                           vector<GateId>& changedGates) {
+    vector<pair<GateId, double>> changed;
+    delayCalculator.update(graph, loadChanged, driverChanged, timing.capacitance, timing.slew, changed,
+                           &delayOverrides);
+    for (const auto& entry : changed) {
+        gates[entry.first]->setDelay(entry.second);
+        graph.setDelay(entry.first, entry.second);
+        changedGates.push_back(entry.first);
+    }
+}
+
+void Circuit::setGateType(const string& gateName, const string& type) {
+    Gate* gate = getGate(gateName);
+    if (!GateFactory::isValidGate(type, gateName, gate->getInputCount())) {
+        throw runtime_error("Cannot change gate " + gateName + " to type " + type);
+    }
+    // Registers cut the levelized graph, so they are added and removed as gates
+    bool toRegister = parseGateType(type) == GateType::DFF;
+    if (toRegister != (gate->getGateType() == GateType::DFF)) {
+        throw runtime_error("Cannot change gate " + gateName + " to type " + type +
+                            "; replace it with removeGate and addGate");
+    }
+    
+    GateId id = graph.findGate(gateName);
+    gate->setType(type);
+    gate->setDelay(getGateDelay(gate->getGateType()));
+    if (static_cast<size_t>(id) < delayOverrides.size()) delayOverrides[id] = 0;
+    graph.setGateType(id, gate->getGateType());
+    graph.setDelay(id, gate->getDelay());
+}
+
+void Circuit::removeGate(const string& gateName) {
+    Gate* gate = getGate(gateName);
+    GateId id = graph.findGate(gateName);
+    
+    Node* output = gate->getOutputNode();
+    if (output->getFanin() == gate) {
+        output->setFanin(nullptr);
+    }
+    
+    // Leave a hole so gate IDs keep matching positions in gates; the gate's
+    // memory goes back with the arena
+    graph.removeGate(id);
+    gates[id] = nullptr;
+}
+
+void Circuit::reconnectGateInput(const string& gateName, int pin, const string& nodeName) {
+    Gate* gate = getGate(gateName);
+    if (pin < 0 || pin >= gate->getInputCount()) {
+        throw runtime_error("Gate " + gateName + " has no input pin " + to_string(pin));
+    }
+    
+    NodeId nodeId = graph.findNode(nodeName);
+    if (nodeId != INVALID_ID && gate->getGateType() != GateType::DFF &&
+        graph.wouldCreateCycle(vector<NodeId>(1, nodeId), gate->getOutputNode()->getId())) {
+        throw runtime_error("Reconnecting gate " + gateName + " to " + nodeName +
+                            " would create a combinational loop");
+    }
+    Node* node = findOrCreateNode(StringInterner::global().intern(nodeName), false, false);
+    
+    gate->setInput(pin, node);
+    graph.reconnectInput(graph.findGate(gateName), pin, node->getId());
+}
+
+void Circuit::buildGraph() {
+    // Drop the holes left by removeGate before numbering gates again;
+    // overrides move along with their gates
+    delayOverrides.resize(gates.size(), 0);
+    size_t kept = 0;
+    for (size_t i = 0; i < gates.size(); ++i) {
+        if (!gates[i]) continue;
+        gates[kept] = gates[i];
+        delayOverrides[kept++] = delayOverrides[i];
+    }
+    gates.resize(kept);
+    delayOverrides.resize(kept);
+    
+    graph.clear();
+    nodesById.clear();
+    timing.clear();
+    nodesById.reserve(nodes.size());
+    
+    // Node IDs follow name order so ID iteration matches the reports
+    for (Node* node : getNodes()) {
+        graph.addNode(node->getNameSymbol(), node->isInput(), node->isOutput());
+        registerNode(node);
+    }
+    
+    vector<NodeId> inputIds;
+    for (Gate* gate : gates) {
+        inputIds.clear();
+        for (Node* const* input = gate->inputsBegin(); input != gate->inputsEnd(); ++input) {
+            inputIds.push_back((*input)->getId());
         }
-        nodes[output]->setFanin(gate);
+        // Gates carry the delay bound at loadDelays, including ECO overrides
+        GateId id = graph.addGate(gate->getNameSymbol(), gate->getGateType(), inputIds,
+                                  gate->getOutputNode()->getId(), gate->getArcDelays());
+        graph.setDelay(id, gate->getDelay());
+    }
+    
+    graph.finalize();
+    graphDirty = false;
+}
+
+const TimingGraph& Circuit::getGraph() {
+    if (graphDirty) {
+        buildGraph();
+    } else if (graph.isLevelOrderStale()) {
+        graph.relevelize();
     }
+    return graph;
 }
 
-shared_ptr<Node> Circuit::getNode(const string& name) {
-    auto it = nodes.find(name);
-    return (it != nodes.end()) ? it->second : nullptr;
+Node* Circuit::getNode(const string& name) const {
+    return nodeIndex.find(StringInterner::global().find(name));
 }
 
 double Circuit::getGateDelay(const string& gateType) const {
@@ -203,6 +759,7 @@ void Circuit::printCircuit() const {
     
     cout << "\nGates:" << endl;
     for (const auto& gate : gates) {
+        if (!gate) continue;
         cout << "  " << gate->getType() << " " << gate->getName() 
                   << " -> " << gate->getOutput() << endl;
     }
@@ -214,19 +771,22 @@ void Circuit::printCircuit() const {
 }
 
 bool Circuit::validateCircuit() const {
-    // Checking if all gates have valid inputs and output
-    for (const auto& gate : gates) {
-        for (const auto& input : gate->getInputs()) {
-            if (nodes.find(input) == nodes.end()) {
+    // Checking if all gates are connected to nodes of this circuit
+    for (Gate* gate : gates) {
+        if (!gate) continue;
+        for (int pin = 0; pin < gate->getInputCount(); ++pin) {
+            Node* input = gate->getInput(pin);
+            if (!input || getNode(input->getName()) != input) {
                 cerr << "Error: Gate " << gate->getName() 
-                          << " references undefined input " << input << endl;
+                          << " references undefined input pin " << pin << endl;
                 return false;
             }
         }
         
-        if (nodes.find(gate->getOutput()) == nodes.end()) {
+        Node* output = gate->getOutputNode();
+        if (!output || getNode(output->getName()) != output) {
             cerr << "Error: Gate " << gate->getName() 
-                      << " references undefined output " << gate->getOutput() << endl;
+                      << " references an undefined output" << endl;
             return false;
         }
     }
@@ -234,258 +794,830 @@ bool Circuit::validateCircuit() const {
     return true;
 }
 
+bool Circuit::printValidationWarnings(ostream& out) const {
+    // Long lists are cut short; every loop gets its own line
+    const size_t NAMES_PER_LINE = 10;
+    const GraphValidation& validation = graph.getValidation();
+    auto printNames = [&](const vector<NodeId>& list) {
+        for (size_t i = 0; i < list.size() && i < NAMES_PER_LINE; ++i) {
+            out << " " << graph.getNodeName(list[i]);
+        }
+        if (list.size() > NAMES_PER_LINE) out << " (and " << list.size() - NAMES_PER_LINE << " more)";
+        out << endl;
+    };
+    
+    for (const auto& loop : validation.loops) {
+        out << "Warning: combinational loop through " << loop.size() << " node(s):";
+        printNames(loop);
+    }
+    if (!validation.behindLoops.empty()) {
+        out << "Warning: " << validation.behindLoops.size() << " node(s) fed by a loop are not timed:";
+        printNames(validation.behindLoops);
+    }
+    if (!validation.multiplyDriven.empty()) {
+        out << "Warning: " << validation.multiplyDriven.size()
+            << " net(s) driven by more than one gate (the last one is used):";
+        printNames(validation.multiplyDriven);
+    }
+    if (!validation.undriven.empty()) {
+        out << "Warning: " << validation.undriven.size() << " undriven net(s) arrive at time 0:";
+        printNames(validation.undriven);
+    }
+    if (!validation.dangling.empty()) {
+        out << "Warning: " << validation.dangling.size() << " gate output(s) drive nothing:";
+        printNames(validation.dangling);
+    }
+    return validation.isClean();
+}
+
 
 // ============================================================================
 // TIMING ANALYZER IMPLEMENTATION
 // ============================================================================
 
+// Nodes per task when a level is split across threads
+const int PROPAGATION_GRAIN_SIZE = 1024;
+
+// Electrical estimates: slew as a fraction of arrival, load per driven pin
+const double SLEW_ARRIVAL_FRACTION = 0.1;
+const double BASE_CAPACITANCE = 1.0;
+const double CAPACITANCE_PER_FANOUT = 0.5;
+
 TimingAnalyzer::TimingAnalyzer(Circuit& circuit) 
-    : circuit(circuit), worstSlack(0.0), totalDelay(0.0) {
+    : circuit(circuit), timing(circuit.getTiming()), worstSlack(0.0), worstHoldSlack(0.0), totalDelay(0.0), threadCount(1),
+      partitionCount(1), maxPaths(100), pathsPerEndpoint(0), queryDelaysBound(false) {
+}
+
+void TimingAnalyzer::setThreadCount(int threads) {
+    if (threads < 1) threads = ThreadPool::defaultThreadCount();
+    threadCount = threads;
+    if (threadCount > 1) {
+        threadPool = make_unique<ThreadPool>(threadCount);
+    } else {
+        threadPool.reset();
+    }
 }
 
 void TimingAnalyzer::analyze() {
     cout << "Starting Static Timing Analysis..." << endl;
     
     // Reset previous analysis
-    resetAnalysis();
+    {
+        PhaseScope phase(metrics, "setup");
+        resetAnalysis();
+    }
     
-    // Step 1: Calculate arrival times (forward propagation)
-    cout << "Calculating arrival times..." << endl;
-    calculateArrivalTimes();
+    // Step 0: With a table library, gate delays follow from loads and slews
+    bool tableDelays = circuit.hasDelayTables();
+    if (tableDelays) {
+        cout << "Calculating gate delays from tables..." << endl;
+        PhaseScope phase(metrics, "delaycalc");
+        calculateGateDelays();
+    }
     
-    // Step 2: Calculate required times (backward propagation)
-    cout << "Calculating required times..." << endl;
-    calculateRequiredTimes();
+    // Steps 1-2: Calculate arrival times (forward propagation) and required
+    // times (backward propagation). With delay corners, one pass carries
+    // every corner at once; with partitions, worker processes do both.
+    bool multiCorner = !circuit.getCorners().empty();
+    if (partitionCount > 1 && multiCorner) {
+        cerr << "Warning: " << partitionCount
+             << " partitions requested, but delay corners are timed in one process" << endl;
+    }
+    if (partitionCount > 1 && !multiCorner) {
+        cout << "Calculating arrival and required times in " << partitionCount << " partitions..." << endl;
+        PhaseScope phase(metrics, "partitioned");
+        calculatePartitionedTimes();
+    } else {
+        cout << "Calculating arrival times..." << endl;
+        {
+            PhaseScope phase(metrics, "arrival");
+            if (multiCorner) {
+                calculateCornerArrivalTimes();
+            } else {
+                calculateArrivalTimes();
+            }
+        }
+        
+        cout << "Calculating required times..." << endl;
+        PhaseScope phase(metrics, "required");
+        if (multiCorner) {
+            calculateCornerRequiredTimes();
+        } else {
+            calculateRequiredTimes();
+        }
+    }
     
     // Step 3: Calculate slack times
     cout << "Calculating slack times..." << endl;
-    calculateSlackTimes();
+    {
+        PhaseScope phase(metrics, "slack");
+        calculateSlackTimes();
+        if (multiCorner) {
+            calculateCornerSlacks();
+        }
+        calculateStageResults();
+    }
     
-    // Step 4: Find all timing paths
+    // Steps 4-6: Find the worst timing paths, identify the critical ones and
+    // calculate the total delay
     cout << "Finding timing paths..." << endl;
-    findAllPaths();
-    
-    // Step 5: Identify critical paths
-    cout << "Identifying critical paths..." << endl;
-    findCriticalPaths();
-    
-    // Step 6: Calculate total delay
-    calculateTotalDelay();
+    {
+        PhaseScope phase(metrics, "paths");
+        findWorstPaths();
+        cout << "Identifying critical paths..." << endl;
+        findCriticalPaths();
+        calculateTotalDelay();
+    }
     
     // Step 7: Additional analysis
-    calculateSlewTimes();
-    calculateCapacitance();
-    calculateFanoutCounts();
+    {
+        PhaseScope phase(metrics, "electrical");
+        calculateFanoutCounts();
+        if (!tableDelays) {
+            calculateSlewTimes();
+            calculateCapacitance();
+        }
+    }
     
     cout << "Timing analysis completed!" << endl;
 }
 
 void TimingAnalyzer::calculateArrivalTimes() {
-    // Initialize arrival times for primary inputs
-    for (const auto& input : circuit.getPrimaryInputs()) {
-        auto node = circuit.getNode(input);
-        if (node) {
-            node->setArrivalTimeRise(0.0);
-            node->setArrivalTimeFall(0.0);
-            arrivalTimes[input] = 0.0;
-        }
-    }
-    
-    // Topological sort for forward propagation
-    queue<string> processQueue;
-    map<string, int> inDegree;
+    const TimingGraph& graph = circuit.getGraph();
+    timing.arrival.assign(graph.getNodeCount(), 0.0);
+    timing.earlyArrival.assign(graph.getNodeCount(), 0.0);
+    timing.worstFanin.assign(graph.getNodeCount(), INVALID_ID);
     
-    // Calculate in-degrees
-    for (const auto& gate : circuit.getGates()) {
-        for (const auto& input : gate->getInputs()) {
-            inDegree[input]++;
+    // Forward propagation level by level: primary inputs and undriven nodes
+    // sit on level 0 and keep arrival times of 0, register outputs on level 0
+    // launch at their clock-to-Q delay. Each pass computes the late and the
+    // early arrival together, so hold timing costs one more min per fanin
+    // rather than a second traversal.
+    launchRegisters(graph);
+    if (useStageTasks(graph)) {
+        propagateStages(graph, true);
+        return;
+    }
+    for (int level = 1; level < graph.getLevelCount(); ++level) {
+        propagateArrivalLevel(graph, level);
+    }
+}
+
+double TimingAnalyzer::latestArcArrival(const TimingGraph& graph, GateId gate,
+                                        const double* arrival, NodeId& worst) {
+    // Latest input arrival plus its timing arc, for MACRO gates
+    const NodeId* in = graph.faninBegin(gate);
+    const double* arc = graph.arcDelaysBegin(gate);
+    worst = *in;
+    double latest = arrival[*in] + *arc;
+    for (++in, ++arc; in != graph.faninEnd(gate); ++in, ++arc) {
+        if (arrival[*in] + *arc > latest) {
+            latest = arrival[*in] + *arc;
+            worst = *in;
         }
     }
-    
-    // Add primary inputs to queue
-    for (const auto& input : circuit.getPrimaryInputs()) {
-        processQueue.push(input);
+    return latest;
+}
+
+double TimingAnalyzer::earliestArcArrival(const TimingGraph& graph, GateId gate,
+                                          const double* earlyArrival) {
+    // Models keep only their worst arcs, so early arrivals use them too
+    const NodeId* in = graph.faninBegin(gate);
+    const double* arc = graph.arcDelaysBegin(gate);
+    double earliest = earlyArrival[*in] + *arc;
+    for (++in, ++arc; in != graph.faninEnd(gate); ++in, ++arc) {
+        earliest = min(earliest, earlyArrival[*in] + *arc);
     }
-    
-    // Process nodes in topological order
-    while (!processQueue.empty()) {
-        string currentNode = processQueue.front();
-        processQueue.pop();
-        
-        auto node = circuit.getNode(currentNode);
-        if (!node) continue;
+    return earliest;
+}
+
+TimingAnalyzer::EndpointConstraints TimingAnalyzer::getEndpointConstraints() const {
+    return {circuit.getClockPeriod(), circuit.getHoldTime(), circuit.getSetupTime(),
+            circuit.getRegisterHoldTime()};
+}
+
+void TimingAnalyzer::launchRegisters(const TimingGraph& graph) {
+    // Paths leave a register at its clock-to-Q delay; Q has no worst fanin
+    for (GateId reg : graph.getRegisters()) {
+        NodeId output = graph.getOutput(reg);
+        if (graph.getDriver(output) != reg) continue;
+        timing.arrival[output] = graph.getDelay(reg);
+        timing.earlyArrival[output] = graph.getDelay(reg);
+    }
+}
+
+void TimingAnalyzer::arriveNodes(const TimingGraph& graph, const NodeId* nodes, int begin, int end) {
+    // Raw pointers: stores through the vectors would make the compiler reload
+    // their data pointers on every fanin. The selects below are branch-free;
+    // which fanin is latest is close to a coin flip.
+    double* late = timing.arrival.data();
+    double* early = timing.earlyArrival.data();
+    NodeId* worstFanin = timing.worstFanin.data();
+    long long edges = 0;
+    for (int i = begin; i < end; ++i) {
+        NodeId node = nodes[i];
+        GateId driver = graph.getDriver(node);
         
-        // Process all fanout gates
-        for (const auto& gate : node->getFanouts()) {
-            // Calculate arrival time at gate output
-            vector<double> inputArrivalTimes;
-            for (const auto& input : gate->getInputs()) {
-                auto inputNode = circuit.getNode(input);
-                if (inputNode) {
-                    inputArrivalTimes.push_back(inputNode->getMaxArrivalTime());
-                }
-            }
-            
-            // Set gate delay from circuit configuration
-            double gateDelay = circuit.getGateDelay(gate->getType());
-            gate->setDelay(gateDelay);
-            double outputArrivalTime = gate->calculateDelay(inputArrivalTimes);
-            
-            // Update output node
-            string outputNode = gate->getOutput();
-            auto outputNodePtr = circuit.getNode(outputNode);
-            if (outputNodePtr) {
-                outputNodePtr->setArrivalTimeRise(outputArrivalTime);
-                outputNodePtr->setArrivalTimeFall(outputArrivalTime);
-                arrivalTimes[outputNode] = outputArrivalTime;
-            }
-            
-            // Decrease in-degree for output node
-            inDegree[outputNode]--;
-            if (inDegree[outputNode] == 0) {
-                processQueue.push(outputNode);
+        const NodeId* in = graph.faninBegin(driver);
+        const NodeId* inEnd = graph.faninEnd(driver);
+        edges += inEnd - in;
+        NodeId worst = *in;
+        double latest, earliest;
+        if (graph.hasArcDelays(driver)) {
+            latest = latestArcArrival(graph, driver, late, worst);
+            earliest = earliestArcArrival(graph, driver, early);
+        } else {
+            latest = late[*in];
+            earliest = early[*in];
+            for (++in; in != inEnd; ++in) {
+                double value = late[*in];
+                worst = value > latest ? *in : worst;
+                latest = max(latest, value);
+                earliest = min(earliest, early[*in]);
             }
         }
+        double delay = graph.getDelay(driver);
+        late[node] = latest + delay;
+        early[node] = earliest + delay;
+        worstFanin[node] = worst;
     }
+    metrics.addNodesVisited(end - begin);
+    metrics.addEdgesVisited(edges);
 }
 
-void TimingAnalyzer::calculateRequiredTimes() {
-    // Initialize required times for primary outputs
-    double clockPeriod = circuit.getClockPeriod();
-    for (const auto& output : circuit.getPrimaryOutputs()) {
-        auto node = circuit.getNode(output);
-        if (node) {
-            node->setRequiredTimeRise(clockPeriod);
-            node->setRequiredTimeFall(clockPeriod);
-            requiredTimes[output] = clockPeriod;
-        }
+void TimingAnalyzer::propagateArrivalLevel(const TimingGraph& graph, int level) {
+    const NodeId* levelNodes = graph.levelBegin(level);
+    auto body = [&](int begin, int end) {
+        arriveNodes(graph, levelNodes, begin, end);
+    };
+    
+    if (threadPool) {
+        threadPool->parallelFor(graph.getLevelSize(level), PROPAGATION_GRAIN_SIZE, body);
+    } else {
+        body(0, graph.getLevelSize(level));
     }
+}
+
+void TimingAnalyzer::calculateRequiredTimes() {
+    const TimingGraph& graph = circuit.getGraph();
     
-    // Backward propagation using reverse topological order
-    queue<string> processQueue;
-    map<string, int> outDegree;
+    // Nodes that reach no endpoint stay unconstrained
+    timing.required.assign(graph.getNodeCount(), numeric_limits<double>::infinity());
+    timing.holdRequired.assign(graph.getNodeCount(), -numeric_limits<double>::infinity());
     
-    // Calculate out-degrees
-    for (const auto& gate : circuit.getGates()) {
-        outDegree[gate->getOutput()]++;
+    // Backward propagation from the deepest level: every node pulls from the
+    // gates it drives, whose outputs all sit on higher levels. Setup (min)
+    // and hold (max) required times share the pass.
+    if (useStageTasks(graph)) {
+        propagateStages(graph, false);
+        return;
     }
-    
-    // Add primary outputs to queue
-    for (const auto& output : circuit.getPrimaryOutputs()) {
-        processQueue.push(output);
+    EndpointConstraints constraints = getEndpointConstraints();
+    for (int level = graph.getLevelCount() - 1; level >= 0; --level) {
+        propagateRequiredLevel(graph, level, constraints);
     }
-    
-    // Process nodes in reverse topological order
-    while (!processQueue.empty()) {
-        string currentNode = processQueue.front();
-        processQueue.pop();
-        
-        auto node = circuit.getNode(currentNode);
-        if (!node) continue;
+}
+
+void TimingAnalyzer::requireNodes(const TimingGraph& graph, const NodeId* nodes, int begin, int end,
+                                  const EndpointConstraints& constraints) {
+    // Walks the nodes backwards, so a stage's level order works as well as
+    // a single level
+    double* setup = timing.required.data();
+    double* hold = timing.holdRequired.data();
+    bool registers = graph.hasRegisters();
+    double capture = constraints.clockPeriod - constraints.setupTime;
+    long long edges = 0;
+    for (int i = end - 1; i >= begin; --i) {
+        NodeId node = nodes[i];
+        bool isOutput = graph.isOutput(node);
+        double required = isOutput ? constraints.clockPeriod : numeric_limits<double>::infinity();
+        double holdRequired = isOutput ? constraints.holdTime : -numeric_limits<double>::infinity();
         
-        // Process fanin gate
-        auto faninGate = node->getFanin();
-        if (faninGate) {
-            double gateDelay = circuit.getGateDelay(faninGate->getType());
-            double inputRequiredTime = node->getMinRequiredTime() - gateDelay;
-            
-            // Update input nodes
-            for (const auto& input : faninGate->getInputs()) {
-                auto inputNode = circuit.getNode(input);
-                if (inputNode) {
-                    inputNode->setRequiredTimeRise(inputRequiredTime);
-                    inputNode->setRequiredTimeFall(inputRequiredTime);
-                    requiredTimes[input] = inputRequiredTime;
-                }
-                
-                // Decrease out-degree for input node
-                outDegree[input]--;
-                if (outDegree[input] == 0) {
-                    processQueue.push(input);
-                }
+        edges += graph.getFanoutCount(node);
+        for (const GateId* g = graph.fanoutBegin(node); g != graph.fanoutEnd(node); ++g) {
+            NodeId output = graph.getOutput(*g);
+            if (graph.getDriver(output) != *g) continue;
+            if (registers && graph.isRegister(*g)) {
+                // A register data input ends the path
+                required = min(required, capture);
+                holdRequired = max(holdRequired, constraints.registerHoldTime);
+                continue;
             }
+            double delay = graph.getFanoutDelay(g);
+            required = min(required, setup[output] - delay);
+            holdRequired = max(holdRequired, hold[output] - delay);
         }
+        setup[node] = required;
+        hold[node] = holdRequired;
     }
+    metrics.addNodesVisited(end - begin);
+    metrics.addEdgesVisited(edges);
 }
 
-void TimingAnalyzer::calculateSlackTimes() {
-    for (const auto& nodePair : circuit.getNodes()) {
-        const string& nodeName = nodePair.first;
-        auto node = nodePair.second;
-        
-        double arrivalTime = node->getMaxArrivalTime();
-        double requiredTime = node->getMinRequiredTime();
-        double slack = requiredTime - arrivalTime;
-        
-        node->setSlackRise(slack);
-        node->setSlackFall(slack);
-        slackTimes[nodeName] = slack;
-    }
+void TimingAnalyzer::propagateRequiredLevel(const TimingGraph& graph, int level,
+                                            const EndpointConstraints& constraints) {
+    const NodeId* levelNodes = graph.levelBegin(level);
+    auto body = [&](int begin, int end) {
+        requireNodes(graph, levelNodes, begin, end, constraints);
+    };
     
-    updateWorstSlack();
+    if (threadPool) {
+        threadPool->parallelFor(graph.getLevelSize(level), PROPAGATION_GRAIN_SIZE, body);
+    } else {
+        body(0, graph.getLevelSize(level));
+    }
 }
 
-void TimingAnalyzer::findAllPaths() {
-    allPaths.clear();
-    
-    for (const auto& input : circuit.getPrimaryInputs()) {
-        vector<string> currentPath;
-        map<string, bool> visited;
-        findPathsRecursive(input, currentPath, visited);
+bool TimingAnalyzer::useStageTasks(const TimingGraph& graph) const {
+    // One task per stage skips the barrier after every level, but only pays
+    // off when the stages are small enough to spread over the pool
+    if (!threadPool || !graph.hasRegisters() || graph.getStageCount() < 2) return false;
+    int stagedNodes = 0;
+    int largest = 0;
+    for (int stage = 0; stage < graph.getStageCount(); ++stage) {
+        stagedNodes += graph.getStageSize(stage);
+        largest = max(largest, graph.getStageSize(stage));
     }
+    return static_cast<long long>(largest) * threadCount <= stagedNodes;
 }
 
-void TimingAnalyzer::findPathsRecursive(const string& currentNode, 
-                                       vector<string>& currentPath,
-                                       map<string, bool>& visited) {
-    if (visited[currentNode]) return; // Avoid cycles
+void TimingAnalyzer::propagateStages(const TimingGraph& graph, bool arrivals) {
+    // Largest stages first, so the small ones fill in at the end
+    vector<int> order(graph.getStageCount());
+    for (int stage = 0; stage < graph.getStageCount(); ++stage) order[stage] = stage;
+    stable_sort(order.begin(), order.end(), [&](int a, int b) {
+        return graph.getStageSize(a) > graph.getStageSize(b);
+    });
     
-    visited[currentNode] = true;
-    currentPath.push_back(currentNode);
-    
-    auto node = circuit.getNode(currentNode);
-    if (!node) return;
-    
-    // If this is a primary output, we found a complete path
-    if (node->isOutput()) {
-        TimingPath path;
-        path.nodes = currentPath;
-        path.totalDelay = calculatePathDelay(currentPath);
-        path.slack = node->getWorstSlack();
-        path.isCritical = (path.slack <= 0.0);
-        allPaths.push_back(path);
-    } else {
-        // Continue with fanout gates
-        for (const auto& gate : node->getFanouts()) {
-            string nextNode = gate->getOutput();
-            findPathsRecursive(nextNode, currentPath, visited);
+    EndpointConstraints constraints = getEndpointConstraints();
+    threadPool->parallelFor(graph.getStageCount(), 1, [&](int begin, int end) {
+        for (int i = begin; i < end; ++i) {
+            int stage = order[i];
+            if (arrivals) {
+                arriveNodes(graph, graph.stageBegin(stage), 0, graph.getStageSize(stage));
+            } else {
+                requireNodes(graph, graph.stageBegin(stage), 0, graph.getStageSize(stage), constraints);
+            }
         }
-    }
+    });
     
-    // Backtrack
-    visited[currentNode] = false;
-    currentPath.pop_back();
+    // Sources belong to no stage; their required times need every stage
+    // they feed
+    if (!arrivals && graph.getLevelCount() > 0) {
+        propagateRequiredLevel(graph, 0, constraints);
+    }
+}
+
+void TimingAnalyzer::calculatePartitionedTimes() {
+    const TimingGraph& graph = circuit.getGraph();
+    EndpointConstraints constraints = getEndpointConstraints();
+    PartitionedAnalysis analysis(graph, partitionCount, constraints.clockPeriod, constraints.holdTime,
+                                 constraints.setupTime, constraints.registerHoldTime);
+    analysis.run(timing);
+    metrics.addNodesVisited(analysis.getNodesVisited());
+    metrics.addEdgesVisited(analysis.getEdgesVisited());
+    cout << "  " << analysis.getPartitionCount() << " partitions, " << analysis.getCutEdgeCount()
+         << " cut edges, " << analysis.getBoundaryNodeCount() << " boundary nodes, converged in "
+         << analysis.getRoundCount() << " rounds" << endl;
 }
 
-double TimingAnalyzer::calculatePathDelay(const vector<string>& path) const {
-    double totalDelay = 0.0;
+void TimingAnalyzer::calculateCornerArrivalTimes() {
+    const TimingGraph& graph = circuit.getGraph();
+    int nodeCount = graph.getNodeCount();
+    const vector<DelayCorner>& corners = circuit.getCorners();
+    cornerTiming.reset(nodeCount, corners);
     
-    for (size_t i = 0; i < path.size() - 1; ++i) {
-        auto node = circuit.getNode(path[i]);
-        if (!node) continue;
-        
-        for (const auto& gate : node->getFanouts()) {
-            if (gate->getOutput() == path[i + 1]) {
-                totalDelay += circuit.getGateDelay(gate->getType());
-                break;
+    // Corners with tables bind a delay per gate, as the primary library does
+    bool tables = false;
+    for (size_t c = 1; c < corners.size(); ++c) tables = tables || corners[c].tables.hasTables();
+    if (tables) {
+        int stride = cornerTiming.stride;
+        cornerTiming.gateDelay.assign(static_cast<size_t>(graph.getGateCount()) * stride, 0.0);
+        vector<double> delays;
+        for (size_t c = 1; c < corners.size(); ++c) {
+            circuit.calculateCornerDelays(static_cast<int>(c), delays);
+            for (GateId gate = 0; gate < graph.getGateCount(); ++gate) {
+                cornerTiming.gateDelay[static_cast<size_t>(gate) * stride + c] = delays[gate];
             }
         }
     }
     
-    return totalDelay;
-}
-
-void TimingAnalyzer::findCriticalPaths() {
+    // Register outputs launch at each corner's clock-to-Q
+    for (GateId reg : graph.getRegisters()) {
+        NodeId output = graph.getOutput(reg);
+        if (graph.getDriver(output) != reg) continue;
+        const double* launch = cornerTiming.delayOf(graph, reg);
+        double* out = cornerTiming.arrivalOf(output);
+        double* early = cornerTiming.earlyArrivalOf(output);
+        copy(launch, launch + cornerTiming.stride, out);
+        copy(launch, launch + cornerTiming.stride, early);
+        out[0] = graph.getDelay(reg);
+        early[0] = graph.getDelay(reg);
+    }
+    
+    for (int level = 1; level < graph.getLevelCount(); ++level) {
+        propagateCornerArrivalLevel(graph, level);
+    }
+    
+    timing.arrival.resize(nodeCount);
+    for (NodeId node = 0; node < nodeCount; ++node) {
+        timing.arrival[node] = cornerTiming.arrivalOf(node)[0];
+    }
+    
+    // Worst fanins and early arrivals follow the primary corner; inputs come
+    // first in level order
+    timing.worstFanin.assign(nodeCount, INVALID_ID);
+    timing.earlyArrival.assign(nodeCount, 0.0);
+    launchRegisters(graph);
+    for (int level = 1; level < graph.getLevelCount(); ++level) {
+        const NodeId* levelNodes = graph.levelBegin(level);
+        for (int i = 0; i < graph.getLevelSize(level); ++i) {
+            GateId driver = graph.getDriver(levelNodes[i]);
+            const NodeId* in = graph.faninBegin(driver);
+            NodeId worst = *in;
+            double earliest;
+            if (graph.hasArcDelays(driver)) {
+                latestArcArrival(graph, driver, timing.arrival.data(), worst);
+                earliest = earliestArcArrival(graph, driver, timing.earlyArrival.data());
+            } else {
+                earliest = timing.earlyArrival[*in];
+                for (++in; in != graph.faninEnd(driver); ++in) {
+                    if (timing.arrival[*in] > timing.arrival[worst]) worst = *in;
+                    earliest = min(earliest, timing.earlyArrival[*in]);
+                }
+            }
+            timing.worstFanin[levelNodes[i]] = worst;
+            timing.earlyArrival[levelNodes[i]] = earliest + graph.getDelay(driver);
+            cornerTiming.earlyArrivalOf(levelNodes[i])[0] = timing.earlyArrival[levelNodes[i]];
+        }
+    }
+}
+
+void TimingAnalyzer::propagateCornerArrivalLevel(const TimingGraph& graph, int level) {
+    const NodeId* levelNodes = graph.levelBegin(level);
+    int stride = cornerTiming.stride;
+    auto body = [&](int begin, int end) {
+        long long edges = 0;
+        for (int i = begin; i < end; ++i) {
+            NodeId node = levelNodes[i];
+            GateId driver = graph.getDriver(node);
+            
+            const NodeId* in = graph.faninBegin(driver);
+            const NodeId* inEnd = graph.faninEnd(driver);
+            edges += inEnd - in;
+            const double* delay = cornerTiming.delayOf(graph, driver);
+            double* out = cornerTiming.arrivalOf(node);
+            double* early = cornerTiming.earlyArrivalOf(node);
+            if (graph.hasArcDelays(driver)) {
+                // Timing model arcs are the same in every corner
+                const double* arc = graph.arcDelaysBegin(driver);
+                for (int lane = 0; lane < stride; ++lane) {
+                    double latest = -numeric_limits<double>::infinity();
+                    double earliest = numeric_limits<double>::infinity();
+                    for (int pin = 0; in + pin != inEnd; ++pin) {
+                        latest = max(latest, cornerTiming.arrivalOf(in[pin])[lane] + arc[pin]);
+                        earliest = min(earliest, cornerTiming.earlyArrivalOf(in[pin])[lane] + arc[pin]);
+                    }
+                    out[lane] = latest + delay[lane];
+                    early[lane] = earliest + delay[lane];
+                }
+                out[0] += graph.getDelay(driver);
+                continue;
+            }
+            for (int lane = 0; lane < stride; lane += SIMD_WIDTH) {
+                const NodeId* pin = in;
+                SimdDouble latest = simdLoad(cornerTiming.arrivalOf(*pin) + lane);
+                SimdDouble earliest = simdLoad(cornerTiming.earlyArrivalOf(*pin) + lane);
+                for (++pin; pin != inEnd; ++pin) {
+                    latest = simdMax(latest, simdLoad(cornerTiming.arrivalOf(*pin) + lane));
+                    earliest = simdMin(earliest, simdLoad(cornerTiming.earlyArrivalOf(*pin) + lane));
+                }
+                SimdDouble gateDelay = simdLoad(delay + lane);
+                simdStore(out + lane, simdAdd(latest, gateDelay));
+                simdStore(early + lane, simdAdd(earliest, gateDelay));
+            }
+            // Lane 0 added a zero delay above; its early arrival is redone
+            // exactly by calculateCornerArrivalTimes
+            out[0] += graph.getDelay(driver);
+        }
+        metrics.addNodesVisited(end - begin);
+        metrics.addEdgesVisited(edges);
+    };
+    
+    if (threadPool) {
+        threadPool->parallelFor(graph.getLevelSize(level), PROPAGATION_GRAIN_SIZE, body);
+    } else {
+        body(0, graph.getLevelSize(level));
+    }
+}
+
+void TimingAnalyzer::calculateCornerRequiredTimes() {
+    const TimingGraph& graph = circuit.getGraph();
+    int nodeCount = graph.getNodeCount();
+    fill(cornerTiming.required.begin(), cornerTiming.required.end(),
+         numeric_limits<double>::infinity());
+    fill(cornerTiming.holdRequired.begin(), cornerTiming.holdRequired.end(),
+         -numeric_limits<double>::infinity());
+    timing.holdRequired.assign(nodeCount, -numeric_limits<double>::infinity());
+    
+    for (int level = graph.getLevelCount() - 1; level >= 0; --level) {
+        propagateCornerRequiredLevel(graph, level);
+    }
+    
+    timing.required.resize(nodeCount);
+    for (NodeId node = 0; node < nodeCount; ++node) {
+        timing.required[node] = cornerTiming.requiredOf(node)[0];
+    }
+}
+
+void TimingAnalyzer::propagateCornerRequiredLevel(const TimingGraph& graph, int level) {
+    const NodeId* levelNodes = graph.levelBegin(level);
+    int stride = cornerTiming.stride;
+    EndpointConstraints constraints = getEndpointConstraints();
+    double clockPeriod = constraints.clockPeriod;
+    double capture = clockPeriod - constraints.setupTime;
+    bool registers = graph.hasRegisters();
+    SimdDouble clockVector = simdBroadcast(clockPeriod);
+    SimdDouble holdVector = simdBroadcast(constraints.holdTime);
+    SimdDouble unconstrained = simdBroadcast(numeric_limits<double>::infinity());
+    SimdDouble unconstrainedHold = simdBroadcast(-numeric_limits<double>::infinity());
+    auto body = [&](int begin, int end) {
+        long long edges = 0;
+        for (int i = begin; i < end; ++i) {
+            NodeId node = levelNodes[i];
+            double* out = cornerTiming.requiredOf(node);
+            double* hold = cornerTiming.holdRequiredOf(node);
+            bool isOutput = graph.isOutput(node);
+            const GateId* fanoutBegin = graph.fanoutBegin(node);
+            const GateId* fanoutEnd = graph.fanoutEnd(node);
+            edges += fanoutEnd - fanoutBegin;
+            for (int lane = 0; lane < stride; lane += SIMD_WIDTH) {
+                // Each corner captures at registers with its own setup and hold time
+                SimdDouble capture = simdSub(clockVector, simdLoad(cornerTiming.setupTime.data() + lane));
+                SimdDouble registerHold = simdLoad(cornerTiming.registerHoldTime.data() + lane);
+                SimdDouble required = isOutput ? clockVector : unconstrained;
+                SimdDouble holdRequired = isOutput ? holdVector : unconstrainedHold;
+                for (const GateId* g = fanoutBegin; g != fanoutEnd; ++g) {
+                    NodeId output = graph.getOutput(*g);
+                    if (graph.getDriver(output) != *g) continue;
+                    if (registers && graph.isRegister(*g)) {
+                        required = simdMin(required, capture);
+                        holdRequired = simdMax(holdRequired, registerHold);
+                        continue;
+                    }
+                    SimdDouble delay = simdLoad(cornerTiming.delayOf(graph, *g) + lane);
+                    if (graph.hasArcDelays(*g)) {
+                        delay = simdAdd(delay, simdBroadcast(graph.getFanoutArc(g)));
+                    }
+                    required = simdMin(required, simdSub(simdLoad(cornerTiming.requiredOf(output) + lane), delay));
+                    holdRequired = simdMax(holdRequired,
+                                           simdSub(simdLoad(cornerTiming.holdRequiredOf(output) + lane), delay));
+                }
+                simdStore(out + lane, required);
+                simdStore(hold + lane, holdRequired);
+            }
+            // Lane 0 uses the bound per-gate delays
+            double primary = isOutput ? clockPeriod : numeric_limits<double>::infinity();
+            double holdRequired = isOutput ? constraints.holdTime : -numeric_limits<double>::infinity();
+            for (const GateId* g = fanoutBegin; g != fanoutEnd; ++g) {
+                NodeId output = graph.getOutput(*g);
+                if (graph.getDriver(output) != *g) continue;
+                if (registers && graph.isRegister(*g)) {
+                    primary = min(primary, capture);
+                    holdRequired = max(holdRequired, constraints.registerHoldTime);
+                    continue;
+                }
+                double delay = graph.getFanoutDelay(g);
+                primary = min(primary, cornerTiming.requiredOf(output)[0] - delay);
+                holdRequired = max(holdRequired, timing.holdRequired[output] - delay);
+            }
+            out[0] = primary;
+            hold[0] = holdRequired;
+            timing.holdRequired[node] = holdRequired;
+        }
+        metrics.addNodesVisited(end - begin);
+        metrics.addEdgesVisited(edges);
+    };
+    
+    if (threadPool) {
+        threadPool->parallelFor(graph.getLevelSize(level), PROPAGATION_GRAIN_SIZE, body);
+    } else {
+        body(0, graph.getLevelSize(level));
+    }
+}
+
+void TimingAnalyzer::calculateCornerSlacks() {
+    const TimingGraph& graph = circuit.getGraph();
+    const vector<DelayCorner>& corners = circuit.getCorners();
+    vector<double> slacks = cornerTiming.minSlackPerCorner(0.0);
+    vector<double> holdSlacks = cornerTiming.minHoldSlackPerCorner(0.0);
+    metrics.addNodesVisited(graph.getNodeCount());
+    
+    cornerResults.clear();
+    vector<NodeId> endpoints = graph.getEndpoints();
+    for (size_t c = 0; c < corners.size(); ++c) {
+        double delay = 0.0;
+        for (NodeId endpoint : endpoints) {
+            if (graph.getDriver(endpoint) == INVALID_ID || graph.getLevel(endpoint) < 0) continue;
+            delay = max(delay, cornerTiming.arrivalOf(endpoint)[c]);
+        }
+        cornerResults.push_back({corners[c].name, slacks[c], delay, holdSlacks[c]});
+    }
+}
+
+double TimingAnalyzer::getMergedWorstSlack() const {
+    double merged = worstSlack;
+    for (const auto& result : cornerResults) {
+        merged = min(merged, result.worstSlack);
+    }
+    return merged;
+}
+
+double TimingAnalyzer::getMergedWorstHoldSlack() const {
+    double merged = worstHoldSlack;
+    for (const auto& result : cornerResults) {
+        merged = min(merged, result.worstHoldSlack);
+    }
+    return merged;
+}
+
+void TimingAnalyzer::calculateSlackTimes() {
+    const TimingGraph& graph = circuit.getGraph();
+    int nodeCount = graph.getNodeCount();
+    timing.slack.resize(nodeCount);
+    timing.computeSlack(0, nodeCount);
+    timing.holdSlack.resize(nodeCount);
+    timing.computeHoldSlack(0, nodeCount);
+    metrics.addNodesVisited(nodeCount);
+    
+    updateWorstSlack();
+}
+
+void TimingAnalyzer::calculateStageResults() {
+    stageResults.clear();
+    const TimingGraph& graph = circuit.getGraph();
+    if (!graph.hasRegisters()) return;
+    
+    stageResults.resize(graph.getStageCount());
+    auto body = [&](int begin, int end) {
+        for (int stage = begin; stage < end; ++stage) {
+            StageResult result = {graph.getStageSize(stage), string(), numeric_limits<double>::infinity(),
+                                  numeric_limits<double>::infinity()};
+            NodeId worst = INVALID_ID;
+            for (const NodeId* node = graph.stageBegin(stage); node != graph.stageEnd(stage); ++node) {
+                if (!graph.isOutput(*node) && !graph.isRegisterInput(*node)) continue;
+                if (worst == INVALID_ID || timing.slack[*node] < result.worstSlack) {
+                    worst = *node;
+                    result.worstSlack = timing.slack[*node];
+                }
+                result.worstHoldSlack = min(result.worstHoldSlack, timing.holdSlack[*node]);
+            }
+            if (worst != INVALID_ID) result.worstEndpoint = graph.getNodeName(worst);
+            stageResults[stage] = result;
+        }
+    };
+    if (threadPool) {
+        threadPool->parallelFor(graph.getStageCount(), 16, body);
+    } else {
+        body(0, graph.getStageCount());
+    }
+    metrics.addNodesVisited(graph.getNodeCount());
+}
+
+void TimingAnalyzer::setPathLimits(int maxPathCount, int pathsPerEndpointCount) {
+    maxPaths = maxPathCount;
+    pathsPerEndpoint = pathsPerEndpointCount;
+}
+
+void TimingAnalyzer::findWorstPaths() {
+    allPaths.clear();
+    
+    const TimingGraph& graph = circuit.getGraph();
+    PathSearch search(graph, timing.arrival, timing.worstFanin, circuit.getClockPeriod(),
+                      circuit.getSetupTime());
+    if (pathsPerEndpoint <= 0) {
+        for (const auto& record : search.worstPaths(maxPaths)) {
+            allPaths.push_back(makeTimingPath(graph, record));
+        }
+    } else {
+        for (NodeId endpoint : graph.getEndpoints()) {
+            for (const auto& record : search.worstPathsTo(endpoint, pathsPerEndpoint)) {
+                allPaths.push_back(makeTimingPath(graph, record));
+            }
+        }
+    }
+    metrics.addNodesVisited(search.getTracedNodeCount());
+    metrics.addPathExpansions(search.getExpansionCount());
+    if (pathsPerEndpoint <= 0) return;
+    
+    stable_sort(allPaths.begin(), allPaths.end(),
+                [](const TimingPath& a, const TimingPath& b) {
+                    return a.slack < b.slack;
+                });
+    if (maxPaths > 0 && static_cast<int>(allPaths.size()) > maxPaths) {
+        allPaths.resize(maxPaths);
+    }
+}
+
+vector<TimingPath> TimingAnalyzer::getWorstPaths(int k) {
+    const TimingGraph& graph = circuit.getGraph();
+    PathSearch search(graph, timing.arrival, timing.worstFanin, circuit.getClockPeriod(),
+                      circuit.getSetupTime());
+    vector<TimingPath> paths;
+    for (const auto& record : search.worstPaths(k)) {
+        paths.push_back(makeTimingPath(graph, record));
+    }
+    return paths;
+}
+
+vector<TimingPath> TimingAnalyzer::getWorstPathsTo(const string& endpoint, int k) {
+    const TimingGraph& graph = circuit.getGraph();
+    NodeId id = graph.findNode(endpoint);
+    if (id == INVALID_ID) {
+        throw runtime_error("Unknown endpoint: " + endpoint);
+    }
+    
+    PathSearch search(graph, timing.arrival, timing.worstFanin, circuit.getClockPeriod(),
+                      circuit.getSetupTime());
+    vector<TimingPath> paths;
+    for (const auto& record : search.worstPathsTo(id, k)) {
+        paths.push_back(makeTimingPath(graph, record));
+    }
+    return paths;
+}
+
+TimingPath TimingAnalyzer::worstPathTo(const string& nodeName) {
+    const TimingGraph& graph = circuit.getGraph();
+    NodeId node = graph.findNode(nodeName);
+    if (node == INVALID_ID) {
+        throw runtime_error("Unknown node: " + nodeName);
+    }
+    if (!hasTiming()) {
+        throw runtime_error("No timing results; run analyze() first");
+    }
+    
+    // Stage delays are summed from the endpoint back, as PathSearch does, so
+    // the total matches the worst path it reports bit for bit
+    PathRecord record;
+    record.arrival = 0.0;
+    record.nodes.push_back(node);
+    for (NodeId id = node; graph.getLevel(id) >= 0 && timing.worstFanin[id] != INVALID_ID;
+         id = timing.worstFanin[id]) {
+        record.arrival += graph.getStageDelay(graph.getDriver(id), timing.worstFanin[id]);
+        record.nodes.push_back(timing.worstFanin[id]);
+    }
+    record.arrival += graph.getLaunchDelay(record.nodes.back());
+    reverse(record.nodes.begin(), record.nodes.end());
+    record.slack = timing.required[node] - record.arrival;
+    return makeTimingPath(graph, record);
+}
+
+NodeTiming TimingAnalyzer::queryTiming(const string& nodeName) {
+    const TimingGraph& graph = circuit.getGraph();
+    NodeId node = graph.findNode(nodeName);
+    if (node == INVALID_ID) {
+        throw runtime_error("Unknown node: " + nodeName);
+    }
+    if (hasTiming()) {
+        return {timing.arrival[node], timing.required[node], timing.slack[node],
+                timing.earlyArrival[node], timing.holdRequired[node], timing.holdSlack[node]};
+    }
+
+    // Table delays hang on slews from outside any one cone, so they are bound
+    // for the whole netlist once, as analyze() would
+    if (circuit.hasDelayTables() && !queryDelaysBound) {
+        circuit.calculateDelays();
+        queryDelaysBound = true;
+    }
+    EndpointConstraints constraints = getEndpointConstraints();
+    return timingQuery.query(graph, node, constraints.clockPeriod, constraints.holdTime,
+                             constraints.setupTime, constraints.registerHoldTime);
+}
+
+void TimingAnalyzer::resetQueries() {
+    timingQuery.clear();
+    queryDelaysBound = false;
+}
+
+TimingPath TimingAnalyzer::makeTimingPath(const TimingGraph& graph,
+                                          const PathRecord& record) const {
+    TimingPath path;
+    path.nodes.reserve(record.nodes.size());
+    path.stageDelays.reserve(record.nodes.size());
+    for (size_t i = 0; i < record.nodes.size(); ++i) {
+        NodeId id = record.nodes[i];
+        path.nodes.push_back(graph.getNodeName(id));
+        double stage = i == 0 ? graph.getLaunchDelay(id)
+                              : graph.getStageDelay(graph.getDriver(id), record.nodes[i - 1]);
+        path.stageDelays.push_back(stage);
+    }
+    path.totalDelay = record.arrival;
+    path.slack = record.slack;
+    path.isCritical = (path.slack <= 0.0);
+    return path;
+}
+
+void TimingAnalyzer::findCriticalPaths() {
     criticalPaths.clear();
     
     for (const auto& path : allPaths) {
@@ -504,123 +1636,597 @@ void TimingAnalyzer::findCriticalPaths() {
 void TimingAnalyzer::calculateTotalDelay() {
     totalDelay = 0.0;
     
-    for (const auto& path : allPaths) {
-        totalDelay = max(totalDelay, path.totalDelay);
+    // The longest path ends at the latest-arriving driven endpoint
+    const TimingGraph& graph = circuit.getGraph();
+    for (NodeId endpoint : graph.getEndpoints()) {
+        if (graph.getDriver(endpoint) == INVALID_ID || graph.getLevel(endpoint) < 0) continue;
+        totalDelay = max(totalDelay, timing.arrival[endpoint]);
     }
 }
 
 void TimingAnalyzer::calculateSlewTimes() {
-    // Simple slew calculation 
-    for (const auto& nodePair : circuit.getNodes()) {
-        auto node = nodePair.second;
-        double arrivalTime = node->getMaxArrivalTime();
-        node->setSlewRise(arrivalTime * 0.1); // 10% of arrival time
-        node->setSlewFall(arrivalTime * 0.1);
-    }
+    // Simple slew calculation: 10% of arrival time
+    timing.computeSlew(SLEW_ARRIVAL_FRACTION);
+    metrics.addNodesVisited(static_cast<long long>(timing.slew.size()));
 }
 
 void TimingAnalyzer::calculateCapacitance() {
-    for (const auto& nodePair : circuit.getNodes()) {
-        auto node = nodePair.second;
-        double capacitance = 1.0 + node->getFanouts().size() * 0.5;
-        node->setCapacitance(capacitance);
+    // Load grows with the pins driven, so this needs the fanout counts
+    const TimingGraph& graph = circuit.getGraph();
+    if (timing.fanoutCount.size() != static_cast<size_t>(graph.getNodeCount())) {
+        calculateFanoutCounts();
     }
+    timing.computeCapacitance(BASE_CAPACITANCE, CAPACITANCE_PER_FANOUT);
+    metrics.addNodesVisited(graph.getNodeCount());
+}
+
+void TimingAnalyzer::calculateGateDelays() {
+    // Slew and capacitance come out of the same pass
+    const TimingGraph& graph = circuit.getGraph();
+    circuit.calculateDelays();
+    const DelayCalculator& calculator = circuit.getDelayCalculator();
+    metrics.addNodesVisited(graph.getNodeCount());
+    metrics.addEdgesVisited(graph.getEdgeCount());
+    cout << "  " << calculator.getLookupCount() << " table lookups, "
+         << calculator.getCacheHitCount() << " from cache" << endl;
 }
 
 void TimingAnalyzer::calculateFanoutCounts() {
-    for (const auto& nodePair : circuit.getNodes()) {
-        auto node = nodePair.second;
-        node->setFanoutCount(node->getFanouts().size());
+    const TimingGraph& graph = circuit.getGraph();
+    timing.fanoutCount.resize(graph.getNodeCount());
+    for (NodeId id = 0; id < graph.getNodeCount(); ++id) {
+        timing.fanoutCount[id] = graph.getFanoutCount(id);
     }
+    metrics.addNodesVisited(graph.getNodeCount());
+    metrics.addEdgesVisited(graph.getEdgeCount());
 }
 
+void TimingAnalyzer::updateWorstSlack() {
+    worstSlack = timing.minSlack(0.0);
+    worstHoldSlack = timing.minHoldSlack(0.0);
+}
 
+// ============================================================================
+// INCREMENTAL (ECO) UPDATES
+// ============================================================================
 
-void TimingAnalyzer::updateWorstSlack() {
-    worstSlack = 0.0;
+void TimingAnalyzer::setGateDelay(const string& gateName, double delay) {
+    circuit.setGateDelay(gateName, delay);
+    if (!hasTiming()) {
+        resetQueries();
+        return;
+    }
     
-    for (const auto& slackPair : slackTimes) {
-        worstSlack = min(worstSlack, slackPair.second);
+    const TimingGraph& graph = circuit.getLiveGraph();
+    GateId gate = graph.findGate(gateName);
+    retime(graph, vector<NodeId>(1, graph.getOutput(gate)),
+           vector<NodeId>(graph.faninBegin(gate), graph.faninEnd(gate)));
+}
+
+void TimingAnalyzer::setGateType(const string& gateName, const string& type) {
+    circuit.setGateType(gateName, type);
+    if (!hasTiming()) {
+        resetQueries();
+        return;
+    }
+    
+    // The new type loads its inputs with its own pin capacitance
+    const TimingGraph& graph = circuit.getLiveGraph();
+    GateId gate = graph.findGate(gateName);
+    vector<NodeId> forwardSeeds(1, graph.getOutput(gate));
+    vector<NodeId> backwardSeeds(graph.faninBegin(gate), graph.faninEnd(gate));
+    recalculateDelays(graph, backwardSeeds, forwardSeeds, backwardSeeds);
+    retime(graph, forwardSeeds, backwardSeeds);
+}
+
+void TimingAnalyzer::addGate(const string& type, const string& name,
+                             const vector<string>& inputs, const string& output) {
+    if (!hasTiming()) {
+        circuit.addGate(type, name, inputs, output);
+        resetQueries();
+        return;
+    }
+    
+    // A gate that used to drive the output stops counting as its driver
+    const TimingGraph& graph = circuit.getLiveGraph();
+    vector<NodeId> backwardSeeds;
+    NodeId outputId = graph.findNode(output);
+    if (outputId != INVALID_ID && graph.getDriver(outputId) != INVALID_ID) {
+        GateId previous = graph.getDriver(outputId);
+        backwardSeeds.assign(graph.faninBegin(previous), graph.faninEnd(previous));
+    }
+    
+    circuit.addGate(type, name, inputs, output);
+    GateId gate = graph.findGate(name);
+    if (gate == INVALID_ID) return;
+    
+    resizeTiming(graph);
+    backwardSeeds.insert(backwardSeeds.end(), graph.faninBegin(gate), graph.faninEnd(gate));
+    vector<NodeId> forwardSeeds(1, graph.getOutput(gate));
+    recalculateDelays(graph, vector<NodeId>(graph.faninBegin(gate), graph.faninEnd(gate)),
+                      forwardSeeds, backwardSeeds);
+    retime(graph, forwardSeeds, backwardSeeds);
+}
+
+void TimingAnalyzer::removeGate(const string& gateName) {
+    const TimingGraph& graph = circuit.getLiveGraph();
+    GateId gate = graph.findGate(gateName);
+    circuit.removeGate(gateName);
+    if (!hasTiming()) {
+        resetQueries();
+        return;
+    }
+    
+    // The removed gate keeps its fanin and output in the graph, marked removed
+    vector<NodeId> forwardSeeds(1, graph.getOutput(gate));
+    vector<NodeId> backwardSeeds(graph.faninBegin(gate), graph.faninEnd(gate));
+    recalculateDelays(graph, backwardSeeds, forwardSeeds, backwardSeeds);
+    retime(graph, forwardSeeds, backwardSeeds);
+}
+
+void TimingAnalyzer::reconnectGateInput(const string& gateName, int pin, const string& nodeName) {
+    const TimingGraph& graph = circuit.getLiveGraph();
+    GateId gate = graph.findGate(gateName);
+    NodeId previous = (gate != INVALID_ID && pin >= 0 && pin < graph.getFaninCount(gate))
+                          ? graph.getInput(gate, pin) : INVALID_ID;
+    
+    circuit.reconnectGateInput(gateName, pin, nodeName);
+    if (!hasTiming()) {
+        resetQueries();
+        return;
+    }
+    
+    resizeTiming(graph);
+    vector<NodeId> backwardSeeds(1, previous);
+    backwardSeeds.push_back(graph.getInput(gate, pin));
+    vector<NodeId> forwardSeeds(1, graph.getOutput(gate));
+    recalculateDelays(graph, backwardSeeds, forwardSeeds, backwardSeeds);
+    retime(graph, forwardSeeds, backwardSeeds);
+}
+
+void TimingAnalyzer::updatePaths() {
+    findWorstPaths();
+    findCriticalPaths();
+    calculateTotalDelay();
+    calculateStageResults();
+}
+
+void TimingAnalyzer::resizeTiming(const TimingGraph& graph) {
+    // Nodes created by an edit start out undriven and unconstrained
+    NodeId first = static_cast<NodeId>(timing.arrival.size());
+    size_t nodeCount = graph.getNodeCount();
+    timing.arrival.resize(nodeCount, 0.0);
+    timing.earlyArrival.resize(nodeCount, 0.0);
+    timing.worstFanin.resize(nodeCount, INVALID_ID);
+    timing.required.resize(nodeCount, numeric_limits<double>::infinity());
+    timing.holdRequired.resize(nodeCount, -numeric_limits<double>::infinity());
+    timing.slack.resize(nodeCount, numeric_limits<double>::infinity());
+    timing.holdSlack.resize(nodeCount, numeric_limits<double>::infinity());
+    timing.slew.resize(nodeCount, 0.0);
+    timing.fanoutCount.resize(nodeCount, 0);
+    timing.capacitance.resize(nodeCount, BASE_CAPACITANCE);
+    
+    for (NodeId id = first; id < graph.getNodeCount(); ++id) {
+        timing.fanoutCount[id] = graph.getFanoutCount(id);
+        timing.capacitance[id] = BASE_CAPACITANCE + timing.fanoutCount[id] * CAPACITANCE_PER_FANOUT;
+    }
+}
+
+void TimingAnalyzer::recalculateDelays(const TimingGraph& graph, const vector<NodeId>& loadChanged,
+                                       vector<NodeId>& forwardSeeds, vector<NodeId>& backwardSeeds) {
+    // A table delay that moved retimes like a setGateDelay on its gate
+    if (!circuit.hasDelayTables()) return;
+    vector<GateId> changedGates;
+    circuit.updateDelays(loadChanged, vector<NodeId>(forwardSeeds), changedGates);
+    for (GateId gate : changedGates) {
+        forwardSeeds.push_back(graph.getOutput(gate));
+        backwardSeeds.insert(backwardSeeds.end(), graph.faninBegin(gate), graph.faninEnd(gate));
+    }
+}
+
+void TimingAnalyzer::retime(const TimingGraph& graph,
+                            const vector<NodeId>& forwardSeeds,
+                            const vector<NodeId>& backwardSeeds) {
+    // Only the primary lane is retimed; the other corners would otherwise
+    // report their pre-edit times next to it
+    cornerTiming.clear();
+    cornerResults.clear();
+    queuedFlags.resize(graph.getNodeCount(), 0);
+    touchedNodes.clear();
+    
+    retimeArrivals(graph, forwardSeeds);
+    retimeRequired(graph, backwardSeeds);
+    refreshTouchedNodes(graph, backwardSeeds);
+}
+
+void TimingAnalyzer::retimeArrivals(const TimingGraph& graph, const vector<NodeId>& seeds) {
+    // Lowest level first, so a node is recomputed once after all its fanins;
+    // propagation stops wherever both arrival times come out unchanged
+    using Entry = pair<int, NodeId>;
+    priority_queue<Entry, vector<Entry>, greater<Entry>> pending;
+    for (NodeId seed : seeds) {
+        if (queuedFlags[seed]) continue;
+        queuedFlags[seed] = 1;
+        pending.push({graph.getLevel(seed), seed});
+    }
+    
+    while (!pending.empty()) {
+        NodeId node = pending.top().second;
+        pending.pop();
+        queuedFlags[node] = 0;
+        
+        double arrival = 0.0;
+        double earlyArrival = 0.0;
+        NodeId worst = INVALID_ID;
+        GateId driver = graph.getDriver(node);
+        if (driver != INVALID_ID && graph.isRegister(driver)) {
+            arrival = graph.getDelay(driver);
+            earlyArrival = arrival;
+        } else if (driver != INVALID_ID && graph.hasArcDelays(driver)) {
+            arrival = latestArcArrival(graph, driver, timing.arrival.data(), worst) + graph.getDelay(driver);
+            earlyArrival = earliestArcArrival(graph, driver, timing.earlyArrival.data()) + graph.getDelay(driver);
+        } else if (driver != INVALID_ID) {
+            const NodeId* in = graph.faninBegin(driver);
+            worst = *in;
+            double earliest = timing.earlyArrival[*in];
+            for (++in; in != graph.faninEnd(driver); ++in) {
+                if (timing.arrival[*in] > timing.arrival[worst]) worst = *in;
+                earliest = min(earliest, timing.earlyArrival[*in]);
+            }
+            arrival = timing.arrival[worst] + graph.getDelay(driver);
+            earlyArrival = earliest + graph.getDelay(driver);
+        }
+        // The dominating input can change even when the arrival time does not
+        timing.worstFanin[node] = worst;
+        if (arrival == timing.arrival[node] && earlyArrival == timing.earlyArrival[node]) continue;
+        
+        timing.arrival[node] = arrival;
+        timing.earlyArrival[node] = earlyArrival;
+        touchedNodes.push_back(node);
+        for (const GateId* g = graph.fanoutBegin(node); g != graph.fanoutEnd(node); ++g) {
+            NodeId output = graph.getOutput(*g);
+            if (graph.getDriver(output) != *g || graph.isRegister(*g) || queuedFlags[output]) continue;
+            queuedFlags[output] = 1;
+            pending.push({graph.getLevel(output), output});
+        }
+    }
+}
+
+void TimingAnalyzer::retimeRequired(const TimingGraph& graph, const vector<NodeId>& seeds) {
+    // Highest level first, mirroring retimeArrivals
+    using Entry = pair<int, NodeId>;
+    priority_queue<Entry> pending;
+    for (NodeId seed : seeds) {
+        if (seed == INVALID_ID || queuedFlags[seed]) continue;
+        queuedFlags[seed] = 1;
+        pending.push({graph.getLevel(seed), seed});
+    }
+    
+    EndpointConstraints constraints = getEndpointConstraints();
+    while (!pending.empty()) {
+        NodeId node = pending.top().second;
+        pending.pop();
+        queuedFlags[node] = 0;
+        
+        bool isOutput = graph.isOutput(node);
+        double required = isOutput ? constraints.clockPeriod : numeric_limits<double>::infinity();
+        double holdRequired = isOutput ? constraints.holdTime : -numeric_limits<double>::infinity();
+        for (const GateId* g = graph.fanoutBegin(node); g != graph.fanoutEnd(node); ++g) {
+            NodeId output = graph.getOutput(*g);
+            if (graph.getDriver(output) != *g) continue;
+            if (graph.isRegister(*g)) {
+                required = min(required, constraints.clockPeriod - constraints.setupTime);
+                holdRequired = max(holdRequired, constraints.registerHoldTime);
+                continue;
+            }
+            double delay = graph.getFanoutDelay(g);
+            required = min(required, timing.required[output] - delay);
+            holdRequired = max(holdRequired, timing.holdRequired[output] - delay);
+        }
+        if (required == timing.required[node] && holdRequired == timing.holdRequired[node]) continue;
+        
+        timing.required[node] = required;
+        timing.holdRequired[node] = holdRequired;
+        touchedNodes.push_back(node);
+        GateId driver = graph.getDriver(node);
+        if (driver == INVALID_ID || graph.isRegister(driver)) continue;
+        for (const NodeId* in = graph.faninBegin(driver); in != graph.faninEnd(driver); ++in) {
+            if (queuedFlags[*in]) continue;
+            queuedFlags[*in] = 1;
+            pending.push({graph.getLevel(*in), *in});
+        }
+    }
+}
+
+void TimingAnalyzer::refreshTouchedNodes(const TimingGraph& graph,
+                                         const vector<NodeId>& loadChanged) {
+    bool tableDelays = circuit.hasDelayTables();
+    bool rescan = false;
+    for (NodeId id : touchedNodes) {
+        double previous = timing.slack[id];
+        double slack = timing.required[id] - timing.arrival[id];
+        timing.slack[id] = slack;
+        double previousHold = timing.holdSlack[id];
+        double holdSlack = timing.earlyArrival[id] - timing.holdRequired[id];
+        timing.holdSlack[id] = holdSlack;
+        
+        // Only a node that held the worst slack and improved forces a rescan
+        if (slack < worstSlack) {
+            worstSlack = slack;
+        } else if (previous <= worstSlack && slack > previous) {
+            rescan = true;
+        }
+        if (holdSlack < worstHoldSlack) {
+            worstHoldSlack = holdSlack;
+        } else if (previousHold <= worstHoldSlack && holdSlack > previousHold) {
+            rescan = true;
+        }
+        if (!tableDelays) timing.slew[id] = timing.arrival[id] * SLEW_ARRIVAL_FRACTION;
+    }
+    if (rescan) {
+        updateWorstSlack();
+    }
+    
+    // Nodes that gained or lost fanout pins; table loads are kept by the
+    // delay calculator
+    for (NodeId id : loadChanged) {
+        if (id == INVALID_ID) continue;
+        timing.fanoutCount[id] = graph.getFanoutCount(id);
+        if (!tableDelays) {
+            timing.capacitance[id] = BASE_CAPACITANCE + timing.fanoutCount[id] * CAPACITANCE_PER_FANOUT;
+        }
     }
 }
 
 void TimingAnalyzer::resetAnalysis() {
+    resetQueries();
     allPaths.clear();
     criticalPaths.clear();
-    arrivalTimes.clear();
-    requiredTimes.clear();
-    slackTimes.clear();
+    timing.clear();
+    cornerTiming.clear();
+    cornerResults.clear();
+    stageResults.clear();
     worstSlack = 0.0;
+    worstHoldSlack = 0.0;
     totalDelay = 0.0;
-    
-    // Reset node timing
-    for (const auto& nodePair : circuit.getNodes()) {
-        nodePair.second->resetTiming();
-    }
 }
 
 bool TimingAnalyzer::isTimingViolation() const {
-    return worstSlack < 0.0;
+    return getMergedWorstSlack() < 0.0 || getMergedWorstHoldSlack() < 0.0;
 }
 
 void TimingAnalyzer::generateReport(const string& filename) {
-    ofstream file(filename);
-    if (!file.is_open()) {
-        throw runtime_error("Cannot create report file: " + filename);
-    }
-    
-    file << fixed << setprecision(3);
-    file << "===========================================" << endl;
-    file << "        STATIC TIMING ANALYSIS REPORT" << endl;
-    file << "===========================================" << endl;
-    file << endl;
-    
-    // Summary
-    file << "SUMMARY:" << endl;
-    file << "--------" << endl;
-    file << "Clock Period: " << circuit.getClockPeriod() << " ns" << endl;
-    file << "Total Delay: " << totalDelay << " ns" << endl;
-    file << "Worst Slack: " << worstSlack << " ns" << endl;
-    file << "Timing Violation: " << (isTimingViolation() ? "YES" : "NO") << endl;
-    file << "Number of Paths: " << allPaths.size() << endl;
-    file << "Critical Paths: " << criticalPaths.size() << endl;
-    file << endl;
+    {
+        PhaseScope phase(metrics, "report");
+        writeReport(filename);
+    }
+    
+    string base = sidecarBase(filename);
+    if (!metrics.writeJson(base + ".metrics.json") || !metrics.writeCsv(base + ".metrics.csv")) {
+        throw runtime_error("Cannot create metrics files next to: " + filename);
+    }
+}
+
+// Sidecars replace the report's extension: timing_report.metrics.json
+string TimingAnalyzer::sidecarBase(const string& reportFilename) {
+    size_t slash = reportFilename.find_last_of("/\\");
+    size_t dot = reportFilename.find_last_of('.');
+    return (dot != string::npos && (slash == string::npos || dot > slash))
+               ? reportFilename.substr(0, dot) : reportFilename;
+}
+
+void TimingAnalyzer::writeReport(const string& filename) {
+    ReportWriter writer(filename, reportOptions.format);
+    bool filtered = reportOptions.isFiltered();
+    vector<NodeId> selected;
+    if (filtered) {
+        selected = selectReportNodes();
+    }
+    
+    ReportSummary summary;
+    summary.clockPeriod = circuit.getClockPeriod();
+    summary.totalDelay = totalDelay;
+    summary.worstSlack = worstSlack;
+    summary.worstHoldSlack = worstHoldSlack;
+    summary.violation = isTimingViolation();
+    summary.pathCount = allPaths.size();
+    summary.criticalPathCount = criticalPaths.size();
+    summary.nodeCount = circuit.getNodeCount();
+    summary.nodesReported = filtered ? selected.size() : summary.nodeCount;
+    summary.filtered = filtered;
+    summary.corners = cornerResults;
+    summary.mergedWorstSlack = getMergedWorstSlack();
+    summary.mergedWorstHoldSlack = getMergedWorstHoldSlack();
+    summary.stages = stageResults;
+    writer.writeSummary(summary);
     
     // Node timing information
-    file << "NODE TIMING INFORMATION:" << endl;
-    file << "-----------------------" << endl;
-    for (const auto& nodePair : circuit.getNodes()) {
-        const string& name = nodePair.first;
-        auto node = nodePair.second;
-        
-        file << "Node: " << name << endl;
-        file << "  Arrival Time: " << node->getMaxArrivalTime() << " ns" << endl;
-        file << "  Required Time: " << node->getMinRequiredTime() << " ns" << endl;
-        file << "  Slack: " << node->getWorstSlack() << " ns" << endl;
-        file << "  Slew: " << node->getSlewRise() << " ns" << endl;
-        file << "  Capacitance: " << node->getCapacitance() << " fF" << endl;
-        file << "  Fanout: " << node->getFanoutCount() << endl;
-        file << endl;
+    if (filtered) {
+        const TimingGraph& graph = circuit.getGraph();
+        for (NodeId id : selected) {
+            writer.writeNode(graph.getNodeName(id),
+                             {timing.arrival[id], timing.required[id], timing.slack[id],
+                              timing.slew[id], timing.capacitance[id], timing.fanoutCount[id]});
+        }
+    } else {
+        for (const Node* node : circuit.getNodes()) {
+            writer.writeNode(node->getName(),
+                             {node->getMaxArrivalTime(), node->getMinRequiredTime(),
+                              node->getWorstSlack(), node->getSlewRise(),
+                              node->getCapacitance(), node->getFanoutCount()});
+        }
     }
+    metrics.addNodesVisited(static_cast<long long>(summary.nodesReported));
     
     // Critical paths
-    if (!criticalPaths.empty()) {
-        file << "CRITICAL PATHS:" << endl;
-        file << "---------------" << endl;
-        for (size_t i = 0; i < criticalPaths.size(); ++i) {
-            const auto& path = criticalPaths[i];
-            file << "Path " << (i + 1) << " (Slack: " << path.slack << " ns):" << endl;
-            for (size_t j = 0; j < path.nodes.size(); ++j) {
-                file << "  " << path.nodes[j];
-                if (j < path.nodes.size() - 1) file << " -> ";
-            }
-            file << endl;
-            file << "  Total Delay: " << path.totalDelay << " ns" << endl;
-            file << endl;
+    for (const auto& path : criticalPaths) {
+        if (path.slack < reportOptions.slackBelow) {
+            writer.writePath(path.slack, path.totalDelay, path.nodes);
+        }
+    }
+    
+    writer.close();
+}
+
+// Nodes listed by a filtered report: those with slack below the bound in name
+// order, or the worst topEndpoints primary outputs, worst first. A scan of the
+// slack array replaces sorting every node by name.
+vector<NodeId> TimingAnalyzer::selectReportNodes() const {
+    vector<NodeId> selected;
+    if (!hasTiming()) return selected;
+    const TimingGraph& graph = circuit.getGraph();
+    const double bound = reportOptions.slackBelow;
+    
+    if (reportOptions.topEndpoints > 0) {
+        for (NodeId output : graph.getPrimaryOutputs()) {
+            if (timing.slack[output] < bound) selected.push_back(output);
         }
+        size_t keep = min(selected.size(), static_cast<size_t>(reportOptions.topEndpoints));
+        partial_sort(selected.begin(), selected.begin() + keep, selected.end(),
+                     [&](NodeId a, NodeId b) {
+                         if (timing.slack[a] != timing.slack[b]) return timing.slack[a] < timing.slack[b];
+                         return graph.getNodeName(a) < graph.getNodeName(b);
+                     });
+        selected.resize(keep);
+        return selected;
     }
     
-    file.close();
+    vector<pair<const string*, NodeId>> named;
+    NodeId count = static_cast<NodeId>(timing.slack.size());
+    for (NodeId id = 0; id < count; ++id) {
+        if (timing.slack[id] < bound) named.emplace_back(&graph.getNodeName(id), id);
+    }
+    sort(named.begin(), named.end(), [](const pair<const string*, NodeId>& a,
+                                        const pair<const string*, NodeId>& b) {
+        return *a.first < *b.first;
+    });
+    selected.reserve(named.size());
+    for (const auto& entry : named) {
+        selected.push_back(entry.second);
+    }
+    return selected;
+}
+
+MonteCarloResult TimingAnalyzer::runMonteCarlo(int samples, uint64_t seed) {
+    PhaseScope phase(metrics, "monte_carlo");
+    const TimingGraph& graph = circuit.getGraph();
+    MonteCarloAnalyzer sampler(graph, circuit.getTypeSigmas(), circuit.getClockPeriod(),
+                               circuit.getSetupTime());
+    MonteCarloResult result = sampler.run(samples, seed, threadPool.get());
+    metrics.addNodesVisited(static_cast<long long>(graph.getNodeCount()) * samples);
+    metrics.addEdgesVisited(static_cast<long long>(graph.getEdgeCount()) * samples);
+    return result;
+}
+
+void TimingAnalyzer::printMonteCarloSummary(const MonteCarloResult& result) const {
+    const TimingGraph& graph = circuit.getLiveGraph();
+    double meanDelay = 0.0, delaySquares = 0.0;
+    for (double delay : result.totalDelay) {
+        meanDelay += delay;
+        delaySquares += delay * delay;
+    }
+    meanDelay /= result.sampleCount;
+    double sigmaDelay = sqrt(max(0.0, delaySquares / result.sampleCount - meanDelay * meanDelay));
+    
+    cout << fixed << setprecision(3);
+    cout << "\n=== MONTE CARLO (" << result.sampleCount << " samples, seed " << result.seed << ") ===" << endl;
+    cout << "Timing Yield: " << 100.0 * result.yield << "%" << endl;
+    cout << "Total Delay: mean " << meanDelay << " ns, sigma " << sigmaDelay << " ns" << endl;
+    cout << "Worst Slack: p1 " << MonteCarloResult::percentile(result.worstSlack, 0.01)
+         << " ns, p50 " << MonteCarloResult::percentile(result.worstSlack, 0.5)
+         << " ns, p99 " << MonteCarloResult::percentile(result.worstSlack, 0.99) << " ns" << endl;
+    
+    // The endpoints most likely to fail
+    vector<const EndpointStatistics*> ranked;
+    for (const auto& endpoint : result.endpoints) {
+        ranked.push_back(&endpoint);
+    }
+    size_t shown = min<size_t>(10, ranked.size());
+    partial_sort(ranked.begin(), ranked.begin() + shown, ranked.end(),
+                 [](const EndpointStatistics* a, const EndpointStatistics* b) {
+                     if (a->yield != b->yield) return a->yield < b->yield;
+                     return a->meanSlack < b->meanSlack;
+                 });
+    for (size_t i = 0; i < shown; ++i) {
+        const EndpointStatistics& endpoint = *ranked[i];
+        cout << "  " << graph.getNodeName(endpoint.node) << ": yield " << 100.0 * endpoint.yield
+             << "%, slack " << endpoint.meanSlack << " +/- " << endpoint.sigmaSlack << " ns" << endl;
+    }
+}
+
+PeriodSweep TimingAnalyzer::makePeriodSweep() const {
+    const TimingGraph& graph = circuit.getLiveGraph();
+    vector<NodeId> endpoints;
+    vector<double> arrivals;
+    // Corner arrivals only count while they describe this graph; edits drop
+    // them, and nodes added since the analysis have none
+    size_t cornerNodes = cornerTiming.stride > 0 ? cornerTiming.arrival.size() / cornerTiming.stride : 0;
+    int cornerCount = cornerNodes == static_cast<size_t>(graph.getNodeCount()) ? cornerTiming.cornerCount : 0;
+    // A corner with another setup time shifts its register-input arrivals by
+    // the difference, so the sweep's one requirement per group still gives
+    // every corner its own slack (up to rounding)
+    for (NodeId endpoint : graph.getEndpoints()) {
+        if (graph.getLevel(endpoint) < 0) continue;
+        double arrival = timing.arrival[endpoint];
+        bool registerInput = graph.isRegisterInput(endpoint);
+        bool output = graph.isOutput(endpoint);
+        auto margin = [&](int corner) {
+            double setup = cornerTiming.setupTime[corner];
+            return !registerInput ? 0.0 : (output ? max(0.0, setup) : setup);
+        };
+        for (int corner = 1; corner < cornerCount; ++corner) {
+            double shift = margin(corner) - margin(0);
+            arrival = max(arrival, cornerTiming.arrivalOf(endpoint)[corner] + shift);
+        }
+        endpoints.push_back(endpoint);
+        arrivals.push_back(arrival);
+    }
+    return PeriodSweep(graph, endpoints, arrivals, circuit.getSetupTime());
+}
+
+vector<PeriodResult> TimingAnalyzer::sweepClockPeriods(const vector<double>& periods) const {
+    return makePeriodSweep().sweep(periods);
+}
+
+PeriodResult TimingAnalyzer::findMinimumPeriod() const {
+    return makePeriodSweep().minimumPeriod();
+}
+
+void TimingAnalyzer::printPeriodSweep(const vector<PeriodResult>& results) const {
+    const TimingGraph& graph = circuit.getLiveGraph();
+    cout << fixed << setprecision(3);
+    cout << "\n=== CLOCK PERIOD SWEEP ===" << endl;
+    for (const PeriodResult& result : results) {
+        cout << "Period " << result.period << " ns: ";
+        if (result.worstEndpoint == INVALID_ID) {
+            cout << "no endpoints" << endl;
+            continue;
+        }
+        cout << (result.passes() ? "PASS" : "FAIL") << ", worst slack " << result.worstSlack
+             << " ns at " << graph.getNodeName(result.worstEndpoint) << ", "
+             << result.failingEndpoints << " failing endpoint(s)" << endl;
+    }
+}
+
+void TimingAnalyzer::writeMonteCarloReport(const MonteCarloResult& result,
+                                           const string& reportFilename) const {
+    string filename = sidecarBase(reportFilename) + ".montecarlo.csv";
+    ofstream file(filename);
+    if (!file.is_open()) {
+        throw runtime_error("Cannot create Monte Carlo report: " + filename);
+    }
+    
+    const TimingGraph& graph = circuit.getLiveGraph();
+    file << setprecision(6);
+    file << "endpoint,mean_slack_ns,sigma_slack_ns,min_slack_ns,max_slack_ns,yield\n";
+    for (const auto& endpoint : result.endpoints) {
+        file << graph.getNodeName(endpoint.node) << ',' << endpoint.meanSlack << ','
+             << endpoint.sigmaSlack << ',' << endpoint.minSlack << ',' << endpoint.maxSlack << ','
+             << endpoint.yield << '\n';
+    }
+    if (!file) {
+        throw runtime_error("Error writing Monte Carlo report: " + filename);
+    }
 }
 
 void TimingAnalyzer::printSummary() {
@@ -629,9 +2235,35 @@ void TimingAnalyzer::printSummary() {
     cout << "Clock Period: " << circuit.getClockPeriod() << " ns" << endl;
     cout << "Total Delay: " << totalDelay << " ns" << endl;
     cout << "Worst Slack: " << worstSlack << " ns" << endl;
+    cout << "Worst Hold Slack: " << worstHoldSlack << " ns" << endl;
     cout << "Timing Violation: " << (isTimingViolation() ? "YES" : "NO") << endl;
     cout << "Number of Paths: " << allPaths.size() << endl;
     cout << "Critical Paths: " << criticalPaths.size() << endl;
+    for (const auto& corner : cornerResults) {
+        cout << "Corner " << corner.name << ": Worst Slack " << corner.worstSlack
+             << " ns, Worst Hold Slack " << corner.worstHoldSlack
+             << " ns, Total Delay " << corner.totalDelay << " ns" << endl;
+    }
+    if (!cornerResults.empty()) {
+        cout << "Merged Worst Slack: " << getMergedWorstSlack() << " ns" << endl;
+        cout << "Merged Worst Hold Slack: " << getMergedWorstHoldSlack() << " ns" << endl;
+    }
+    if (!stageResults.empty()) {
+        // The report lists every stage; the console only the worst few
+        vector<int> order(stageResults.size());
+        for (size_t stage = 0; stage < order.size(); ++stage) order[stage] = static_cast<int>(stage);
+        int shown = min<int>(5, static_cast<int>(order.size()));
+        partial_sort(order.begin(), order.begin() + shown, order.end(), [&](int a, int b) {
+            return stageResults[a].worstSlack < stageResults[b].worstSlack;
+        });
+        cout << "Stages: " << stageResults.size() << endl;
+        for (int i = 0; i < shown; ++i) {
+            const StageResult& stage = stageResults[order[i]];
+            cout << "Stage " << order[i] << ": Worst Slack " << stage.worstSlack << " ns at "
+                 << (stage.worstEndpoint.empty() ? "-" : stage.worstEndpoint) << ", "
+                 << stage.nodeCount << " nodes" << endl;
+        }
+    }
     
     if (!criticalPaths.empty()) {
         cout << "\nMost Critical Path:" << endl;
@@ -643,8 +2275,8 @@ void TimingAnalyzer::printDetailedReport() {
     printSummary();
     
     cout << "\n=== DETAILED NODE TIMING ===" << endl;
-    for (const auto& nodePair : circuit.getNodes()) {
-        nodePair.second->printTiming();
+    for (const Node* node : circuit.getNodes()) {
+        node->printTiming();
         cout << endl;
     }
 }
@@ -658,29 +2290,359 @@ void TimingAnalyzer::printTimingPath(const TimingPath& path) const {
     cout << " (Delay: " << path.totalDelay << " ns)" << endl;
 }
 
+// ============================================================================
+// LOGIC SIMULATION
+// ============================================================================
+
+// Reports how often each primary output is 1 over random patterns, or over
+// every input combination when patternCount is 0
+void printSimulationSummary(const TimingGraph& graph, long long patternCount) {
+    LogicSimulator simulator(graph);
+    const vector<NodeId>& outputs = graph.getPrimaryOutputs();
+    vector<long long> onesCount(outputs.size(), 0);
+    long long simulated = 0;
+
+    auto countOnes = [&](const LogicSimulator& sim, long long, int count) {
+        for (size_t i = 0; i < outputs.size(); ++i) {
+            const PatternWord* words = sim.nodeWords(outputs[i]);
+            for (int w = 0; w * 64 < count; ++w) {
+                int valid = min(64, count - w * 64);
+                PatternWord mask = valid == 64 ? ~0ULL : ((1ULL << valid) - 1);
+                onesCount[i] += bitset<64>(words[w] & mask).count();
+            }
+        }
+        simulated += count;
+    };
+
+    if (patternCount == 0) {
+        simulator.runExhaustive(countOnes);
+    } else {
+        simulator.runRandom(patternCount, 1, countOnes);
+    }
+
+    cout << "\n=== Logic Simulation (" << simulated << " patterns) ===" << endl;
+    cout << fixed << setprecision(3);
+    for (size_t i = 0; i < outputs.size(); ++i) {
+        cout << "  " << graph.getNodeName(outputs[i]) << ": 1 in "
+             << 100.0 * onesCount[i] / max(1LL, simulated) << "% of patterns" << endl;
+    }
+}
+
+// ============================================================================
+// BENCHMARK
+// ============================================================================
+
+string jsonEscape(const string& text) {
+    string escaped;
+    for (char c : text) {
+        if (c == '"' || c == '\\') escaped += '\\';
+        escaped += c;
+    }
+    return escaped;
+}
+
+// Runs the analysis and appends its per-phase metrics as a single JSON object
+// per line, so runs over many netlist sizes and thread counts collect into one
+// machine-readable file
+void runBenchmark(const string& circuitFile, const string& delayFile,
+                  const vector<string>& cornerFiles, const string& reportFile,
+                  int threads, int maxPaths, const ReportOptions& reportOptions,
+                  const string& resultsFile) {
+    Circuit circuit;
+    TimingAnalyzer analyzer(circuit);
+    AnalysisMetrics& metrics = analyzer.getMetrics();
+    {
+        PhaseScope phase(metrics, "parse");
+        circuit.loadCircuit(circuitFile);
+    }
+    {
+        PhaseScope phase(metrics, "delays");
+        if (cornerFiles.empty()) {
+            circuit.loadDelays(delayFile);
+        } else {
+            circuit.loadCorners(cornerFiles);
+        }
+    }
+
+    analyzer.setThreadCount(threads);
+    analyzer.setPathLimits(maxPaths);
+    analyzer.setReportOptions(reportOptions);
+    analyzer.analyze();
+    analyzer.generateReport(reportFile);
+    double total = metrics.getTotalWallSeconds();
+
+    const TimingGraph& graph = circuit.getGraph();
+    ostringstream json;
+    json << fixed << setprecision(6);
+    json << "{\"netlist\":\"" << jsonEscape(circuitFile) << "\""
+         << ",\"nodes\":" << graph.getNodeCount()
+         << ",\"gates\":" << graph.getGateCount()
+         << ",\"edges\":" << graph.getEdgeCount()
+         << ",\"levels\":" << graph.getLevelCount()
+         << ",\"threads\":" << analyzer.getThreadCount()
+         << ",\"corners\":" << max<size_t>(1, circuit.getCorners().size())
+         << ",\"paths\":" << analyzer.getAllPaths().size()
+         << ",\"worst_slack\":" << analyzer.getWorstSlack();
+    long long expansions = 0;
+    for (const auto& phase : metrics.getPhases()) {
+        json << ",\"" << phase.name << "_s\":" << phase.wallSeconds;
+        expansions += phase.pathExpansions;
+    }
+    json << ",\"total_s\":" << total
+         << ",\"cpu_s\":" << metrics.getTotalCpuSeconds()
+         << ",\"path_expansions\":" << expansions
+         << ",\"peak_rss_bytes\":" << AnalysisMetrics::peakResidentBytes()
+         << ",\"gates_per_s\":" << setprecision(0) << graph.getGateCount() / max(total, 1e-9)
+         << "}";
+
+    cout << json.str() << endl;
+    ofstream results(resultsFile, ios::app);
+    if (!results.is_open()) {
+        throw runtime_error("Cannot open benchmark results file: " + resultsFile);
+    }
+    results << json.str() << endl;
+}
+
 // ============================================================================
 // MAIN FUNCTION
 // ============================================================================
 
-int main() {
+int main(int argc, char* argv[]) {
     // Hardcoded file paths - we can change these to use different input files
     string circuitFile = "../examples/complex_circuit.txt";
     string delayFile = "../delays/gate_delays.txt";
     string outputFile = "../reports/timing_report.txt";
+    int threads = 1;
+    int partitions = 1;
+    int maxPaths = 100;
+    int pathsPerEndpoint = 0;
+    string snapshotFile;
+    long long simulatePatterns = -1;
+    string benchmarkFile;
+    string generateKind, generateFile;
+    long long generateGates = 0;
+    uint64_t seed = 1;
+    ReportOptions reportOptions;
+    string reportFormat;
+    vector<string> cornerFiles;
+    int monteCarloSamples = 0;
+    string servePath;
+    string modelFile;
+    vector<double> sweepPeriods;
+    bool findFmax = false;
+    vector<string> queryNodes;
+    
+    for (int i = 1; i < argc; ++i) {
+        string arg = argv[i];
+        if (arg == "--circuit" && i + 1 < argc) {
+            circuitFile = argv[++i];
+        } else if (arg == "--delays" && i + 1 < argc) {
+            delayFile = argv[++i];
+        } else if (arg == "--report" && i + 1 < argc) {
+            outputFile = argv[++i];
+        } else if (arg == "--threads" && i + 1 < argc) {
+            threads = atoi(argv[++i]);
+        } else if (arg == "--partitions" && i + 1 < argc) {
+            partitions = atoi(argv[++i]);
+        } else if (arg == "--paths" && i + 1 < argc) {
+            maxPaths = atoi(argv[++i]);
+        } else if (arg == "--paths-per-endpoint" && i + 1 < argc) {
+            pathsPerEndpoint = atoi(argv[++i]);
+        } else if (arg == "--snapshot" && i + 1 < argc) {
+            snapshotFile = argv[++i];
+        } else if (arg == "--simulate" && i + 1 < argc) {
+            simulatePatterns = atoll(argv[++i]);
+        } else if (arg == "--benchmark" && i + 1 < argc) {
+            benchmarkFile = argv[++i];
+        } else if (arg == "--generate" && i + 3 < argc) {
+            generateKind = argv[++i];
+            generateGates = atoll(argv[++i]);
+            generateFile = argv[++i];
+        } else if (arg == "--seed" && i + 1 < argc) {
+            seed = strtoull(argv[++i], nullptr, 10);
+        } else if (arg == "--corners" && i + 1 < argc) {
+            // Comma-separated libraries; the first one is the primary library
+            stringstream list(argv[++i]);
+            string file;
+            while (getline(list, file, ',')) {
+                if (!file.empty()) cornerFiles.push_back(file);
+            }
+            if (!cornerFiles.empty()) delayFile = cornerFiles[0];
+        } else if (arg == "--sweep-periods" && i + 1 < argc) {
+            stringstream list(argv[++i]);
+            string period;
+            while (getline(list, period, ',')) {
+                if (!period.empty()) sweepPeriods.push_back(atof(period.c_str()));
+            }
+        } else if (arg == "--fmax") {
+            findFmax = true;
+        } else if (arg == "--query" && i + 1 < argc) {
+            stringstream list(argv[++i]);
+            string node;
+            while (getline(list, node, ',')) {
+                if (!node.empty()) queryNodes.push_back(node);
+            }
+        } else if (arg == "--monte-carlo" && i + 1 < argc) {
+            monteCarloSamples = atoi(argv[++i]);
+        } else if (arg == "--extract-model" && i + 1 < argc) {
+            modelFile = argv[++i];
+        } else if (arg == "--serve" && i + 1 < argc) {
+            servePath = argv[++i];
+        } else if (arg == "--report-format" && i + 1 < argc) {
+            reportFormat = argv[++i];
+        } else if (arg == "--report-slack" && i + 1 < argc) {
+            reportOptions.slackBelow = atof(argv[++i]);
+        } else if (arg == "--report-top" && i + 1 < argc) {
+            reportOptions.topEndpoints = atoi(argv[++i]);
+        } else {
+            cerr << "Usage: " << argv[0] << " [options]" << endl;
+            cerr << "  --circuit FILE          circuit netlist (default " << circuitFile << ")" << endl;
+            cerr << "  --delays FILE           gate delay library (default " << delayFile << ")" << endl;
+            cerr << "  --corners A,B,...       time several delay libraries in one pass (A is the primary)" << endl;
+            cerr << "  --report FILE           timing report output (default " << outputFile << ")" << endl;
+            cerr << "  --report-format F       text, csv, jsonl or binary (default: from the report extension)" << endl;
+            cerr << "  --report-slack X        only report nodes and paths with slack below X" << endl;
+            cerr << "  --report-top N          only report the N worst endpoints" << endl;
+            cerr << "  --threads N             propagation threads (0 = all cores, default 1)" << endl;
+            cerr << "  --partitions N          time N graph partitions in worker processes (default 1);" << endl;
+            cerr << "                          each worker shares the whole loaded circuit, and delay" << endl;
+            cerr << "                          corners are timed in one process" << endl;
+            cerr << "  --paths K               worst paths to report (default 100)" << endl;
+            cerr << "  --paths-per-endpoint N  worst paths kept per endpoint (default: global K only)" << endl;
+            cerr << "  --snapshot FILE         load from / refresh a binary snapshot of the inputs" << endl;
+            cerr << "  --simulate N            simulate N random patterns (0 = all input combinations)" << endl;
+            cerr << "  --benchmark FILE        time each phase and append the results to FILE as JSON lines" << endl;
+            cerr << "  --generate KIND N FILE  write a synthetic netlist of about N gates and exit;" << endl;
+            cerr << "                          KIND is random, adder, multiplier, mux, mesh or pipeline" << endl;
+            cerr << "  --monte-carlo N         also run N samples of statistical timing (delay sigmas" << endl;
+            cerr << "                          from the library's third column)" << endl;
+            cerr << "  --sweep-periods A,B,... also report setup slack at these clock periods (ns)" << endl;
+            cerr << "  --fmax                  also report the minimum passing clock period" << endl;
+            cerr << "  --query A,B,...         print the timing of these nodes only, timing just their" << endl;
+            cerr << "                          fanin and fanout cones instead of the whole netlist" << endl;
+            cerr << "  --seed S                random seed for --generate and --monte-carlo (default 1)" << endl;
+            cerr << "  --extract-model FILE    write the circuit's input->output timing model to FILE" << endl;
+            cerr << "                          and exit; netlists use it with MODEL/INSTANCE lines" << endl;
+            cerr << "  --serve PATH            answer JSON-lines requests on a Unix socket, or on" << endl;
+            cerr << "                          stdin/stdout when PATH is -" << endl;
+            return 1;
+        }
+    }
     // Create circuit and load configuration
    
     try {
-        // Creating circuit and load configuration
+        if (reportFormat.empty()) {
+            reportOptions.format = ReportOptions::formatForFile(outputFile);
+        } else if (!ReportOptions::parseFormat(reportFormat, reportOptions.format)) {
+            throw runtime_error("Unknown report format: " + reportFormat);
+        }
+        
+        if (!generateKind.empty()) {
+            NetlistGenerator::Kind kind;
+            if (!NetlistGenerator::parseKind(generateKind, kind)) {
+                throw runtime_error("Unknown netlist kind: " + generateKind);
+            }
+            NetlistGenerator generator(kind, generateGates, seed);
+            long long written = generator.writeFile(generateFile);
+            cout << "Wrote " << written << " gates to " << generateFile << endl;
+            return 0;
+        }
+        
+        if (!modelFile.empty()) {
+            // The model is named after the block's netlist
+            size_t slash = circuitFile.find_last_of("/\\");
+            string name = slash == string::npos ? circuitFile : circuitFile.substr(slash + 1);
+            size_t dot = name.find_last_of('.');
+            if (dot != string::npos && dot > 0) name = name.substr(0, dot);
+            
+            Circuit block;
+            block.loadCircuit(circuitFile);
+            block.loadDelays(delayFile);
+            // Table delays are bound at the block's own loads and slews
+            if (block.hasDelayTables()) block.calculateDelays();
+            TimingModel model = TimingModel::extract(block.getGraph(), name);
+            model.save(modelFile, "Timing model of " + circuitFile + " with " + delayFile);
+            cout << "Wrote timing model " << name << " (" << model.getInputs().size() << " inputs, "
+                 << model.getOutputs().size() << " outputs, " << model.getArcs().size()
+                 << " arcs) to " << modelFile << endl;
+            return 0;
+        }
+        
+        if (!servePath.empty()) {
+            AnalysisServer server(threads);
+            if (servePath == "-") {
+                // Replies own stdout; progress messages from loads go to stderr
+                ostream protocol(cout.rdbuf());
+                streambuf* console = cout.rdbuf(cerr.rdbuf());
+                server.serveStream(cin, protocol);
+                cout.rdbuf(console);
+            } else {
+                cout << "Serving timing requests on " << servePath << endl;
+                server.serveSocket(servePath);
+            }
+            return 0;
+        }
+        
+        if (!benchmarkFile.empty()) {
+            runBenchmark(circuitFile, delayFile, cornerFiles, outputFile, threads, maxPaths,
+                         reportOptions, benchmarkFile);
+            return 0;
+        }
+        
+        // Creating circuit and timing analyzer; loading is timed as its own
+        // phases of the analyzer's metrics
         Circuit circuit;
-        circuit.loadCircuit(circuitFile);
-        circuit.loadDelays(delayFile);
-
-        // Creating timing analyzer
         TimingAnalyzer analyzer(circuit);
+        AnalysisMetrics& metrics = analyzer.getMetrics();
+        if (snapshotFile.empty()) {
+            {
+                PhaseScope phase(metrics, "parse");
+                circuit.loadCircuit(circuitFile);
+            }
+            PhaseScope phase(metrics, "delays");
+            circuit.loadDelays(delayFile);
+        } else {
+            PhaseScope phase(metrics, "load");
+            circuit.loadCached(circuitFile, delayFile, snapshotFile);
+        }
+        if (!cornerFiles.empty()) {
+            PhaseScope phase(metrics, "corners");
+            circuit.loadCorners(cornerFiles);
+        }
+
+        // Configuring timing analyzer
+        analyzer.setThreadCount(threads);
+        analyzer.setPartitionCount(partitions);
+        analyzer.setPathLimits(maxPaths, pathsPerEndpoint);
+        analyzer.setReportOptions(reportOptions);
+        
+        // Queries time their own cones and skip the analysis and the report
+        if (!queryNodes.empty()) {
+            cout << fixed << setprecision(3);
+            for (const string& node : queryNodes) {
+                auto start = chrono::steady_clock::now();
+                NodeTiming result = analyzer.queryTiming(node);
+                double elapsed = chrono::duration<double, milli>(chrono::steady_clock::now() - start).count();
+                cout << node << ": arrival " << result.arrival << " ns, required " << result.required
+                     << " ns, slack " << result.slack << " ns, hold slack " << result.holdSlack
+                     << " ns (" << elapsed << " ms)" << endl;
+            }
+            const TimingQuery& query = analyzer.getTimingQuery();
+            cout << "Timed " << query.getArrivalCount() << " arrival and " << query.getRequiredCount()
+                 << " required times of " << circuit.getGraph().getNodeCount() << " nodes" << endl;
+            return 0;
+        }
 
         // Performing timing analysis
         cout << "Performing Static Timing Analysis..." << endl;
         analyzer.analyze();
+        
+        // Statistical timing runs before the report so its phase is in the metrics
+        MonteCarloResult monteCarlo;
+        if (monteCarloSamples > 0) {
+            monteCarlo = analyzer.runMonteCarlo(monteCarloSamples, seed);
+            analyzer.writeMonteCarloReport(monteCarlo, outputFile);
+        }
 
         // Generating timing report
         analyzer.generateReport(outputFile);
@@ -688,6 +2650,29 @@ int main() {
 
         // Printing summary to console
         analyzer.printSummary();
+        
+        if (monteCarloSamples > 0) {
+            analyzer.printMonteCarloSummary(monteCarlo);
+        }
+        
+        // Other clock periods reuse the arrival times of this analysis
+        if (!sweepPeriods.empty() || findFmax) {
+            PeriodSweep sweep = analyzer.makePeriodSweep();
+            if (!sweepPeriods.empty()) {
+                analyzer.printPeriodSweep(sweep.sweep(sweepPeriods));
+            }
+            if (findFmax) {
+                PeriodResult minimum = sweep.minimumPeriod();
+                cout << fixed << setprecision(3);
+                cout << "Minimum Clock Period: " << minimum.period << " ns";
+                if (minimum.period > 0.0) cout << " (Fmax " << 1000.0 / minimum.period << " MHz)";
+                cout << endl;
+            }
+        }
+        
+        if (simulatePatterns >= 0) {
+            printSimulationSummary(circuit.getGraph(), simulatePatterns);
+        }
 
     } catch (const exception& e) {
         cerr << "Error: " << e.what() << endl;